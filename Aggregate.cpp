@@ -0,0 +1,310 @@
+#include "Aggregate.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+static size_t charLength(const char* p, uint32_t width) {
+    size_t len = 0;
+    while (len < width && p[len] != '\0') ++len;
+    return len;
+}
+
+bool parseAggregate(const std::string& text, AggregateFunc& func, std::string& argument) {
+    size_t open = text.find('(');
+    if (open == std::string::npos || text.size() < open + 2 || text.back() != ')') return false;
+    std::string name = text.substr(0, open);
+    std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+    if (name == "COUNT") func = AggregateFunc::COUNT;
+    else if (name == "SUM") func = AggregateFunc::SUM;
+    else if (name == "MIN") func = AggregateFunc::MIN;
+    else if (name == "MAX") func = AggregateFunc::MAX;
+    else if (name == "AVG") func = AggregateFunc::AVG;
+    else return false;
+    argument = text.substr(open + 1, text.size() - open - 2);
+    return true;
+}
+
+// ϣۺ
+HashAggregate::HashAggregate(std::unique_ptr<Operator> input, const std::vector<size_t>& groupColumns,
+                             const std::vector<AggregateSpec>& aggregates,
+                             const std::string& spillDir, size_t memoryLimit)
+    : input(std::move(input)), groupColumns(groupColumns), aggregates(aggregates),
+      spillDir(spillDir), memoryLimit(memoryLimit), inputLayout(this->input->layout()) {
+    const Table& in = this->input->schema();
+    Table schema;
+    for (size_t col : groupColumns) schema.columns.push_back(in.columns[col]);
+    for (const auto& aggregate : aggregates) {
+        Column column;
+        column.name = aggregate.name;
+        column.size = 8;
+        if (aggregate.func == AggregateFunc::MIN || aggregate.func == AggregateFunc::MAX) {
+            column.type = in.columns[aggregate.column].type;
+            column.size = in.columns[aggregate.column].size;
+        } else {
+            column.type = (aggregate.func == AggregateFunc::AVG) ? ColumnType::DOUBLE : ColumnType::BIGINT;
+        }
+        schema.columns.push_back(column);
+    }
+    setSchema(schema);
+
+    // ĸʽ(еǰ׺ͬ) + ۺϺ״̬
+    for (size_t i = 0; i < groupColumns.size(); ++i) keySize += outLayout.widths[i];
+    entrySize = keySize;
+    for (const auto& aggregate : aggregates) {
+        stateOffsets.push_back(entrySize);
+        switch (aggregate.func) {
+        case AggregateFunc::COUNT:
+        case AggregateFunc::SUM: entrySize += sizeof(int64_t); break;
+        case AggregateFunc::AVG: entrySize += 2 * sizeof(int64_t); break;
+        default: entrySize += inputLayout.widths[aggregate.column]; break;
+        }
+    }
+    key.resize(keySize);
+    out.resize(outLayout.rowSize);
+}
+
+uint64_t HashAggregate::estimatedRows() const {
+    return groupColumns.empty() ? 1 : input->estimatedRows();
+}
+
+std::string HashAggregate::describe() const {
+    std::string text = groupColumns.empty() ? "Aggregate (" : "Hash Aggregate (";
+    for (size_t i = 0; i < aggregates.size(); ++i) {
+        if (i > 0) text += ", ";
+        text += aggregates[i].name;
+    }
+    text += ")";
+    for (size_t i = 0; i < groupColumns.size(); ++i) {
+        text += (i == 0 ? " group by: " : ", ") + input->schema().columns[groupColumns[i]].name;
+    }
+    return text;
+}
+
+// CHAR иƵβ 0 Ϊֹֽڣʹֵͬͬļ
+void HashAggregate::buildKey(const char* row) {
+    for (size_t i = 0; i < groupColumns.size(); ++i) {
+        const char* src = row + inputLayout.offsets[groupColumns[i]];
+        char* dst = key.data() + outLayout.offsets[i];
+        uint32_t width = outLayout.widths[i];
+        if (outLayout.types[i] == ColumnType::CHAR) {
+            uint32_t len = static_cast<uint32_t>(charLength(src, width));
+            std::memcpy(dst, src, len);
+            std::memset(dst + len, 0, width - len);
+        } else {
+            std::memcpy(dst, src, width);
+        }
+    }
+}
+
+void HashAggregate::clearTable() {
+    entries.clear();
+    hashes.clear();
+    slots.clear();
+    groupCount = 0;
+    emitPos = 0;
+}
+
+// װӳһʱ
+void HashAggregate::grow() {
+    size_t size = std::max<size_t>(slots.size() * 2, 1024);
+    slots.assign(size, 0);
+    for (uint32_t i = 0; i < groupCount; ++i) {
+        size_t pos = hashes[i] & (size - 1);
+        while (slots[pos] != 0) pos = (pos + 1) & (size - 1);
+        slots[pos] = i + 1;
+    }
+}
+
+uint32_t HashAggregate::find(uint64_t hash, size_t& slot) const {
+    size_t mask = slots.size() - 1;
+    for (slot = hash & mask; slots[slot] != 0; slot = (slot + 1) & mask) {
+        uint32_t index = slots[slot] - 1;
+        if (hashes[index] == hash &&
+            std::memcmp(entries.data() + static_cast<size_t>(index) * entrySize, key.data(), keySize) == 0) {
+            return index;
+        }
+    }
+    return NO_GROUP;
+}
+
+uint32_t HashAggregate::insert(uint64_t hash, size_t slot, const char* row) {
+    if (static_cast<size_t>(groupCount + 1) * 2 > slots.size()) {
+        grow();
+        find(hash, slot);
+    }
+    slots[slot] = groupCount + 1;
+    hashes.push_back(hash);
+    entries.resize(entries.size() + entrySize);
+    char* entry = entries.data() + static_cast<size_t>(groupCount) * entrySize;
+    std::memcpy(entry, key.data(), keySize);
+
+    // MIN/MAX ԵһеֵΪֵ״̬㿪ʼ
+    for (size_t i = 0; i < aggregates.size(); ++i) {
+        char* state = entry + stateOffsets[i];
+        const AggregateSpec& aggregate = aggregates[i];
+        if (aggregate.func == AggregateFunc::MIN || aggregate.func == AggregateFunc::MAX) {
+            uint32_t width = inputLayout.widths[aggregate.column];
+            if (row) {
+                std::memcpy(state, row + inputLayout.offsets[aggregate.column], width);
+            } else {
+                std::memset(state, 0, width);
+            }
+        } else {
+            std::memset(state, 0, aggregate.func == AggregateFunc::AVG ? 2 * sizeof(int64_t) : sizeof(int64_t));
+        }
+    }
+    return groupCount++;
+}
+
+size_t HashAggregate::memoryUsed() const {
+    return entries.size() + hashes.size() * sizeof(uint64_t) + slots.size() * sizeof(uint32_t);
+}
+
+static void addTo(char* p, int64_t delta) {
+    int64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    value += delta;
+    std::memcpy(p, &value, sizeof(value));
+}
+
+void HashAggregate::updateState(char* state, const char* row) {
+    for (size_t i = 0; i < aggregates.size(); ++i) {
+        char* p = state + stateOffsets[i];
+        const AggregateSpec& aggregate = aggregates[i];
+        if (aggregate.func == AggregateFunc::COUNT) {
+            addTo(p, 1);
+            continue;
+        }
+        const char* field = row + inputLayout.offsets[aggregate.column];
+        if (aggregate.func == AggregateFunc::SUM || aggregate.func == AggregateFunc::AVG) {
+            int32_t value;
+            std::memcpy(&value, field, sizeof(value));
+            addTo(p, value);
+            if (aggregate.func == AggregateFunc::AVG) addTo(p + sizeof(int64_t), 1);
+            continue;
+        }
+
+        uint32_t width = inputLayout.widths[aggregate.column];
+        int cmp;
+        if (inputLayout.types[aggregate.column] == ColumnType::INT) {
+            int32_t value, current;
+            std::memcpy(&value, field, sizeof(value));
+            std::memcpy(&current, p, sizeof(current));
+            cmp = (value < current) ? -1 : (value > current ? 1 : 0);
+        } else {
+            cmp = std::string_view(field, charLength(field, width)).compare(std::string_view(p, charLength(p, width)));
+        }
+        if (aggregate.func == AggregateFunc::MIN ? cmp < 0 : cmp > 0) std::memcpy(p, field, width);
+    }
+}
+
+const char* HashAggregate::finish(const char* entry) {
+    std::memcpy(out.data(), entry, keySize);
+    for (size_t i = 0; i < aggregates.size(); ++i) {
+        const char* state = entry + stateOffsets[i];
+        char* dst = out.data() + outLayout.offsets[groupColumns.size() + i];
+        if (aggregates[i].func == AggregateFunc::AVG) {
+            int64_t sum, count;
+            std::memcpy(&sum, state, sizeof(sum));
+            std::memcpy(&count, state + sizeof(sum), sizeof(count));
+            double average = count > 0 ? static_cast<double>(sum) / count : 0.0;
+            std::memcpy(dst, &average, sizeof(average));
+        } else {
+            std::memcpy(dst, state, outLayout.widths[groupColumns.size() + i]);
+        }
+    }
+    return out.data();
+}
+
+template <typename Source>
+bool HashAggregate::aggregate(Source source, int level) {
+    clearTable();
+    grow();
+    std::vector<std::unique_ptr<SpillFile>> parts(PARTITIONS);
+    uint32_t shift = 32 + PARTITION_BITS * level;
+    bool limited = level < MAX_LEVEL;
+    bool ok = true;
+    while (const char* row = source()) {
+        buildKey(row);
+        uint64_t hash = mixHash(hashBytes(key.data(), keySize));
+        size_t slot;
+        uint32_t index = find(hash, slot);
+        if (index == NO_GROUP) {
+            if (limited && groupCount > 0 && memoryUsed() > memoryLimit) {
+                // ڴپۺ
+                std::unique_ptr<SpillFile>& part = parts[(hash >> shift) & (PARTITIONS - 1)];
+                if (!part) {
+                    part.reset(new SpillFile(spillDir, inputLayout.rowSize));
+                    stats.spillFiles++;
+                }
+                ok = part->write(row) && ok;
+                continue;
+            }
+            index = insert(hash, slot, row);
+        }
+        updateState(entries.data() + static_cast<size_t>(index) * entrySize, row);
+    }
+
+    for (auto& part : parts) {
+        if (!part) continue;
+        ok = part->rewind() && ok;
+        pending.push_back({std::move(part), level + 1});
+    }
+    if (!ok) errorMessage = "Failed to write temporary file in '" + spillDir + "'";
+    return ok;
+}
+
+const char* HashAggregate::produce() {
+    if (done) return nullptr;
+    if (!started) {
+        started = true;
+        if (!aggregate([this] { return input->next(); }, 0)) done = true;
+        // ûзʱҲһ
+        if (!done && groupColumns.empty() && groupCount == 0 && input->error().empty()) {
+            uint64_t hash = mixHash(hashBytes(key.data(), keySize));
+            size_t slot;
+            find(hash, slot);
+            insert(hash, slot, nullptr);
+        }
+    }
+
+    while (!done) {
+        if (emitPos < groupCount) {
+            return finish(entries.data() + static_cast<size_t>(emitPos++) * entrySize);
+        }
+        if (pending.empty()) break;
+        Pending part = std::move(pending.back());
+        pending.pop_back();
+        SpillFile* file = part.file.get();
+        if (!aggregate([file] { return file->read(); }, part.level)) break;
+    }
+
+    done = true;
+    clearTable();
+    pending.clear();
+    if (errorMessage.empty()) errorMessage = input->error();
+    return nullptr;
+}
+
+// 
+CountOperator::CountOperator(std::unique_ptr<ScanOperator> scan, const std::vector<std::string>& names)
+    : scan(std::move(scan)) {
+    Table schema;
+    for (const auto& name : names) schema.columns.push_back({name, ColumnType::BIGINT, 8});
+    setSchema(schema);
+    out.resize(outLayout.rowSize);
+}
+
+const char* CountOperator::produce() {
+    if (done) return nullptr;
+    done = true;
+    int64_t count = static_cast<int64_t>(scan->countRows());
+    if (!scan->error().empty()) {
+        errorMessage = scan->error();
+        return nullptr;
+    }
+    for (size_t i = 0; i < outLayout.offsets.size(); ++i) {
+        std::memcpy(out.data() + outLayout.offsets[i], &count, sizeof(count));
+    }
+    return out.data();
+}
@@ -0,0 +1,116 @@
+#ifndef AGGREGATE_H
+#define AGGREGATE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Operator.h"
+
+// ۺϺ
+enum class AggregateFunc {
+    COUNT,
+    SUM,
+    MIN,
+    MAX,
+    AVG
+};
+
+// һۺУstar Ϊ true ʾ COUNT(*) column Ϊек
+struct AggregateSpec {
+    AggregateFunc func;
+    bool star;
+    size_t column;
+    std::string name;  //  SUM(salary)
+};
+
+//  SUM(col) ѡǾۺϺʱ false
+bool parseAggregate(const std::string& text, AggregateFunc& func, std::string& argument);
+
+// ϣۺϣпɶ뿪Ѱַϣÿ鱣ۺϺм״̬
+// ڴ޺³ֵӦаϣдʱļ
+// ڴеۺϣԷŲʱϸ
+// ΪкӾۺУCOUNT  SUM  BIGINTAVG  DOUBLEMIN/MAX ͬ
+// ûзʱһУΪʱۺֵΪ 0 մ
+class HashAggregate : public Operator {
+public:
+    HashAggregate(std::unique_ptr<Operator> input, const std::vector<size_t>& groupColumns,
+                  const std::vector<AggregateSpec>& aggregates,
+                  const std::string& spillDir, size_t memoryLimit);
+
+    uint64_t estimatedRows() const override;
+    std::string describe() const override;
+    std::vector<Operator*> inputs() const override { return {input.get()}; }
+
+protected:
+    const char* produce() override;
+
+private:
+    static const uint32_t PARTITIONS = 16;
+    static const uint32_t PARTITION_BITS = 4;
+    static const int MAX_LEVEL = 3;
+    static const uint32_t NO_GROUP = UINT32_MAX;
+
+    struct Pending {
+        std::unique_ptr<SpillFile> file;
+        int level;
+    };
+
+    // һԴۺϣ false ʾʱļдʧ
+    template <typename Source>
+    bool aggregate(Source source, int level);
+    void buildKey(const char* row);
+    void clearTable();
+    void grow();
+    // ҷҲʱ NO_GROUPslot ΪɲĿղ
+    uint32_t find(uint64_t hash, size_t& slot) const;
+    // ½һ飬row ΪĵһУΪʱ״̬
+    uint32_t insert(uint64_t hash, size_t slot, const char* row);
+    size_t memoryUsed() const;
+    void updateState(char* state, const char* row);
+    const char* finish(const char* entry);
+
+    std::unique_ptr<Operator> input;
+    std::vector<size_t> groupColumns;
+    std::vector<AggregateSpec> aggregates;
+    std::string spillDir;
+    size_t memoryLimit;
+
+    const TableLayout& inputLayout;
+    uint32_t keySize = 0;
+    std::vector<uint32_t> stateOffsets;  // ÿۺϺ״̬еƫ
+    uint32_t entrySize = 0;
+
+    // Ѱַϣslots żһ0 Ϊղ
+    std::vector<char> entries;
+    std::vector<uint64_t> hashes;
+    std::vector<uint32_t> slots;
+    uint32_t groupCount = 0;
+    std::vector<char> key;
+
+    std::vector<Pending> pending;  // ۺϵķ
+    uint32_t emitPos = 0;
+    bool started = false;
+    bool done = false;
+    std::vector<char> out;
+};
+
+// ֻ COUNT(*) ĵѯֻͳ
+class CountOperator : public Operator {
+public:
+    CountOperator(std::unique_ptr<ScanOperator> scan, const std::vector<std::string>& names);
+
+    uint64_t estimatedRows() const override { return 1; }
+    std::string describe() const override { return "Count"; }
+    std::vector<Operator*> inputs() const override { return {scan.get()}; }
+
+protected:
+    const char* produce() override;
+
+private:
+    std::unique_ptr<ScanOperator> scan;
+    bool done = false;
+    std::vector<char> out;
+};
+
+#endif // AGGREGATE_H
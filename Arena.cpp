@@ -0,0 +1,89 @@
+#include "Arena.h"
+#include <algorithm>
+#include <cstring>
+#include "Hash.h"
+
+void* Arena::allocate(size_t size, size_t align) {
+    if (current < blocks.size()) {
+        size_t offset = (used + align - 1) & ~(align - 1);
+        if (offset + size <= blocks[current].size) {
+            used = offset + size;
+            return blocks[current].data.get() + offset;
+        }
+    }
+    // ǰŲʱһ飻һҲŲ»ûһʱڴ˴¿飬С󵥶ռһ
+    size_t need = size + align;
+    size_t next = blocks.empty() ? 0 : current + 1;
+    if (next == blocks.size() || blocks[next].size < need) {
+        size_t bytes = std::max(need, blockSize);
+        blocks.insert(blocks.begin() + next, Block{std::unique_ptr<char[]>(new char[bytes]), bytes});
+    }
+    current = next;
+    used = 0;
+    return allocate(size, align);
+}
+
+const char* Arena::copy(std::string_view text) {
+    char* p = static_cast<char*>(allocate(text.size() + 1, 1));
+    std::memcpy(p, text.data(), text.size());
+    p[text.size()] = '\0';
+    return p;
+}
+
+const char* Arena::concat(std::initializer_list<std::string_view> parts) {
+    size_t size = 0;
+    for (std::string_view part : parts) size += part.size();
+    char* p = static_cast<char*>(allocate(size + 1, 1));
+    char* out = p;
+    for (std::string_view part : parts) {
+        std::memcpy(out, part.data(), part.size());
+        out += part.size();
+    }
+    *out = '\0';
+    return p;
+}
+
+const char* Arena::intern(std::string_view text) {
+    if ((symbolCount + 1) * 2 > symbols.size()) growSymbols();
+    uint32_t hash = static_cast<uint32_t>(hashBytes(text.data(), text.size()));
+    size_t mask = symbols.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        Symbol& symbol = symbols[i];
+        if (!symbol.text) {
+            symbol = {copy(text), static_cast<uint32_t>(text.size()), hash};
+            symbolCount++;
+            return symbol.text;
+        }
+        if (symbol.hash == hash && symbol.length == text.size() &&
+            std::memcmp(symbol.text, text.data(), text.size()) == 0) {
+            return symbol.text;
+        }
+    }
+}
+
+void Arena::growSymbols() {
+    std::vector<Symbol> old(std::max<size_t>(symbols.size() * 2, 64), Symbol{nullptr, 0, 0});
+    old.swap(symbols);
+    size_t mask = symbols.size() - 1;
+    for (const Symbol& symbol : old) {
+        if (!symbol.text) continue;
+        size_t i = symbol.hash & mask;
+        while (symbols[i].text) i = (i + 1) & mask;
+        symbols[i] = symbol;
+    }
+}
+
+// ܴС ARENA_RETAIN_BYTES ʱ(Ϊ INSERT)ֻһ飬һ鱾ʱҲͷ
+void Arena::reset() {
+    current = 0;
+    used = 0;
+    if (symbolCount > 0) {
+        std::fill(symbols.begin(), symbols.end(), Symbol{nullptr, 0, 0});
+        symbolCount = 0;
+    }
+    size_t total = 0;
+    for (const Block& block : blocks) total += block.size;
+    if (total > ARENA_RETAIN_BYTES) {
+        blocks.erase(blocks.begin() + (blocks[0].size > ARENA_RETAIN_BYTES ? 0 : 1), blocks.end());
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// ÿĴСreset ĿܴСޣʱֻһ
+const size_t ARENA_BLOCK_SIZE = 64 * 1024;
+const size_t ARENA_RETAIN_BYTES = 1024 * 1024;
+
+// ʹõڴӴ˳гڴ棬ͷţʱ reset һջأ
+// Ŀһ䣬ȶִ䲻ϵͳڴ
+// ֻŲҪ(ı)ÿỰһɱ߳ͬʱʹ
+class Arena {
+public:
+    explicit Arena(size_t blockSize = ARENA_BLOCK_SIZE) : blockSize(blockSize) {}
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t));
+    template <typename T>
+    T* allocateArray(size_t count) { return static_cast<T*>(allocate(count * sizeof(T), alignof(T))); }
+
+    //  0 βĸ
+    const char* copy(std::string_view text);
+    // ƴӸΣ 0 β
+    const char* concat(std::initializer_list<std::string_view> parts);
+    // פʶreset ֮ǰͬıֻһݣͬһָ
+    const char* intern(std::string_view text);
+
+    // ջڴ棬֮ǰصָȫʧЧ
+    void reset();
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+    struct Symbol {
+        const char* text;  // λΪ nullptr
+        uint32_t length;
+        uint32_t hash;
+    };
+
+    void growSymbols();
+
+    size_t blockSize;
+    std::vector<Block> blocks;
+    size_t current = 0;  // ʹõĿ
+    size_t used = 0;     // ǰõֽ
+    // פѰַΪ 2 ݣreset ʱյ
+    std::vector<Symbol> symbols;
+    size_t symbolCount = 0;
+};
+
+#endif // ARENA_H
@@ -0,0 +1,420 @@
+#include "BTree.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+BTree::BTree(BufferPool& pool, const std::string& path) : pool(pool), path(path) {
+    char* data = pool.fetchPage(path, 0);
+    if (!data) return;
+    MetaPage meta;
+    std::memcpy(&meta, data, sizeof(meta));
+    pool.unpinPage(path, 0, false);
+    if (meta.magic != INDEX_MAGIC) return;
+
+    keyType = static_cast<ColumnType>(meta.keyType);
+    keySize = meta.keySize;
+    root = meta.root;
+    valid = keySize > 0 && innerCapacity() >= 3;
+}
+
+bool BTree::create(const std::string& path, ColumnType type, uint32_t keySize) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+
+    std::vector<char> page(PAGE_SIZE, 0);
+    MetaPage meta = {INDEX_MAGIC, 1, static_cast<uint32_t>(type), keySize};
+    std::memcpy(page.data(), &meta, sizeof(meta));
+    file.write(page.data(), PAGE_SIZE);
+
+    // ڵΪҶڵ
+    std::fill(page.begin(), page.end(), 0);
+    NodeHeader header = {1, 0, 0};
+    std::memcpy(page.data(), &header, sizeof(header));
+    file.write(page.data(), PAGE_SIZE);
+    return static_cast<bool>(file);
+}
+
+// Ƚ
+int BTree::compareKey(const char* a, const char* b) const {
+    if (keyType == ColumnType::INT) {
+        int32_t x, y;
+        std::memcpy(&x, a, sizeof(x));
+        std::memcpy(&y, b, sizeof(y));
+        return (x < y) ? -1 : (x > y ? 1 : 0);
+    }
+    return std::memcmp(a, b, keySize);
+}
+
+int BTree::compareEntry(const char* keyA, RID ridA, const char* keyB, RID ridB) const {
+    int cmp = compareKey(keyA, keyB);
+    if (cmp != 0) return cmp;
+    if (ridA.page != ridB.page) return ridA.page < ridB.page ? -1 : 1;
+    if (ridA.slot != ridB.slot) return ridA.slot < ridB.slot ? -1 : 1;
+    return 0;
+}
+
+uint32_t BTree::searchEntries(const char* entries, uint32_t count, uint32_t size,
+                              const char* key, RID rid, bool keyOnly, bool strict) const {
+    uint32_t low = 0;
+    uint32_t high = count;
+    while (low < high) {
+        uint32_t mid = (low + high) / 2;
+        const char* e = entries + mid * size;
+        int cmp = keyOnly ? compareKey(e, key) : compareEntry(e, readRid(e + keySize), key, rid);
+        if (strict ? cmp > 0 : cmp >= 0) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return low;
+}
+
+RID BTree::readRid(const char* p) {
+    RID rid;
+    std::memcpy(&rid.page, p, sizeof(rid.page));
+    std::memcpy(&rid.slot, p + 4, sizeof(rid.slot));
+    return rid;
+}
+
+void BTree::writeRid(char* p, RID rid) {
+    std::memset(p, 0, 8);
+    std::memcpy(p, &rid.page, sizeof(rid.page));
+    std::memcpy(p + 4, &rid.slot, sizeof(rid.slot));
+}
+
+// 
+bool BTree::insert(const char* key, RID rid) {
+    if (!valid) return false;
+
+    std::vector<char> splitKey(keySize);
+    RID splitRid = {0, 0};
+    uint32_t splitPage = 0;
+    bool split = false;
+    if (!insertInto(root, key, rid, splitKey, splitRid, splitPage, split)) return false;
+    if (!split) return true;
+
+    // ڵѣ߼һ
+    uint32_t newRoot;
+    char* data = pool.newPage(path, newRoot);
+    if (!data) return false;
+    NodeHeader header = {0, 1, root};
+    std::memcpy(data, &header, sizeof(header));
+    char* entry = data + sizeof(NodeHeader);
+    std::memcpy(entry, splitKey.data(), keySize);
+    writeRid(entry + keySize, splitRid);
+    std::memcpy(entry + keySize + 8, &splitPage, sizeof(splitPage));
+    pool.unpinPage(path, newRoot, true);
+    return setRoot(newRoot);
+}
+
+bool BTree::insertInto(uint32_t pageNo, const char* key, RID rid,
+                       std::vector<char>& splitKey, RID& splitRid, uint32_t& splitPage, bool& split) {
+    split = false;
+    char* data = pool.fetchPage(path, pageNo);
+    if (!data) return false;
+    NodeHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    if (header.isLeaf) {
+        uint32_t size = leafEntrySize();
+        char* entries = data + sizeof(NodeHeader);
+        uint32_t pos = searchEntries(entries, header.count, size, key, rid, false, false);
+        if (pos < header.count) {
+            const char* e = entries + pos * size;
+            if (compareEntry(e, readRid(e + keySize), key, rid) == 0) {
+                pool.unpinPage(path, pageNo, false);
+                return true;  // Ѵ
+            }
+        }
+
+        // ʱв룬پǷ
+        std::vector<char> temp((header.count + 1) * size);
+        std::memcpy(temp.data(), entries, pos * size);
+        std::memcpy(temp.data() + pos * size, key, keySize);
+        writeRid(temp.data() + pos * size + keySize, rid);
+        std::memcpy(temp.data() + (pos + 1) * size, entries + pos * size, (header.count - pos) * size);
+        uint32_t total = header.count + 1;
+
+        if (total <= leafCapacity()) {
+            std::memcpy(entries, temp.data(), total * size);
+            header.count = static_cast<uint16_t>(total);
+            std::memcpy(data, &header, sizeof(header));
+            pool.unpinPage(path, pageNo, true);
+            return true;
+        }
+
+        uint32_t newNo;
+        char* right = pool.newPage(path, newNo);
+        if (!right) {
+            pool.unpinPage(path, pageNo, false);
+            return false;
+        }
+        // Ҷڵĩβ׷(˳)ʱֻĿֳȥʹҶڵ㱣װ
+        uint32_t leftCount = (pos == header.count && header.link == 0) ? total - 1 : total / 2;
+        NodeHeader rightHeader = {1, static_cast<uint16_t>(total - leftCount), header.link};
+        std::memcpy(right, &rightHeader, sizeof(rightHeader));
+        std::memcpy(right + sizeof(NodeHeader), temp.data() + leftCount * size, (total - leftCount) * size);
+
+        header.count = static_cast<uint16_t>(leftCount);
+        header.link = newNo;
+        std::memcpy(data, &header, sizeof(header));
+        std::memcpy(entries, temp.data(), leftCount * size);
+
+        // ҽڵһĿΪָ
+        std::memcpy(splitKey.data(), temp.data() + leftCount * size, keySize);
+        splitRid = readRid(temp.data() + leftCount * size + keySize);
+        splitPage = newNo;
+        split = true;
+        pool.unpinPage(path, newNo, true);
+        pool.unpinPage(path, pageNo, true);
+        return true;
+    }
+
+    // ڲڵ㣺ҵӽڵݹ
+    uint32_t size = innerEntrySize();
+    uint32_t pos = 0;
+    uint32_t child = header.link;
+    {
+        const char* entries = data + sizeof(NodeHeader);
+        pos = searchEntries(entries, header.count, size, key, rid, false, true);
+        if (pos > 0) std::memcpy(&child, entries + (pos - 1) * size + keySize + 8, sizeof(child));
+    }
+    pool.unpinPage(path, pageNo, false);
+
+    bool childSplit = false;
+    std::vector<char> childKey(keySize);
+    RID childRid = {0, 0};
+    uint32_t childPage = 0;
+    if (!insertInto(child, key, rid, childKey, childRid, childPage, childSplit)) return false;
+    if (!childSplit) return true;
+
+    data = pool.fetchPage(path, pageNo);
+    if (!data) return false;
+    std::memcpy(&header, data, sizeof(header));
+    char* entries = data + sizeof(NodeHeader);
+
+    std::vector<char> temp((header.count + 1) * size);
+    std::memcpy(temp.data(), entries, pos * size);
+    char* slot = temp.data() + pos * size;
+    std::memcpy(slot, childKey.data(), keySize);
+    writeRid(slot + keySize, childRid);
+    std::memcpy(slot + keySize + 8, &childPage, sizeof(childPage));
+    std::memcpy(temp.data() + (pos + 1) * size, entries + pos * size, (header.count - pos) * size);
+    uint32_t total = header.count + 1;
+
+    if (total <= innerCapacity()) {
+        std::memcpy(entries, temp.data(), total * size);
+        header.count = static_cast<uint16_t>(total);
+        std::memcpy(data, &header, sizeof(header));
+        pool.unpinPage(path, pageNo, true);
+        return true;
+    }
+
+    // ڲڵѣмĿҲӽڵ
+    uint32_t newNo;
+    char* right = pool.newPage(path, newNo);
+    if (!right) {
+        pool.unpinPage(path, pageNo, false);
+        return false;
+    }
+    uint32_t mid = total / 2;
+    const char* middle = temp.data() + mid * size;
+    uint32_t middleChild;
+    std::memcpy(&middleChild, middle + keySize + 8, sizeof(middleChild));
+
+    NodeHeader rightHeader = {0, static_cast<uint16_t>(total - mid - 1), middleChild};
+    std::memcpy(right, &rightHeader, sizeof(rightHeader));
+    std::memcpy(right + sizeof(NodeHeader), middle + size, (total - mid - 1) * size);
+
+    header.count = static_cast<uint16_t>(mid);
+    std::memcpy(data, &header, sizeof(header));
+    std::memcpy(entries, temp.data(), mid * size);
+
+    std::memcpy(splitKey.data(), middle, keySize);
+    splitRid = readRid(middle + keySize);
+    splitPage = newNo;
+    split = true;
+    pool.unpinPage(path, newNo, true);
+    pool.unpinPage(path, pageNo, true);
+    return true;
+}
+
+bool BTree::empty() {
+    if (!valid) return false;
+    char* data = pool.fetchPage(path, root);
+    if (!data) return false;
+    NodeHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    pool.unpinPage(path, root, false);
+    return header.isLeaf && header.count == 0;
+}
+
+bool BTree::build(const std::vector<std::pair<const char*, RID>>& entries) {
+    if (!empty()) return false;
+    if (entries.empty()) return true;
+
+    // ÿڵĵһĿҳţڹһ
+    struct Child {
+        const char* key;
+        RID rid;
+        uint32_t page;
+    };
+    std::vector<Child> level;
+
+    // ҶڵװԭĿոڵΪһҶڵ
+    uint32_t size = leafEntrySize();
+    size_t capacity = leafCapacity();
+    uint32_t pageNo = root;
+    char* data = pool.fetchPage(path, pageNo);
+    if (!data) return false;
+    for (size_t i = 0; i < entries.size(); i += capacity) {
+        size_t n = std::min(capacity, entries.size() - i);
+        char* out = data + sizeof(NodeHeader);
+        for (size_t k = 0; k < n; ++k) {
+            std::memcpy(out + k * size, entries[i + k].first, keySize);
+            writeRid(out + k * size + keySize, entries[i + k].second);
+        }
+        level.push_back({entries[i].first, entries[i].second, pageNo});
+
+        uint32_t next = 0;
+        char* nextData = nullptr;
+        if (i + n < entries.size()) {
+            nextData = pool.newPage(path, next);
+            if (!nextData) {
+                pool.unpinPage(path, pageNo, false);
+                return false;
+            }
+        }
+        NodeHeader header = {1, static_cast<uint16_t>(n), next};
+        std::memcpy(data, &header, sizeof(header));
+        pool.unpinPage(path, pageNo, true);
+        pageNo = next;
+        data = nextData;
+    }
+
+    // Ϲڲڵ㣬ָĿΪҲĵһĿ
+    size = innerEntrySize();
+    capacity = innerCapacity();
+    while (level.size() > 1) {
+        std::vector<Child> parents;
+        for (size_t i = 0; i < level.size(); i += capacity + 1) {
+            size_t n = std::min(capacity + 1, level.size() - i);
+            uint32_t nodeNo;
+            char* node = pool.newPage(path, nodeNo);
+            if (!node) return false;
+            NodeHeader header = {0, static_cast<uint16_t>(n - 1), level[i].page};
+            std::memcpy(node, &header, sizeof(header));
+            char* out = node + sizeof(NodeHeader);
+            for (size_t k = 1; k < n; ++k) {
+                char* e = out + (k - 1) * size;
+                std::memcpy(e, level[i + k].key, keySize);
+                writeRid(e + keySize, level[i + k].rid);
+                std::memcpy(e + keySize + 8, &level[i + k].page, sizeof(uint32_t));
+            }
+            pool.unpinPage(path, nodeNo, true);
+            parents.push_back({level[i].key, level[i].rid, nodeNo});
+        }
+        level.swap(parents);
+    }
+    return setRoot(level[0].page);
+}
+
+// ɾֻҶڵƳĿڵϲ
+bool BTree::remove(const char* key, RID rid) {
+    if (!valid) return false;
+
+    uint32_t pageNo = findLeaf(key, rid, false);
+    char* data = pool.fetchPage(path, pageNo);
+    if (!data) return false;
+    NodeHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    uint32_t size = leafEntrySize();
+    char* entries = data + sizeof(NodeHeader);
+    uint32_t i = searchEntries(entries, header.count, size, key, rid, false, false);
+    if (i < header.count) {
+        char* e = entries + i * size;
+        if (compareEntry(e, readRid(e + keySize), key, rid) == 0) {
+            std::memmove(e, e + size, (header.count - i - 1) * size);
+            header.count--;
+            std::memcpy(data, &header, sizeof(header));
+            pool.unpinPage(path, pageNo, true);
+            return true;
+        }
+    }
+    pool.unpinPage(path, pageNo, false);
+    return false;
+}
+
+// 
+uint32_t BTree::findLeaf(const char* key, RID rid, bool keyOnly) {
+    uint32_t pageNo = root;
+    while (true) {
+        char* data = pool.fetchPage(path, pageNo);
+        if (!data) return pageNo;
+        NodeHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        if (header.isLeaf) {
+            pool.unpinPage(path, pageNo, false);
+            return pageNo;
+        }
+
+        // ޼ʱ·ֻȽϼʱȡһܰüӽڵ
+        uint32_t size = innerEntrySize();
+        const char* entries = data + sizeof(NodeHeader);
+        uint32_t child = header.link;
+        if (key) {
+            uint32_t pos = searchEntries(entries, header.count, size, key, rid, keyOnly, !keyOnly);
+            if (pos > 0) std::memcpy(&child, entries + (pos - 1) * size + keySize + 8, sizeof(child));
+        }
+        pool.unpinPage(path, pageNo, false);
+        pageNo = child;
+    }
+}
+
+void BTree::search(const char* low, bool lowInclusive,
+                   const char* high, bool highInclusive,
+                   std::vector<RID>& result) {
+    if (!valid) return;
+
+    RID none = {0, 0};
+    uint32_t pageNo = findLeaf(low, none, true);
+    uint32_t size = leafEntrySize();
+    while (pageNo != 0) {
+        char* data = pool.fetchPage(path, pageNo);
+        if (!data) return;
+        NodeHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        const char* entries = data + sizeof(NodeHeader);
+        for (uint32_t i = 0; i < header.count; ++i) {
+            const char* e = entries + i * size;
+            if (low) {
+                int cmp = compareKey(e, low);
+                if (cmp < 0 || (cmp == 0 && !lowInclusive)) continue;
+            }
+            if (high) {
+                int cmp = compareKey(e, high);
+                if (cmp > 0 || (cmp == 0 && !highInclusive)) {
+                    pool.unpinPage(path, pageNo, false);
+                    return;
+                }
+            }
+            result.push_back(readRid(e + keySize));
+        }
+        pool.unpinPage(path, pageNo, false);
+        pageNo = header.link;
+    }
+}
+
+bool BTree::setRoot(uint32_t pageNo) {
+    char* data = pool.fetchPage(path, 0);
+    if (!data) return false;
+    MetaPage meta;
+    std::memcpy(&meta, data, sizeof(meta));
+    meta.root = pageNo;
+    std::memcpy(data, &meta, sizeof(meta));
+    pool.unpinPage(path, 0, true);
+    root = pageNo;
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#ifndef BTREE_H
+#define BTREE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Schema.h"
+#include "Storage.h"
+#include "BufferPool.h"
+
+const uint32_t INDEX_MAGIC = 0x49424453;  // "SDBI"
+
+// ־û B+ ҳͨط
+// Ϊֵ(, RID) Ψһظ
+class BTree {
+public:
+    BTree(BufferPool& pool, const std::string& path);
+
+    // ½ֻпոڵļ
+    static bool create(const std::string& path, ColumnType type, uint32_t keySize);
+
+    bool isValid() const { return valid; }
+    // ڲڵҪ 3 ܳÿ
+    static uint32_t maxKeySize() { return (PAGE_SIZE - sizeof(NodeHeader)) / 3 - 12; }
+    bool insert(const char* key, RID rid);
+    bool remove(const char* key, RID rid);
+    bool empty();
+    // ԵΪentries 밴 (, RID) 
+    bool build(const std::vector<std::pair<const char*, RID>>& entries);
+    // Χңlow/high Ϊָʾޱ߽磬 (, RID) 
+    void search(const char* low, bool lowInclusive,
+                const char* high, bool highInclusive,
+                std::vector<RID>& result);
+
+private:
+    // ڵҳͷ
+    struct NodeHeader {
+        uint16_t isLeaf;
+        uint16_t count;
+        uint32_t link;  // ҶڵΪֵҳţڲڵΪӽڵҳ
+    };
+    // Ԫҳ( 0 ҳ)
+    struct MetaPage {
+        uint32_t magic;
+        uint32_t root;
+        uint32_t keyType;
+        uint32_t keySize;
+    };
+
+    int compareKey(const char* a, const char* b) const;
+    int compareEntry(const char* keyA, RID ridA, const char* keyB, RID ridB) const;
+    // ڵڶֲңصһ(strict)СڸĿλ
+    uint32_t searchEntries(const char* entries, uint32_t count, uint32_t size,
+                           const char* key, RID rid, bool keyOnly, bool strict) const;
+    static RID readRid(const char* p);
+    static void writeRid(char* p, RID rid);
+
+    uint32_t leafEntrySize() const { return keySize + 8; }
+    uint32_t innerEntrySize() const { return keySize + 12; }
+    uint32_t leafCapacity() const { return (PAGE_SIZE - sizeof(NodeHeader)) / leafEntrySize(); }
+    uint32_t innerCapacity() const { return (PAGE_SIZE - sizeof(NodeHeader)) / innerEntrySize(); }
+
+    bool insertInto(uint32_t pageNo, const char* key, RID rid,
+                    std::vector<char>& splitKey, RID& splitRid, uint32_t& splitPage, bool& split);
+    uint32_t findLeaf(const char* key, RID rid, bool keyOnly);
+    bool setRoot(uint32_t pageNo);
+
+    BufferPool& pool;
+    std::string path;
+    ColumnType keyType = ColumnType::INT;
+    uint32_t keySize = 0;
+    uint32_t root = 0;
+    bool valid = false;
+};
+
+#endif // BTREE_H
\ No newline at end of file
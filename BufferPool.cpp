@@ -0,0 +1,316 @@
+#include "BufferPool.h"
+#include <algorithm>
+#include <cstring>
+
+BufferPool::BufferPool(size_t budgetBytes) {
+    size_t count = std::max<size_t>(budgetBytes / PAGE_SIZE, 16);
+    frames.resize(count);
+    for (size_t i = count; i > 0; --i) {
+        freeFrames.push_back(i - 1);
+    }
+}
+
+BufferPool::~BufferPool() {
+    flushAll();
+}
+
+// ҳ
+char* BufferPool::fetchPage(const std::string& path, uint32_t pageNo, bool* hit) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return fetchLocked(path, pageNo, hit);
+}
+
+// ѻҳճأҳֱӶļӳ䣬ȲҲռû֡
+// ߳бĹЩҳʹڼ䲻ᱻд
+const char* BufferPool::viewPage(const std::string& path, uint32_t pageNo, bool& pinned, bool* hit) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pinned = true;
+    if (pageTable.find(PageKey(path, pageNo)) == pageTable.end()) {
+        FileState* state = openFile(path);
+        if (!state || pageNo >= state->pageCount) return nullptr;
+        if (const char* data = state->file->mapPage(pageNo)) {
+            pinned = false;
+            mapCount++;
+            if (hit) *hit = false;
+            return data;
+        }
+    }
+    return fetchLocked(path, pageNo, hit);
+}
+
+char* BufferPool::fetchLocked(const std::string& path, uint32_t pageNo, bool* hit) {
+    auto it = pageTable.find(PageKey(path, pageNo));
+    if (it != pageTable.end()) {
+        Frame& frame = frames[it->second];
+        if (frame.pinCount++ == 0) {
+            evictable.erase({evictKey(frame), it->second});
+        }
+        touch(frame);
+        capture(it->second);
+        hitCount++;
+        if (hit) *hit = true;
+        return frame.data.get();
+    }
+
+    FileState* state = openFile(path);
+    if (!state || pageNo >= state->pageCount) return nullptr;
+
+    int index = allocateFrame();
+    if (index < 0) return nullptr;
+    Frame& frame = frames[index];
+    if (!state->file->readPage(pageNo, frame.data.get())) {
+        freeFrames.push_back(index);
+        return nullptr;
+    }
+    missCount++;
+    if (hit) *hit = false;
+
+    frame.path = path;
+    frame.pageNo = pageNo;
+    frame.pinCount = 1;
+    frame.dirty = false;
+    frame.inUse = true;
+    frame.refs = 0;
+    touch(frame);
+    pageTable[PageKey(path, pageNo)] = index;
+    capture(index);
+    return frame.data.get();
+}
+
+char* BufferPool::newPage(const std::string& path, uint32_t& pageNo) {
+    std::lock_guard<std::mutex> lock(mutex);
+    FileState* state = openFile(path);
+    if (!state) return nullptr;
+
+    int index = allocateFrame();
+    if (index < 0) return nullptr;
+    Frame& frame = frames[index];
+    std::memset(frame.data.get(), 0, PAGE_SIZE);
+
+    pageNo = state->pageCount++;
+    frame.path = path;
+    frame.pageNo = pageNo;
+    frame.pinCount = 1;
+    frame.dirty = true;
+    frame.inUse = true;
+    frame.refs = 0;
+    touch(frame);
+    pageTable[PageKey(path, pageNo)] = index;
+    capture(index);
+    return frame.data.get();
+}
+
+void BufferPool::unpinPage(const std::string& path, uint32_t pageNo, bool dirty) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = pageTable.find(PageKey(path, pageNo));
+    if (it == pageTable.end()) return;
+    Frame& frame = frames[it->second];
+    if (dirty) frame.dirty = true;
+    if (frame.pinCount > 0 && --frame.pinCount == 0) {
+        evictable.insert({evictKey(frame), it->second});
+    }
+}
+
+uint32_t BufferPool::pageCount(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    FileState* state = openFile(path);
+    return state ? state->pageCount : 0;
+}
+
+// ˢ
+bool BufferPool::flushFile(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    bool ok = true;
+    for (auto& frame : frames) {
+        if (frame.inUse && frame.dirty && frame.path == path) {
+            ok = writeBack(frame) && ok;
+        }
+    }
+    auto it = files.find(path);
+    if (it != files.end()) {
+        ok = it->second.file->sync() && ok;
+    }
+    return ok;
+}
+
+bool BufferPool::flushAll() {
+    std::lock_guard<std::mutex> lock(mutex);
+    bool ok = true;
+    for (auto& frame : frames) {
+        if (frame.inUse && frame.dirty) {
+            ok = writeBack(frame) && ok;
+        }
+    }
+    for (auto& file : files) {
+        ok = file.second.file->flush() && ok;
+    }
+    return ok;
+}
+
+bool BufferPool::appendPages(const std::string& path, const char* pages, uint32_t count, uint32_t& firstPage) {
+    std::lock_guard<std::mutex> lock(mutex);
+    FileState* state = openFile(path);
+    if (!state) return false;
+    firstPage = state->pageCount;
+    if (!state->file->writePages(firstPage, pages, count)) return false;
+    state->pageCount += count;
+    writeCount += count;
+    return true;
+}
+
+bool BufferPool::syncAll() {
+    std::lock_guard<std::mutex> lock(mutex);
+    bool ok = true;
+    for (auto& file : files) {
+        ok = file.second.file->sync() && ok;
+    }
+    return ok;
+}
+
+// ޸Ĳ
+void BufferPool::beginCapture(uint64_t statement) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Capture& owner = captures[std::this_thread::get_id()];
+    owner.statement = statement;
+    owner.frames.clear();
+}
+
+void BufferPool::endCapture() {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = captures.find(std::this_thread::get_id());
+    if (it == captures.end()) return;
+    for (size_t index : it->second.frames) {
+        Frame& frame = frames[index];
+        if (frame.capturedBy != &it->second) continue;
+        logCaptured(frame);
+        frame.capturedBy = nullptr;
+    }
+    captures.erase(it);
+}
+
+void BufferPool::dropFile(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < frames.size(); ++i) {
+        if (frames[i].inUse && frames[i].path == path) {
+            releaseFrame(i);
+        }
+    }
+    files.erase(path);
+}
+
+void BufferPool::dropFiles(const std::string& prefix) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < frames.size(); ++i) {
+        if (frames[i].inUse && frames[i].path.compare(0, prefix.size(), prefix) == 0) {
+            releaseFrame(i);
+        }
+    }
+    for (auto it = files.begin(); it != files.end();) {
+        if (it->first.compare(0, prefix.size(), prefix) == 0) {
+            it = files.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// ڲ
+BufferPool::FileState* BufferPool::openFile(const std::string& path) {
+    auto it = files.find(path);
+    if (it != files.end()) return &it->second;
+
+    std::unique_ptr<TableFile> file(new TableFile(path));
+    if (!file->isOpen()) return nullptr;
+    FileState& state = files[path];
+    state.pageCount = file->pageCount();
+    state.file = std::move(file);
+    return &state;
+}
+
+int BufferPool::allocateFrame() {
+    size_t index;
+    if (!freeFrames.empty()) {
+        index = freeFrames.back();
+        freeFrames.pop_back();
+    } else {
+        // ̭ K ηʾõҳ
+        if (evictable.empty()) return -1;
+        index = evictable.begin()->second;
+        Frame& victim = frames[index];
+        if (victim.dirty && !writeBack(victim)) return -1;
+        victim.capturedBy = nullptr;
+        evictable.erase(evictable.begin());
+        pageTable.erase(PageKey(victim.path, victim.pageNo));
+        victim.inUse = false;
+        evictCount++;
+    }
+    if (!frames[index].data) {
+        frames[index].data.reset(new char[PAGE_SIZE]);
+    }
+    return static_cast<int>(index);
+}
+
+void BufferPool::touch(Frame& frame) {
+    for (int i = K - 1; i > 0; --i) {
+        frame.history[i] = frame.history[i - 1];
+    }
+    frame.history[0] = ++clock;
+    if (frame.refs < K) frame.refs++;
+}
+
+BufferPool::EvictKey BufferPool::evictKey(const Frame& frame) const {
+    if (frame.refs < K) return EvictKey(0, frame.history[0]);
+    return EvictKey(1, frame.history[K - 1]);
+}
+
+bool BufferPool::writeBack(Frame& frame) {
+    // Ԥд־ҳǰ޸ļ¼
+    if (logger) {
+        if (frame.capturedBy) {
+            logCaptured(frame);
+            std::memcpy(frame.before.get(), frame.data.get(), PAGE_SIZE);
+        }
+        logger->flushLog(frame.path);
+    }
+    FileState* state = openFile(frame.path);
+    if (!state || !state->file->writePage(frame.pageNo, frame.data.get())) return false;
+    frame.dirty = false;
+    writeCount++;
+    return true;
+}
+
+void BufferPool::releaseFrame(size_t index) {
+    Frame& frame = frames[index];
+    if (frame.pinCount == 0) {
+        evictable.erase({evictKey(frame), index});
+    }
+    pageTable.erase(PageKey(frame.path, frame.pageNo));
+    frame.inUse = false;
+    frame.dirty = false;
+    frame.capturedBy = nullptr;
+    frame.pinCount = 0;
+    freeFrames.push_back(index);
+}
+
+// ǰִ߳дʱ¼ҳ޸ǰӳ
+// ֤ͬһҳͬʱ޸ģѱ䲶ҳԭ״
+void BufferPool::capture(size_t index) {
+    if (captures.empty()) return;
+    auto it = captures.find(std::this_thread::get_id());
+    if (it == captures.end()) return;
+    Frame& frame = frames[index];
+    if (frame.capturedBy) return;
+    if (!frame.before) {
+        frame.before.reset(new char[PAGE_SIZE]);
+    }
+    std::memcpy(frame.before.get(), frame.data.get(), PAGE_SIZE);
+    frame.capturedBy = &it->second;
+    it->second.frames.push_back(index);
+}
+
+void BufferPool::logCaptured(Frame& frame) {
+    if (logger && std::memcmp(frame.before.get(), frame.data.get(), PAGE_SIZE) != 0) {
+        logger->logPageChange(frame.capturedBy->statement, frame.path, frame.pageNo,
+                              frame.before.get(), frame.data.get());
+    }
+}
\ No newline at end of file
@@ -0,0 +1,129 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Storage.h"
+
+const size_t DEFAULT_BUFFER_POOL_BYTES = 64 * 1024 * 1024;
+
+// ҳ޸־ӿڣдҳǰͨԤд־
+class PageLogger {
+public:
+    virtual ~PageLogger() {}
+    virtual void logPageChange(uint64_t statement, const std::string& path, uint32_t pageNo,
+                               const char* before, const char* after) = 0;
+    virtual void flushLog(const std::string& path) = 0;
+};
+
+// 乲ҳ棬 LRU-K (K = 2) ̭
+// йڲлɱỰ߳ͬʱʹ
+class BufferPool {
+public:
+    explicit BufferPool(size_t budgetBytes = DEFAULT_BUFFER_POOL_BYTES);
+    ~BufferPool();
+
+    // ȡҳunpinPage ֮ǰᱻhit ǿʱظҳǷڻ
+    char* fetchPage(const std::string& path, uint32_t pageNo, bool* hit = nullptr);
+    // ֻɨȡҳڻеҳֱӷرļӳеҳpinned Ϊ true ʱҪ unpinPage
+    const char* viewPage(const std::string& path, uint32_t pageNo, bool& pinned, bool* hit = nullptr);
+    // ļĩβҳȫΪ 0
+    char* newPage(const std::string& path, uint32_t& pageNo);
+    void unpinPage(const std::string& path, uint32_t pageNo, bool dirty);
+
+    uint32_t pageCount(const std::string& path);
+    // ƹֱļĩβ׷ҳʼҳ(дʹ)
+    bool appendPages(const std::string& path, const char* pages, uint32_t count, uint32_t& firstPage);
+    // дļҳ
+    bool flushFile(const std::string& path);
+    bool flushAll();
+    bool syncAll();
+    // ļлҳرļ(ɾݿǰ)
+    void dropFile(const std::string& path);
+    void dropFiles(const std::string& prefix);
+
+    // ִڼ¼ҳ޸ǰӳ񣬽ʱѲ콻־
+    // ״ִ̬֣߳еԼ¼Լʵҳ
+    void setLogger(PageLogger* logger) { this->logger = logger; }
+    void beginCapture(uint64_t statement);
+    void endCapture();
+
+    size_t capacity() const { return frames.size(); }
+    uint64_t hits() const { return hitCount; }
+    uint64_t misses() const { return missCount; }
+    uint64_t mappedReads() const { return mapCount; }
+    uint64_t evictions() const { return evictCount; }
+    uint64_t pagesWritten() const { return writeCount; }
+
+private:
+    static const int K = 2;
+
+    struct Capture {
+        uint64_t statement = 0;
+        std::vector<size_t> frames;
+    };
+
+    struct Frame {
+        std::unique_ptr<char[]> data;
+        std::string path;
+        uint32_t pageNo = 0;
+        int pinCount = 0;
+        bool dirty = false;
+        bool inUse = false;
+        uint64_t history[K] = {};  //  K ηʱ䣬history[0] Ϊһ
+        int refs = 0;
+        std::unique_ptr<char[]> before;  // 俪ʼ޸ǰҳӳ
+        Capture* capturedBy = nullptr;  // ¼ҳ޸ǰӳ
+    };
+
+    struct FileState {
+        std::unique_ptr<TableFile> file;
+        uint32_t pageCount = 0;
+    };
+
+    typedef std::pair<std::string, uint32_t> PageKey;
+    struct PageKeyHash {
+        size_t operator()(const PageKey& key) const {
+            return std::hash<std::string>()(key.first) ^ (static_cast<size_t>(key.second) * 0x9E3779B97F4A7C15ull);
+        }
+    };
+    // ̭˳򣺲 K ηʵҳȣΰ K ηʱ
+    typedef std::pair<int, uint64_t> EvictKey;
+
+    FileState* openFile(const std::string& path);
+    char* fetchLocked(const std::string& path, uint32_t pageNo, bool* hit = nullptr);
+    int allocateFrame();
+    void touch(Frame& frame);
+    EvictKey evictKey(const Frame& frame) const;
+    bool writeBack(Frame& frame);
+    void releaseFrame(size_t index);
+    void capture(size_t index);
+    void logCaptured(Frame& frame);
+
+    std::vector<Frame> frames;
+    std::vector<size_t> freeFrames;
+    std::unordered_map<PageKey, size_t, PageKeyHash> pageTable;
+    std::set<std::pair<EvictKey, size_t>> evictable;  // δҳ
+    std::map<std::string, FileState> files;
+    PageLogger* logger = nullptr;
+    std::map<std::thread::id, Capture> captures;
+    std::mutex mutex;
+    uint64_t clock = 0;
+    // ͳƼֻڳ mutex ʱ޸ģSHOW STATUS ȡ
+    std::atomic<uint64_t> hitCount{0};
+    std::atomic<uint64_t> missCount{0};
+    std::atomic<uint64_t> mapCount{0};
+    std::atomic<uint64_t> evictCount{0};
+    std::atomic<uint64_t> writeCount{0};
+};
+
+#endif // BUFFER_POOL_H
\ No newline at end of file
@@ -0,0 +1,242 @@
+#include "BulkLoader.h"
+#include "BTree.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+BulkLoader::BulkLoader(BufferPool& pool, WriteAheadLog& wal, uint64_t statement,
+                       const std::string& tablePath, const std::string& fileName,
+                       const TableLayout& layout, FreeSpaceMap& freeSpace, ZoneMap& zones,
+                       const std::vector<BulkIndex>& indexes, uint64_t stamp)
+    : pool(pool), wal(wal), statement(statement), tablePath(tablePath), fileName(fileName),
+      layout(layout), freeSpace(freeSpace), zones(zones), indexes(indexes), stamp(stamp), keys(indexes.size()) {
+    takeFreePage();
+}
+
+BulkLoader::~BulkLoader() {
+    releaseFillPage();
+}
+
+bool BulkLoader::add(const char* row) {
+    RID rid;
+    // ҳҲܱ÷д
+    int slot = -1;
+    while (fillPage && (slot = PageRef(fillPage, layout).findFreeSlot()) < 0) {
+        releaseFillPage();
+        takeFreePage();
+    }
+    if (fillPage) {
+        PageRef page(fillPage, layout);
+        std::memcpy(page.slotData(slot), row, layout.rowSize);
+        page.version(slot) = {stamp, 0};
+        page.setUsed(slot, true);
+        rid.page = fillPageNo;
+        rid.slot = static_cast<uint16_t>(slot);
+    } else {
+        if (chunkPages == 0 || PageRef(&chunk[(chunkPages - 1) * PAGE_SIZE], layout).usedCount() == layout.slotsPerPage) {
+            if (chunkPages == CHUNK_PAGES && !flushChunk()) return false;
+            if (chunkPages == 0) {
+                chunk.assign(static_cast<size_t>(CHUNK_PAGES) * PAGE_SIZE, 0);
+                chunkFirstPage = pool.pageCount(tablePath);
+            }
+            PageRef(&chunk[chunkPages * PAGE_SIZE], layout).init();
+            chunkPages++;
+        }
+        PageRef page(&chunk[(chunkPages - 1) * PAGE_SIZE], layout);
+        // ҳ˳䣬òλһвλ
+        uint32_t slot = page.usedCount();
+        std::memcpy(page.slotData(slot), row, layout.rowSize);
+        page.version(slot) = {stamp, 0};
+        page.setUsed(slot, true);
+        rid.page = chunkFirstPage + chunkPages - 1;
+        rid.slot = static_cast<uint16_t>(slot);
+    }
+    zones.add(rid.page, row);
+
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        size_t col = indexes[i].column;
+        const char* key = row + layout.offsets[col];
+        keys[i].insert(keys[i].end(), key, key + layout.widths[col]);
+    }
+    if (!indexes.empty()) rids.push_back(rid);
+    rows++;
+    return true;
+}
+
+bool BulkLoader::finish() {
+    releaseFillPage();
+    if (chunkPages > 0 && !flushChunk()) return false;
+    // ֱ׷ӵҳύǰ
+    if (extendLogged && !pool.flushFile(tablePath)) return false;
+
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        size_t col = indexes[i].column;
+        uint32_t width = layout.widths[col];
+        const char* base = keys[i].data();
+        std::vector<uint32_t> order(rids.size());
+        std::iota(order.begin(), order.end(), 0);
+        //  BTree::compareEntry ˳һ£ʹҶ˳ƽ
+        if (layout.types[col] == ColumnType::INT) {
+            std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+                int32_t x, y;
+                std::memcpy(&x, base + static_cast<size_t>(a) * width, sizeof(x));
+                std::memcpy(&y, base + static_cast<size_t>(b) * width, sizeof(y));
+                return x < y;
+            });
+        } else {
+            std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+                return std::memcmp(base + static_cast<size_t>(a) * width,
+                                   base + static_cast<size_t>(b) * width, width) < 0;
+            });
+        }
+
+        // ԵϽ
+        BTree tree(pool, indexes[i].path);
+        if (!tree.isValid()) return false;
+        if (tree.empty()) {
+            std::vector<std::pair<const char*, RID>> sorted;
+            sorted.reserve(order.size());
+            for (uint32_t k : order) {
+                sorted.push_back({base + static_cast<size_t>(k) * width, rids[k]});
+            }
+            if (!tree.build(sorted)) return false;
+        } else {
+            for (uint32_t k : order) {
+                if (!tree.insert(base + static_cast<size_t>(k) * width, rids[k])) return false;
+            }
+        }
+        std::vector<char>().swap(keys[i]);
+    }
+    return true;
+}
+
+bool BulkLoader::flushChunk() {
+    if (!extendLogged) {
+        if (!wal.logExtend(statement, fileName, chunkFirstPage)) return false;
+        extendLogged = true;
+    }
+    uint32_t firstPage = 0;
+    if (!pool.appendPages(tablePath, chunk.data(), chunkPages, firstPage)) return false;
+    // ֻ׷ӵһҳû
+    uint32_t used = PageRef(&chunk[(chunkPages - 1) * PAGE_SIZE], layout).usedCount();
+    freeSpace.update(firstPage + chunkPages - 1, layout.slotsPerPage - used);
+    for (uint32_t p = 0; p < chunkPages; ++p) written.push_back(firstPage + p);
+    chunkPages = 0;
+    return firstPage == chunkFirstPage;
+}
+
+// ӿпռȡһҳм¼ҳûпλʱ˳
+void BulkLoader::takeFreePage() {
+    while (freeSpace.findPage(fillPageNo)) {
+        fillPage = pool.fetchPage(tablePath, fillPageNo);
+        if (!fillPage) break;
+        PageRef page(fillPage, layout);
+        if (page.isValid() && page.findFreeSlot() >= 0) {
+            written.push_back(fillPageNo);
+            return;
+        }
+        pool.unpinPage(tablePath, fillPageNo, false);
+        fillPage = nullptr;
+        freeSpace.update(fillPageNo, 0);
+    }
+    fillPage = nullptr;
+}
+
+void BulkLoader::releaseFillPage() {
+    if (!fillPage) return;
+    PageRef page(fillPage, layout);
+    freeSpace.update(fillPageNo, page.slotCount() - page.usedCount());
+    pool.unpinPage(tablePath, fillPageNo, true);
+    fillPage = nullptr;
+}
+
+// CSV ȡ
+CsvReader::CsvReader(const std::string& path) : buffer(1 << 20) {
+    file = std::fopen(path.c_str(), "rb");
+}
+
+CsvReader::~CsvReader() {
+    if (file) std::fclose(file);
+}
+
+// δƵͷݣһ¼ʱ󻺳
+bool CsvReader::refill() {
+    if (eof) return false;
+    std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+    end -= begin;
+    begin = 0;
+    if (end == buffer.size()) buffer.resize(buffer.size() * 2);
+    size_t n = std::fread(buffer.data() + end, 1, buffer.size() - end, file);
+    end += n;
+    if (n == 0) eof = true;
+    return n > 0;
+}
+
+bool CsvReader::next(std::vector<std::string>& fields) {
+    while (true) {
+        // ҵ¼βڵĻֶ
+        size_t i = begin;
+        size_t newlines = 0;
+        bool quoted = false;
+        while (true) {
+            for (; i < end; ++i) {
+                char c = buffer[i];
+                if (c == '"') quoted = !quoted;
+                else if (c == '\n') {
+                    if (!quoted) break;
+                    newlines++;
+                }
+            }
+            if (i < end || eof) break;
+            size_t scanned = i - begin;
+            refill();
+            i = begin + scanned;
+        }
+        if (begin == end) return false;
+
+        size_t recordEnd = i;
+        size_t lineEnd = recordEnd;
+        if (lineEnd > begin && buffer[lineEnd - 1] == '\r') lineEnd--;
+        recordLine = line + 1;
+        line += newlines + 1;
+        const char* p = buffer.data() + begin;
+        const char* stop = buffer.data() + lineEnd;
+        begin = (recordEnd < end) ? recordEnd + 1 : end;
+        if (p == stop) continue;  // 
+
+        // ֶ
+        size_t count = 0;
+        while (true) {
+            if (count == fields.size()) fields.emplace_back();
+            std::string& field = fields[count++];
+            field.clear();
+            if (p < stop && *p == '"') {
+                for (++p; p < stop; ++p) {
+                    if (*p == '"') {
+                        if (p + 1 < stop && p[1] == '"') {
+                            field += '"';
+                            ++p;
+                        } else {
+                            ++p;
+                            break;
+                        }
+                    } else {
+                        field += *p;
+                    }
+                }
+                while (p < stop && *p != ',') ++p;
+            } else {
+                const char* start = p;
+                while (p < stop && *p != ',') ++p;
+                const char* last = p;
+                while (start < last && (*start == ' ' || *start == '\t')) ++start;
+                while (last > start && (last[-1] == ' ' || last[-1] == '\t')) --last;
+                field.assign(start, last);
+            }
+            if (p == stop) break;
+            ++p;  // 
+        }
+        fields.resize(count);
+        return true;
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef BULK_LOADER_H
+#define BULK_LOADER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Storage.h"
+#include "BufferPool.h"
+#include "FreeSpaceMap.h"
+#include "ZoneMap.h"
+#include "WriteAheadLog.h"
+
+// дʱҪά
+struct BulkIndex {
+    std::string path;
+    size_t column;
+};
+
+// дѱĶУа汾ĿʼʱΪ stamp
+// ȰпռҳĿвλƴҳɿ׷ӵļĩβʱļֻһΣ
+// ÿдʱſڿĿͳƣ
+// Ŀռٲ
+class BulkLoader {
+public:
+    BulkLoader(BufferPool& pool, WriteAheadLog& wal, uint64_t statement,
+               const std::string& tablePath, const std::string& fileName,
+               const TableLayout& layout, FreeSpaceMap& freeSpace, ZoneMap& zones,
+               const std::vector<BulkIndex>& indexes, uint64_t stamp);
+    ~BulkLoader();
+
+    bool add(const char* row);
+    // дʣҳ̣Ȼά
+    bool finish();
+    size_t rowCount() const { return rows; }
+    // дҳҳ׷ӵҳ
+    const std::vector<uint32_t>& writtenPages() const { return written; }
+
+private:
+    // ÿ׷ӵļҳ
+    static const uint32_t CHUNK_PAGES = 256;
+
+    bool flushChunk();
+    void takeFreePage();
+    void releaseFillPage();
+
+    BufferPool& pool;
+    WriteAheadLog& wal;
+    uint64_t statement;
+    std::string tablePath;
+    std::string fileName;
+    const TableLayout& layout;
+    FreeSpaceMap& freeSpace;
+    ZoneMap& zones;
+    std::vector<BulkIndex> indexes;
+    uint64_t stamp;
+
+    // ҳǰ̶ֹ
+    char* fillPage = nullptr;
+    uint32_t fillPageNo = 0;
+
+    std::vector<char> chunk;      // ׷ӵҳ
+    uint32_t chunkPages = 0;      // chunk ʹõҳ(ҳ)
+    uint32_t chunkFirstPage = 0;  // chunk һҳļеҳ
+    bool extendLogged = false;
+
+    std::vector<std::vector<char>> keys;  // ÿļ rids һһӦ
+    std::vector<RID> rids;
+    std::vector<uint32_t> written;
+    size_t rows = 0;
+};
+
+// ȡ CSV ¼֧˫ŰΧֶκ "" ת
+class CsvReader {
+public:
+    explicit CsvReader(const std::string& path);
+    ~CsvReader();
+    CsvReader(const CsvReader&) = delete;
+    CsvReader& operator=(const CsvReader&) = delete;
+
+    bool isOpen() const { return file != nullptr; }
+    // ȡһǿռ¼ûи¼ʱ false
+    bool next(std::vector<std::string>& fields);
+    // һ¼ʼк
+    size_t lineNumber() const { return recordLine; }
+
+private:
+    bool refill();
+
+    FILE* file = nullptr;
+    std::vector<char> buffer;
+    size_t begin = 0;
+    size_t end = 0;
+    bool eof = false;
+    size_t line = 0;
+    size_t recordLine = 0;
+};
+
+#endif // BULK_LOADER_H
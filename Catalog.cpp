@@ -0,0 +1,288 @@
+#include "Catalog.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include "Hash.h"
+
+static const char CATALOG_MAGIC[4] = {'C', 'T', 'L', 'G'};
+static const char* CATALOG_FILE = "catalog.dat";
+
+// ֽд
+template <typename T>
+static void put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// ߽ζȡĿ¼ļ
+class CatalogReader {
+public:
+    CatalogReader(const std::string& data, size_t end) : data(data), end(end) {}
+
+    template <typename T>
+    bool get(T& value) {
+        if (end - pos < sizeof(T)) return false;
+        std::memcpy(&value, data.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
+    bool getString(std::string& value, uint32_t size) {
+        if (end - pos < size) return false;
+        value.assign(data.data() + pos, size);
+        pos += size;
+        return true;
+    }
+    bool atEnd() const { return pos == end; }
+
+private:
+    const std::string& data;
+    size_t end;
+    size_t pos = 0;
+};
+
+// ȡ
+bool Catalog::load(bool& migrated, std::string& error) {
+    migrated = false;
+    std::string path = dir + "/" + CATALOG_FILE;
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        migrated = true;
+        migrate();
+        return true;
+    }
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    error = "Catalog file '" + path + "' is corrupted";
+    uint64_t checksum;
+    if (data.size() < sizeof(checksum)) return false;
+    size_t end = data.size() - sizeof(checksum);
+    std::memcpy(&checksum, data.data() + end, sizeof(checksum));
+    if (checksum != hashBytes(data.data(), end)) return false;
+
+    CatalogReader reader(data, end);
+    char magic[4];
+    uint32_t format, stringCount, tableCount;
+    uint64_t version;
+    for (char& c : magic) {
+        if (!reader.get(c)) return false;
+    }
+    if (std::memcmp(magic, CATALOG_MAGIC, sizeof(magic)) != 0) return false;
+    if (!reader.get(format) || !reader.get(version)) return false;
+    if (format != FORMAT_VERSION && format != 1) {
+        error = "Unsupported catalog format version " + std::to_string(format);
+        return false;
+    }
+
+    // ַ
+    if (!reader.get(stringCount)) return false;
+    std::vector<std::string> strings(stringCount);
+    for (auto& s : strings) {
+        uint32_t size;
+        if (!reader.get(size) || !reader.getString(s, size)) return false;
+    }
+    auto name = [&strings](uint32_t id, std::string& out) {
+        if (id >= strings.size()) return false;
+        out = strings[id];
+        return true;
+    };
+
+    std::vector<Table> tables;
+    if (!reader.get(tableCount)) return false;
+    for (uint32_t t = 0; t < tableCount; ++t) {
+        Table table;
+        uint32_t id, columnCount, indexCount;
+        if (!reader.get(id) || !name(id, table.name) || !reader.get(columnCount)) return false;
+        for (uint32_t c = 0; c < columnCount; ++c) {
+            Column column;
+            uint8_t type;
+            int32_t size;
+            if (!reader.get(id) || !name(id, column.name) || !reader.get(type) || !reader.get(size)) return false;
+            if (type != static_cast<uint8_t>(ColumnType::INT) && type != static_cast<uint8_t>(ColumnType::CHAR)) {
+                return false;
+            }
+            column.type = static_cast<ColumnType>(type);
+            column.size = size;
+            table.columns.push_back(column);
+        }
+        if (!reader.get(indexCount)) return false;
+        for (uint32_t i = 0; i < indexCount; ++i) {
+            IndexInfo index;
+            if (!reader.get(id) || !name(id, index.name) || !reader.get(id) || !name(id, index.column)) return false;
+            table.indexes.push_back(index);
+        }
+        tables.push_back(std::move(table));
+    }
+    if (!reader.atEnd()) return false;
+
+    for (const auto& table : tables) addTable(table);
+    catalogVersion = version;
+    loaded = true;
+    migrated = (format != FORMAT_VERSION);
+    error.clear();
+    return true;
+}
+
+// ɰÿűһıʽ .table.info ļĿ¼ɾ
+void Catalog::migrate() {
+    std::vector<std::string> tableNames;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        std::string path = entry.path().string();
+        if (path.length() >= 6 && path.substr(path.length() - 6) == ".table") {
+            tableNames.push_back(entry.path().stem().string());
+        }
+    }
+    std::sort(tableNames.begin(), tableNames.end());
+
+    for (const auto& tableName : tableNames) {
+        Table table;
+        table.name = tableName;
+        std::string infoPath = dir + "/" + tableName + ".table.info";
+        std::ifstream infoFile(infoPath);
+        std::string line;
+        while (std::getline(infoFile, line)) {
+            std::istringstream iss(line);
+            if (line.compare(0, 6, "INDEX ") == 0) {
+                IndexInfo index;
+                std::string keyword;
+                iss >> keyword >> index.name >> index.column;
+                table.indexes.push_back(index);
+                continue;
+            }
+            Column col;
+            std::string typeStr;
+            iss >> col.name >> typeStr >> col.size;
+            col.type = (typeStr == "INT" ? ColumnType::INT : ColumnType::CHAR);
+            table.columns.push_back(col);
+        }
+        if (infoFile.is_open()) legacyFiles.push_back(infoPath);
+        addTable(table);
+    }
+    loaded = true;
+}
+
+// 
+bool Catalog::save() {
+    // ַֻһ
+    std::vector<const std::string*> strings;
+    std::unordered_map<std::string_view, uint32_t> ids;
+    auto intern = [&](const std::string& s) {
+        auto it = ids.find(s);
+        if (it != ids.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(strings.size());
+        strings.push_back(&s);
+        ids.emplace(s, id);
+        return id;
+    };
+
+    std::string body;
+    put<uint32_t>(body, static_cast<uint32_t>(names.size()));
+    for (const auto& tableName : names) {
+        const Table& table = entries.at(tableName).table;
+        put<uint32_t>(body, intern(table.name));
+        put<uint32_t>(body, static_cast<uint32_t>(table.columns.size()));
+        for (const auto& column : table.columns) {
+            put<uint32_t>(body, intern(column.name));
+            put<uint8_t>(body, static_cast<uint8_t>(column.type));
+            put<int32_t>(body, column.size);
+        }
+        put<uint32_t>(body, static_cast<uint32_t>(table.indexes.size()));
+        for (const auto& index : table.indexes) {
+            put<uint32_t>(body, intern(index.name));
+            put<uint32_t>(body, intern(index.column));
+        }
+    }
+
+    std::string data(CATALOG_MAGIC, sizeof(CATALOG_MAGIC));
+    put<uint32_t>(data, FORMAT_VERSION);
+    put<uint64_t>(data, catalogVersion + 1);
+    put<uint32_t>(data, static_cast<uint32_t>(strings.size()));
+    for (const auto* s : strings) {
+        put<uint32_t>(data, static_cast<uint32_t>(s->size()));
+        data += *s;
+    }
+    data += body;
+    put<uint64_t>(data, hashBytes(data.data(), data.size()));
+
+    std::string path = dir + "/" + CATALOG_FILE;
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.write(data.data(), data.size()) || !file.flush()) return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) return false;
+    catalogVersion++;
+    for (const auto& legacyPath : legacyFiles) std::filesystem::remove(legacyPath, ec);
+    legacyFiles.clear();
+    return true;
+}
+
+// 
+const Table* Catalog::find(const std::string& name) const {
+    auto it = entries.find(name);
+    return it == entries.end() ? nullptr : &it->second.table;
+}
+
+Table* Catalog::find(const std::string& name) {
+    auto it = entries.find(name);
+    return it == entries.end() ? nullptr : &it->second.table;
+}
+
+bool Catalog::columnIndex(const std::string& table, const std::string& column, size_t& index) const {
+    auto entry = entries.find(table);
+    if (entry == entries.end()) return false;
+    auto it = entry->second.columns.find(column);
+    if (it == entry->second.columns.end()) return false;
+    index = it->second;
+    return true;
+}
+
+const std::string* Catalog::indexOwner(const std::string& indexName) const {
+    auto it = indexOwners.find(indexName);
+    return it == indexOwners.end() ? nullptr : &it->second;
+}
+
+// ޸
+Catalog::Entry& Catalog::insert(const Table& table) {
+    // ȷϣٽ string_view ָյλ
+    Entry& entry = entries[table.name];
+    entry.table = table;
+    entry.columns.clear();
+    for (size_t i = 0; i < entry.table.columns.size(); ++i) {
+        entry.columns.emplace(entry.table.columns[i].name, i);
+    }
+    return entry;
+}
+
+void Catalog::addTable(const Table& table) {
+    if (entries.find(table.name) == entries.end()) names.push_back(table.name);
+    Entry& entry = insert(table);
+    for (const auto& index : entry.table.indexes) indexOwners[index.name] = table.name;
+}
+
+void Catalog::removeTable(const std::string& name) {
+    auto it = entries.find(name);
+    if (it == entries.end()) return;
+    for (const auto& index : it->second.table.indexes) indexOwners.erase(index.name);
+    entries.erase(it);
+    names.erase(std::remove(names.begin(), names.end(), name), names.end());
+}
+
+void Catalog::addIndex(const std::string& table, const IndexInfo& index) {
+    auto it = entries.find(table);
+    if (it == entries.end()) return;
+    it->second.table.indexes.push_back(index);
+    indexOwners[index.name] = table;
+}
+
+void Catalog::removeIndex(const std::string& table, const std::string& indexName) {
+    auto it = entries.find(table);
+    if (it == entries.end()) return;
+    auto& indexes = it->second.table.indexes;
+    indexes.erase(std::remove_if(indexes.begin(), indexes.end(),
+                                 [&indexName](const IndexInfo& index) { return index.name == indexName; }),
+                  indexes.end());
+    indexOwners.erase(indexName);
+}
@@ -0,0 +1,61 @@
+#ifndef CATALOG_H
+#define CATALOG_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Schema.h"
+
+// һݿıṹĿ¼ݿĿ¼µ catalog.dat У״ʹݿʱ
+// ļʽļͷ(ħʽ汾Ŀ¼汾) + ַ + к(ַ±ʾ) + У
+// ÿαĿ¼汾һдʱļٸдһĿ¼
+// ʽ汾 2 ļед汾Ϣ汾 1 Ŀ¼Ӧɰҳʽıļ
+class Catalog {
+public:
+    static const uint32_t FORMAT_VERSION = 2;
+
+    explicit Catalog(const std::string& dir) : dir(dir) {}
+
+    bool isLoaded() const { return loaded; }
+    // Ŀ¼ļûĿ¼ļʱӾɰ .table.info ļǨ
+    // migrated Ϊ true ʾļܻǾɸʽ÷תļ save
+    bool load(bool& migrated, std::string& error);
+    bool save();
+    uint64_t version() const { return catalogVersion; }
+
+    const Table* find(const std::string& name) const;
+    Table* find(const std::string& name);
+    // ˳еı
+    const std::vector<std::string>& tableNames() const { return names; }
+    //  -> кţʱ
+    bool columnIndex(const std::string& table, const std::string& column, size_t& index) const;
+    // ڵıʱ nullptr
+    const std::string* indexOwner(const std::string& indexName) const;
+
+    void addTable(const Table& table);
+    void removeTable(const std::string& name);
+    void addIndex(const std::string& table, const IndexInfo& index);
+    void removeIndex(const std::string& table, const std::string& indexName);
+
+private:
+    struct Entry {
+        Table table;
+        // ָ table еṹвٱ仯
+        std::unordered_map<std::string_view, size_t> columns;
+    };
+
+    Entry& insert(const Table& table);
+    void migrate();
+
+    std::string dir;
+    std::unordered_map<std::string, Entry> entries;
+    std::vector<std::string> names;
+    std::unordered_map<std::string, std::string> indexOwners;  //  -> 
+    std::vector<std::string> legacyFiles;  // Ǩƺ󱣴ɹʱɾ .table.info ļ
+    uint64_t catalogVersion = 0;
+    bool loaded = false;
+};
+
+#endif // CATALOG_H
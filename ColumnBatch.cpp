@@ -0,0 +1,74 @@
+#include "ColumnBatch.h"
+#include <cstring>
+
+void ColumnBatch::init(const TableLayout& layout, const std::vector<bool>& needed) {
+    this->layout = &layout;
+    this->needed = needed;
+    columns.assign(layout.types.size(), ColumnVector());
+    for (size_t col = 0; col < columns.size(); ++col) {
+        if (!needed[col]) continue;
+        if (layout.types[col] == ColumnType::INT) {
+            columns[col].ints.resize(BATCH_SIZE);
+        } else {
+            columns[col].offsets.resize(BATCH_SIZE + 1);
+            columns[col].blob.resize(static_cast<size_t>(BATCH_SIZE) * layout.widths[col]);
+        }
+    }
+    rids.resize(BATCH_SIZE);
+    slots.resize(BATCH_SIZE);
+    count = 0;
+}
+
+void ColumnBatch::clear() {
+    count = 0;
+}
+
+uint32_t ColumnBatch::appendPage(const PageRef& page, uint32_t startSlot, uint32_t pageNo,
+                                 const Snapshot& snapshot) {
+    // ռɵĿɼ
+    uint32_t n = 0;
+    uint32_t slot = startSlot;
+    uint32_t slotCount = page.slotCount();
+    for (; slot < slotCount && count + n < BATCH_SIZE; ++slot) {
+        slots[n] = slot;
+        n += (page.isUsed(slot) && snapshot.visible(page.version(slot))) ? 1 : 0;
+    }
+    decode(page, n, pageNo);
+    return slot;
+}
+
+void ColumnBatch::appendSlot(const PageRef& page, uint32_t slot, uint32_t pageNo) {
+    slots[0] = slot;
+    decode(page, 1, pageNo);
+}
+
+void ColumnBatch::decode(const PageRef& page, uint32_t n, uint32_t pageNo) {
+    // н룬ÿеڲѭֻ
+    for (size_t col = 0; col < columns.size(); ++col) {
+        if (!needed[col]) continue;
+        uint32_t offset = layout->offsets[col];
+        ColumnVector& vec = columns[col];
+        if (layout->types[col] == ColumnType::INT) {
+            int32_t* dst = vec.ints.data() + count;
+            for (uint32_t i = 0; i < n; ++i) {
+                std::memcpy(dst + i, page.slotData(slots[i]) + offset, sizeof(int32_t));
+            }
+        } else {
+            uint32_t width = layout->widths[col];
+            uint32_t end = vec.offsets[count];
+            for (uint32_t i = 0; i < n; ++i) {
+                const char* src = page.slotData(slots[i]) + offset;
+                uint32_t len = 0;
+                while (len < width && src[len] != '\0') ++len;
+                std::memcpy(vec.blob.data() + end, src, len);
+                end += len;
+                vec.offsets[count + i + 1] = end;
+            }
+        }
+    }
+    for (uint32_t i = 0; i < n; ++i) {
+        rids[count + i].page = pageNo;
+        rids[count + i].slot = static_cast<uint16_t>(slots[i]);
+    }
+    count += n;
+}
\ No newline at end of file
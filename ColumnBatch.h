@@ -0,0 +1,50 @@
+#ifndef COLUMN_BATCH_H
+#define COLUMN_BATCH_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "Storage.h"
+
+// ÿ
+const uint32_t BATCH_SIZE = 1024;
+
+// е
+struct ColumnVector {
+    std::vector<int32_t> ints;      // INT У
+    std::vector<uint32_t> offsets;  // CHAR У i ֵΪ blob[offsets[i], offsets[i + 1])
+    std::vector<char> blob;
+
+    std::string_view getChar(uint32_t i) const {
+        return std::string_view(blob.data() + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+};
+
+// дŵһУֻҪ
+class ColumnBatch {
+public:
+    void init(const TableLayout& layout, const std::vector<bool>& needed);
+    void clear();
+
+    // ҳн startSlot ԿտɼУֱװһĲλ
+    uint32_t appendPage(const PageRef& page, uint32_t startSlot, uint32_t pageNo, const Snapshot& snapshot);
+    // ׷ӵλ( RID ʱʹ)
+    void appendSlot(const PageRef& page, uint32_t slot, uint32_t pageNo);
+
+    uint32_t size() const { return count; }
+    bool full() const { return count == BATCH_SIZE; }
+    const ColumnVector& column(size_t col) const { return columns[col]; }
+    RID rid(uint32_t i) const { return rids[i]; }
+
+private:
+    void decode(const PageRef& page, uint32_t n, uint32_t pageNo);
+
+    const TableLayout* layout = nullptr;
+    std::vector<bool> needed;
+    std::vector<ColumnVector> columns;
+    std::vector<RID> rids;
+    std::vector<uint32_t> slots;  // ʱʱλб
+    uint32_t count = 0;
+};
+
+#endif // COLUMN_BATCH_H
\ No newline at end of file
@@ -0,0 +1,446 @@
+#include "Compression.h"
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// ֽѹ
+static const size_t MIN_MATCH = 4;
+static const size_t MAX_DISTANCE = 65535;
+static const int HASH_BITS = 12;
+// бĳޣʱҳѹ
+static const size_t MAX_COLUMNS_SIZE = 4 * PAGE_SIZE;
+
+static uint32_t read32(const char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static void putLength(std::string& out, size_t length) {
+    while (length >= 255) {
+        out += static_cast<char>(255);
+        length -= 255;
+    }
+    out += static_cast<char>(length);
+}
+
+static bool getLength(const char*& p, const char* end, size_t& length) {
+    uint8_t byte;
+    do {
+        if (p == end) return false;
+        byte = static_cast<uint8_t>(*p++);
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+// һУ [literal, literal + literals)֮Ϊƥ(matchLength Ϊ 0 ʾһ)
+static void putSequence(std::string& out, const char* literal, size_t literals, size_t distance, size_t matchLength) {
+    size_t extra = matchLength > 0 ? matchLength - MIN_MATCH : 0;
+    out += static_cast<char>((std::min<size_t>(literals, 15) << 4) | std::min<size_t>(extra, 15));
+    if (literals >= 15) putLength(out, literals - 15);
+    out.append(literal, literals);
+    if (matchLength == 0) return;
+    out += static_cast<char>(distance & 0xFF);
+    out += static_cast<char>(distance >> 8);
+    if (extra >= 15) putLength(out, extra - 15);
+}
+
+void lzCompress(const char* src, size_t size, std::string& out) {
+    // ϣ¼ÿ 4 ֽڴֵλ
+    int32_t table[1 << HASH_BITS];
+    std::fill(table, table + (1 << HASH_BITS), -1);
+    size_t anchor = 0;
+    size_t pos = 0;
+    while (pos + MIN_MATCH <= size) {
+        uint32_t value = read32(src + pos);
+        uint32_t hash = (value * 2654435761u) >> (32 - HASH_BITS);
+        int32_t candidate = table[hash];
+        table[hash] = static_cast<int32_t>(pos);
+        if (candidate < 0 || pos - candidate > MAX_DISTANCE || read32(src + candidate) != value) {
+            pos++;
+            continue;
+        }
+        size_t length = MIN_MATCH;
+        while (pos + length < size && src[candidate + length] == src[pos + length]) length++;
+        putSequence(out, src + anchor, pos - anchor, pos - candidate, length);
+        pos += length;
+        anchor = pos;
+    }
+    putSequence(out, src + anchor, size - anchor, 0, 0);
+}
+
+bool lzDecompress(const char* src, size_t srcSize, char* dst, size_t size) {
+    const char* p = src;
+    const char* end = src + srcSize;
+    size_t out = 0;
+    while (p < end) {
+        uint8_t token = static_cast<uint8_t>(*p++);
+        size_t literals = token >> 4;
+        if (literals == 15 && !getLength(p, end, literals)) return false;
+        if (static_cast<size_t>(end - p) < literals || size - out < literals) return false;
+        std::memcpy(dst + out, p, literals);
+        p += literals;
+        out += literals;
+        if (p == end) break;  // һûƥ
+
+        if (end - p < 2) return false;
+        size_t distance = static_cast<uint8_t>(p[0]) | (static_cast<size_t>(static_cast<uint8_t>(p[1])) << 8);
+        p += 2;
+        size_t length = token & 15;
+        if (length == 15 && !getLength(p, end, length)) return false;
+        length += MIN_MATCH;
+        if (distance == 0 || distance > out || size - out < length) return false;
+        // ƥصֽڸ
+        for (size_t i = 0; i < length; ++i, ++out) dst[out] = dst[out - distance];
+    }
+    return out == size;
+}
+
+// б
+enum PageEncoding : uint8_t { RAW_PAGE = 0, COLUMNS = 1, COLUMNS_LZ = 2, PAGE_LZ = 3 };
+enum IntegerEncoding : uint8_t { RUNS = 0, DELTA_RUNS = 1, PACKED = 2 };
+enum StringEncoding : uint8_t { PLAIN = 0, DICTIONARY = 1 };
+
+static void putVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+static bool getVarint(const char*& p, const char* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (p == end) return false;
+        uint8_t byte = static_cast<uint8_t>(*p++);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+static uint64_t zigzag(uint64_t value) {
+    return (value << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(value) >> 63);
+}
+
+static uint64_t unzigzag(uint64_t value) {
+    return (value >> 1) ^ (~(value & 1) + 1);
+}
+
+// γ̣ÿΪȺһֵĲ
+static void encodeRuns(const uint64_t* values, size_t n, std::string& out) {
+    uint64_t previous = 0;
+    for (size_t i = 0; i < n;) {
+        size_t j = i;
+        while (j < n && values[j] == values[i]) j++;
+        putVarint(out, j - i);
+        putVarint(out, zigzag(values[i] - previous));
+        previous = values[i];
+        i = j;
+    }
+}
+
+static bool decodeRuns(const char*& p, const char* end, size_t n, uint64_t* values) {
+    uint64_t previous = 0;
+    for (size_t i = 0; i < n;) {
+        uint64_t length, delta;
+        if (!getVarint(p, end, length) || !getVarint(p, end, delta) || length == 0 || length > n - i) return false;
+        previous += unzigzag(delta);
+        std::fill(values + i, values + i + length, previous);
+        i += length;
+    }
+    return true;
+}
+
+// οֵλѹȥСֵÿֵռ bits λ
+static void encodePacked(const uint64_t* values, size_t n, std::string& out) {
+    uint64_t minimum = values[0];
+    for (size_t i = 1; i < n; ++i) {
+        if (static_cast<int64_t>(values[i]) < static_cast<int64_t>(minimum)) minimum = values[i];
+    }
+    uint64_t range = 0;
+    for (size_t i = 0; i < n; ++i) range = std::max(range, values[i] - minimum);
+    int bits = 0;
+    while (bits < 64 && (range >> bits) != 0) bits++;
+    out.append(reinterpret_cast<const char*>(&minimum), sizeof(minimum));
+    out += static_cast<char>(bits);
+
+    size_t start = out.size();
+    out.resize(start + (n * bits + 7) / 8, 0);
+    size_t bit = 0;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t value = values[i] - minimum;
+        for (int done = 0; done < bits;) {
+            int shift = static_cast<int>(bit % 8);
+            int take = std::min(bits - done, 8 - shift);
+            out[start + bit / 8] = static_cast<char>(out[start + bit / 8] |
+                                                     (((value >> done) & ((1u << take) - 1)) << shift));
+            done += take;
+            bit += take;
+        }
+    }
+}
+
+static bool decodePacked(const char*& p, const char* end, size_t n, uint64_t* values) {
+    uint64_t minimum;
+    if (end - p < static_cast<ptrdiff_t>(sizeof(minimum) + 1)) return false;
+    std::memcpy(&minimum, p, sizeof(minimum));
+    int bits = static_cast<uint8_t>(p[sizeof(minimum)]);
+    p += sizeof(minimum) + 1;
+    size_t bytes = (n * bits + 7) / 8;
+    if (bits > 64 || static_cast<size_t>(end - p) < bytes) return false;
+    size_t bit = 0;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t value = 0;
+        for (int done = 0; done < bits;) {
+            int shift = static_cast<int>(bit % 8);
+            int take = std::min(bits - done, 8 - shift);
+            uint64_t part = (static_cast<uint8_t>(p[bit / 8]) >> shift) & ((1u << take) - 1);
+            value |= part << done;
+            done += take;
+            bit += take;
+        }
+        values[i] = value + minimum;
+    }
+    p += bytes;
+    return true;
+}
+
+// ȡ̵ֱһ
+static void encodeIntegers(const std::vector<uint64_t>& values, std::string& out) {
+    size_t n = values.size();
+    std::string runs, deltaRuns, packed;
+    encodeRuns(values.data(), n, runs);
+    std::vector<uint64_t> deltas(n);
+    deltas[0] = values[0];
+    for (size_t i = 1; i < n; ++i) deltas[i] = values[i] - values[i - 1];
+    putVarint(deltaRuns, zigzag(deltas[0]));
+    encodeRuns(deltas.data() + 1, n - 1, deltaRuns);
+    encodePacked(values.data(), n, packed);
+
+    if (runs.size() <= deltaRuns.size() && runs.size() <= packed.size()) {
+        out += static_cast<char>(RUNS);
+        out += runs;
+    } else if (deltaRuns.size() <= packed.size()) {
+        out += static_cast<char>(DELTA_RUNS);
+        out += deltaRuns;
+    } else {
+        out += static_cast<char>(PACKED);
+        out += packed;
+    }
+}
+
+static bool decodeIntegers(const char*& p, const char* end, std::vector<uint64_t>& values) {
+    size_t n = values.size();
+    if (p == end) return false;
+    uint8_t encoding = static_cast<uint8_t>(*p++);
+    if (encoding == RUNS) return decodeRuns(p, end, n, values.data());
+    if (encoding == PACKED) return decodePacked(p, end, n, values.data());
+    if (encoding != DELTA_RUNS) return false;
+    uint64_t first;
+    if (!getVarint(p, end, first) || !decodeRuns(p, end, n - 1, values.data() + 1)) return false;
+    values[0] = unzigzag(first);
+    for (size_t i = 1; i < n; ++i) values[i] += values[i - 1];
+    return true;
+}
+
+// ַУȥĩβ 0 ԭĻҳֵţֵȡн϶̵һ
+static void encodeStrings(const char* data, uint32_t width, uint32_t stride, size_t n, std::string& out) {
+    std::vector<std::string_view> values(n);
+    for (size_t i = 0; i < n; ++i) {
+        const char* value = data + i * stride;
+        size_t length = width;
+        while (length > 0 && value[length - 1] == '\0') length--;
+        values[i] = std::string_view(value, length);
+    }
+
+    std::string plain;
+    for (const auto& value : values) {
+        putVarint(plain, value.size());
+        plain.append(value.data(), value.size());
+    }
+    std::unordered_map<std::string_view, uint64_t> codes;
+    std::string dictionary;
+    std::vector<uint64_t> indexes(n);
+    for (size_t i = 0; i < n; ++i) {
+        auto inserted = codes.emplace(values[i], codes.size());
+        if (inserted.second) {
+            putVarint(dictionary, values[i].size());
+            dictionary.append(values[i].data(), values[i].size());
+        }
+        indexes[i] = inserted.first->second;
+    }
+    std::string encoded;
+    putVarint(encoded, codes.size());
+    encoded += dictionary;
+    encodeIntegers(indexes, encoded);
+
+    if (encoded.size() < plain.size()) {
+        out += static_cast<char>(DICTIONARY);
+        out += encoded;
+    } else {
+        out += static_cast<char>(PLAIN);
+        out += plain;
+    }
+}
+
+static bool decodeStrings(const char*& p, const char* end, char* data, uint32_t width, uint32_t stride, size_t n) {
+    if (p == end) return false;
+    uint8_t encoding = static_cast<uint8_t>(*p++);
+    std::vector<std::string_view> entries;
+    std::vector<uint64_t> indexes(n);
+    size_t count = n;
+    if (encoding == DICTIONARY) {
+        uint64_t size;
+        if (!getVarint(p, end, size) || size > n) return false;
+        count = static_cast<size_t>(size);
+    } else if (encoding != PLAIN) {
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t length;
+        if (!getVarint(p, end, length) || length > width || static_cast<uint64_t>(end - p) < length) return false;
+        entries.emplace_back(p, static_cast<size_t>(length));
+        p += length;
+    }
+    if (encoding == DICTIONARY && !decodeIntegers(p, end, indexes)) return false;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t index = encoding == DICTIONARY ? indexes[i] : i;
+        if (index >= entries.size()) return false;
+        std::memcpy(data + i * stride, entries[index].data(), entries[index].size());
+    }
+    return true;
+}
+
+static bool allZero(const char* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        if (data[i] != '\0') return false;
+    }
+    return true;
+}
+
+// ҳͷλͼԭţ֮Ϊʼʱʱ͸
+static bool encodeColumns(const TableLayout& layout, const char* page, std::string& out) {
+    size_t n = layout.slotsPerPage;
+    if (n == 0) return false;
+    PageHeader header;
+    std::memcpy(&header, page, sizeof(header));
+    if (header.magic != PAGE_MAGIC || header.slotCount != n) return false;
+    // ֮Ͳλ֮ĿȫΪ 0ܰлԭ
+    size_t bitmapEnd = layout.bitmapOffset + (n + 7) / 8;
+    size_t slotsEnd = layout.slotsOffset + n * layout.rowSize;
+    if (!allZero(page + bitmapEnd, layout.versionsOffset - bitmapEnd) ||
+        !allZero(page + slotsEnd, PAGE_SIZE - slotsEnd)) {
+        return false;
+    }
+
+    out.append(page, bitmapEnd);
+    std::vector<uint64_t> values(n);
+    RowVersion version;
+    for (int field = 0; field < 2; ++field) {
+        for (size_t i = 0; i < n; ++i) {
+            std::memcpy(&version, page + layout.versionsOffset + i * sizeof(RowVersion), sizeof(version));
+            values[i] = field == 0 ? version.begin : version.end;
+        }
+        encodeIntegers(values, out);
+    }
+    const char* slots = page + layout.slotsOffset;
+    for (size_t col = 0; col < layout.types.size(); ++col) {
+        if (layout.types[col] == ColumnType::INT) {
+            int32_t value;
+            for (size_t i = 0; i < n; ++i) {
+                std::memcpy(&value, slots + i * layout.rowSize + layout.offsets[col], sizeof(value));
+                values[i] = static_cast<uint64_t>(static_cast<int64_t>(value));
+            }
+            encodeIntegers(values, out);
+        } else {
+            encodeStrings(slots + layout.offsets[col], layout.widths[col], layout.rowSize, n, out);
+        }
+    }
+    return true;
+}
+
+static bool decodeColumns(const TableLayout& layout, const char* p, const char* end, char* page) {
+    size_t n = layout.slotsPerPage;
+    size_t bitmapEnd = layout.bitmapOffset + (n + 7) / 8;
+    if (n == 0 || static_cast<size_t>(end - p) < bitmapEnd) return false;
+    std::memset(page, 0, PAGE_SIZE);
+    std::memcpy(page, p, bitmapEnd);
+    p += bitmapEnd;
+
+    std::vector<uint64_t> values(n);
+    for (int field = 0; field < 2; ++field) {
+        if (!decodeIntegers(p, end, values)) return false;
+        for (size_t i = 0; i < n; ++i) {
+            char* version = page + layout.versionsOffset + i * sizeof(RowVersion);
+            std::memcpy(version + (field == 0 ? offsetof(RowVersion, begin) : offsetof(RowVersion, end)),
+                        &values[i], sizeof(uint64_t));
+        }
+    }
+    char* slots = page + layout.slotsOffset;
+    for (size_t col = 0; col < layout.types.size(); ++col) {
+        if (layout.types[col] == ColumnType::INT) {
+            if (!decodeIntegers(p, end, values)) return false;
+            for (size_t i = 0; i < n; ++i) {
+                int32_t value = static_cast<int32_t>(values[i]);
+                std::memcpy(slots + i * layout.rowSize + layout.offsets[col], &value, sizeof(value));
+            }
+        } else if (!decodeStrings(p, end, slots + layout.offsets[col], layout.widths[col], layout.rowSize, n)) {
+            return false;
+        }
+    }
+    return p == end;
+}
+
+void compressPage(const TableLayout& layout, const char* page, std::string& out) {
+    out.clear();
+    std::string columns;
+    std::string packed;
+    if (encodeColumns(layout, page, columns) && columns.size() <= MAX_COLUMNS_SIZE) {
+        lzCompress(columns.data(), columns.size(), packed);
+        if (packed.size() < columns.size()) {
+            out += static_cast<char>(COLUMNS_LZ);
+            putVarint(out, columns.size());
+            out += packed;
+        } else {
+            out += static_cast<char>(COLUMNS);
+            out += columns;
+        }
+    } else {
+        lzCompress(page, PAGE_SIZE, packed);
+        out += static_cast<char>(PAGE_LZ);
+        out += packed;
+    }
+    if (out.size() > PAGE_SIZE) {
+        out.assign(1, static_cast<char>(RAW_PAGE));
+        out.append(page, PAGE_SIZE);
+    }
+}
+
+bool decompressPage(const TableLayout& layout, const char* data, size_t size, char* page) {
+    if (size == 0) return false;
+    const char* p = data + 1;
+    const char* end = data + size;
+    switch (static_cast<uint8_t>(data[0])) {
+    case RAW_PAGE:
+        if (size != PAGE_SIZE + 1) return false;
+        std::memcpy(page, p, PAGE_SIZE);
+        return true;
+    case PAGE_LZ:
+        return lzDecompress(p, end - p, page, PAGE_SIZE);
+    case COLUMNS:
+        return decodeColumns(layout, p, end, page);
+    case COLUMNS_LZ: {
+        uint64_t length;
+        if (!getVarint(p, end, length) || length > MAX_COLUMNS_SIZE) return false;
+        std::string columns(static_cast<size_t>(length), '\0');
+        return lzDecompress(p, end - p, &columns[0], columns.size()) &&
+               decodeColumns(layout, columns.data(), columns.data() + columns.size(), page);
+    }
+    default:
+        return false;
+    }
+}
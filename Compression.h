@@ -0,0 +1,21 @@
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include <cstddef>
+#include <string>
+#include "Storage.h"
+
+// LZ4 ֽѹɱֽ( 4 λΪȣ 4 λΪƥ䳤ȼ 4)
+//  2 ֽڵĻؿɣȲС 15 ʱչֽ
+// ѹ׷ӵ out
+void lzCompress(const char* src, size_t size, std::string& out);
+// ѹĳȱǡΪ sizeʱ false
+bool lzDecompress(const char* src, size_t srcSize, char* dst, size_t size);
+
+// ѹһҳ汾ʱ INT аγֵ̡γ̻οֵλѹн϶̵һֱ룬
+// CHAR аҳֵ룬ֽѹǵǰʽҳҳֽѹ
+// ѹԭҳֽͬ
+void compressPage(const TableLayout& layout, const char* page, std::string& out);
+bool decompressPage(const TableLayout& layout, const char* data, size_t size, char* page);
+
+#endif // COMPRESSION_H
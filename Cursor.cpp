@@ -0,0 +1,253 @@
+#include "Cursor.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+Cursor::Cursor(BufferPool& pool, std::vector<std::shared_lock<std::shared_mutex>> tableLocks, const ReadView& view,
+               const std::string& tablePath, const Table& table, const Predicate& predicate,
+               const std::vector<size_t>& projection, bool indexed, std::vector<RID> rids)
+    : pool(pool), tableLocks(std::move(tableLocks)), view(view), snapshot(*view.snapshot),
+      tablePath(tablePath), table(table), layout(table),
+      predicate(predicate), projection(projection), indexed(indexed), rids(std::move(rids)) {
+    // ֻͶӰνõ
+    std::vector<bool> needed(table.columns.size(), false);
+    for (size_t col : projection) needed[col] = true;
+    predicate.referencedColumns(needed);
+    batch.init(layout, needed);
+
+    all.resize(BATCH_SIZE);
+    selected.resize(BATCH_SIZE);
+    for (uint32_t i = 0; i < BATCH_SIZE; ++i) all[i] = i;
+
+    if (indexed) {
+        std::sort(this->rids.begin(), this->rids.end(), [](const RID& a, const RID& b) {
+            return a.page != b.page ? a.page < b.page : a.slot < b.slot;
+        });
+        estimated = this->rids.size();
+    } else {
+        pageCount = pool.pageCount(tablePath);
+        estimated = static_cast<uint64_t>(pageCount) * layout.slotsPerPage;
+    }
+}
+
+Cursor::Cursor(BufferPool& pool, std::vector<std::shared_lock<std::shared_mutex>> tableLocks,
+               std::unique_ptr<Operator> root, const std::vector<size_t>& projection)
+    : pool(pool), tableLocks(std::move(tableLocks)), root(std::move(root)),
+      table(this->root->schema()), layout(this->root->layout()), projection(projection), indexed(false) {
+}
+
+//  OFFSET Уȡ LIMIT кرգٶȡʣ
+bool Cursor::next(ResultRow& row) {
+    if (remaining == 0) {
+        close();
+        return false;
+    }
+    for (; skip > 0; --skip) {
+        if (!fetch(row)) return false;
+    }
+    if (!fetch(row)) return false;
+    remaining--;
+    returned++;
+    return true;
+}
+
+void Cursor::setLimit(uint64_t limit, uint64_t offset) {
+    remaining = limitCount = limit;
+    skip = offsetCount = offset;
+}
+
+bool Cursor::fetch(ResultRow& row) {
+    if (closed) return false;
+    if (root) {
+        const char* data = root->next();
+        if (!data) {
+            errorMessage = root->error();
+            close();
+            return false;
+        }
+        row.batch = nullptr;
+        row.view = RowView(data, layout);
+        row.projection = &projection;
+        return true;
+    }
+    if (position == selectedCount) {
+        auto start = std::chrono::steady_clock::now();
+        bool more = fill();
+        if (timed) {
+            stats.nanos += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        }
+        if (!more) {
+            close();
+            return false;
+        }
+    }
+    stats.rowsOut++;
+    row.batch = &batch;
+    row.projection = &projection;
+    row.index = selected[position++];
+    return true;
+}
+
+void Cursor::close() {
+    if (closed) return;
+    closed = true;
+    rids.clear();
+    rids.shrink_to_fit();
+    if (timed) collectPlan(profile);
+    if (tableStats && started && !root) tableStats->addScan(indexed, stats);
+    // ӿܻʹûеҳڱͷ
+    root.reset();
+    view.snapshot.reset();
+    for (auto& lock : tableLocks) {
+        if (lock.owns_lock()) lock.unlock();
+    }
+}
+
+// ȡһٺһнݣûиʱ false
+bool Cursor::fill() {
+    started = true;
+    position = 0;
+    selectedCount = 0;
+    while (selectedCount == 0) {
+        batch.clear();
+        if (indexed) {
+            fillFromRids();
+            //  RID ȡʱֵ
+            for (uint32_t i = 0; i < batch.size(); ++i) selected[i] = i;
+            selectedCount = batch.size();
+        } else {
+            fillFromScan();
+            selectedCount = predicate.filter(batch, all.data(), batch.size(), selected.data());
+        }
+        if (!errorMessage.empty() || batch.size() == 0) return false;
+    }
+    return true;
+}
+
+void Cursor::fillFromScan() {
+    while (!batch.full() && pageNo < pageCount) {
+        auto guard = view.lockPage();
+        if (slot == 0 && zones && !zones->mayMatch(pageNo, predicate)) {
+            stats.pagesSkipped++;
+            pageNo++;
+            continue;
+        }
+        bool pinned, hit;
+        const char* data = pool.viewPage(tablePath, pageNo, pinned, &hit);
+        if (!data) {
+            errorMessage = "Failed to read page " + std::to_string(pageNo) + " of '" + tablePath + "'";
+            pageNo = pageCount;
+            break;
+        }
+        if (slot == 0) {
+            stats.pagesRead++;
+            stats.poolHits += hit ? 1 : 0;
+        }
+        const PageRef page(const_cast<char*>(data), layout);
+        bool finished = true;
+        if (page.isValid()) {
+            uint32_t before = batch.size();
+            slot = batch.appendPage(page, slot, pageNo, snapshot);
+            stats.rowsScanned += batch.size() - before;
+            finished = slot >= page.slotCount();
+        }
+        // ҳܱٷ
+        if (pinned) pool.unpinPage(tablePath, pageNo, false);
+        if (finished) {
+            pageNo++;
+            slot = 0;
+        }
+    }
+}
+
+void Cursor::fillFromRids() {
+    while (!batch.full() && ridPos < rids.size()) {
+        uint32_t p = rids[ridPos].page;
+        auto guard = view.lockPage();
+        bool hit;
+        char* data = pool.fetchPage(tablePath, p, &hit);
+        if (!data) {
+            errorMessage = "Failed to read page " + std::to_string(p) + " of '" + tablePath + "'";
+            ridPos = rids.size();
+            break;
+        }
+        PageRef page(data, layout);
+        for (; ridPos < rids.size() && rids[ridPos].page == p && !batch.full(); ++ridPos) {
+            uint32_t s = rids[ridPos].slot;
+            if (!page.isValid() || s >= page.slotCount() || !page.isUsed(s)) continue;
+            if (!snapshot.visible(page.version(s))) continue;
+            stats.rowsScanned++;
+            if (!predicate.evaluate(page.slotData(s))) continue;
+            batch.appendSlot(page, s, p);
+        }
+        stats.pagesRead++;
+        stats.poolHits += hit ? 1 : 0;
+        pool.unpinPage(tablePath, p, false);
+    }
+}
+
+// ִмƻ
+void Cursor::enableTiming() {
+    timed = true;
+    if (root) root->enableTiming();
+}
+
+void Cursor::collectPlan(std::vector<PlanNode>& nodes) const {
+    int depth = 0;
+    if (limitCount != UINT64_MAX || offsetCount > 0) {
+        std::string text = "Limit (";
+        if (limitCount != UINT64_MAX) text += "limit: " + std::to_string(limitCount);
+        if (offsetCount > 0) text += std::string(limitCount != UINT64_MAX ? ", " : "") + "offset: " + std::to_string(offsetCount);
+        OperatorStats limitStats;
+        limitStats.rowsOut = returned;
+        nodes.push_back({depth++, text + ")", limitCount, 0, limitStats});
+    }
+    if (root) {
+        collectOperator(*root, depth, nodes);
+        return;
+    }
+    std::string text = std::string(indexed ? "Index Scan" : "Seq Scan") + " on " + table.name;
+    if (!predicate.empty()) text += " filter: " + predicate.describe(table);
+    nodes.push_back({depth, text, estimated, stats.rowsScanned, stats});
+}
+
+void Cursor::collectOperator(const Operator& op, int depth, std::vector<PlanNode>& nodes) const {
+    // ɨӵΪΪ֮
+    uint64_t rowsIn = op.statistics().rowsScanned;
+    for (const Operator* input : op.inputs()) rowsIn += input->statistics().rowsOut;
+    nodes.push_back({depth, op.describe(), op.estimatedRows(), rowsIn, op.statistics()});
+    for (const Operator* input : op.inputs()) collectOperator(*input, depth + 1, nodes);
+}
+
+void Cursor::explain(std::ostream& out, bool analyze) const {
+    std::vector<PlanNode> nodes;
+    if (closed) {
+        nodes = profile;
+    } else {
+        collectPlan(nodes);
+    }
+    out << "QUERY PLAN" << std::endl;
+    out << "--------------------" << std::endl;
+    for (const auto& node : nodes) {
+        out << std::string(static_cast<size_t>(node.depth) * 4, ' ') << (node.depth > 0 ? "-> " : "") << node.text;
+        if (node.estimated != UINT64_MAX) out << "  (estimated rows: " << node.estimated << ")";
+        if (analyze) {
+            const OperatorStats& stats = node.stats;
+            char time[32];
+            std::snprintf(time, sizeof(time), "%.3f", stats.nanos / 1e6);
+            out << std::endl << std::string(static_cast<size_t>(node.depth) * 4 + (node.depth > 0 ? 3 : 0), ' ')
+                << "   actual rows: " << stats.rowsOut;
+            if (node.rowsIn > 0) out << ", rows in: " << node.rowsIn;
+            if (stats.nanos > 0) out << ", time: " << time << " ms";
+            if (stats.pagesRead > 0) {
+                out << ", pages: " << stats.pagesRead << ", bytes read: " << stats.pagesRead * PAGE_SIZE
+                    << ", pool hits: " << stats.poolHits;
+            }
+            if (stats.pagesSkipped > 0) out << ", pages skipped: " << stats.pagesSkipped;
+            if (stats.spillFiles > 0) out << ", spill files: " << stats.spillFiles;
+        }
+        out << std::endl;
+    }
+    out << "--------------------" << std::endl;
+}
@@ -0,0 +1,138 @@
+#ifndef CURSOR_H
+#define CURSOR_H
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Schema.h"
+#include "Storage.h"
+#include "BufferPool.h"
+#include "Predicate.h"
+#include "ColumnBatch.h"
+#include "Operator.h"
+#include "ZoneMap.h"
+
+// α굱ǰеֻͼкΪͶӰкţһ next ֮ǰЧ
+class ResultRow {
+public:
+    int32_t getInt(size_t col) const {
+        return batch ? batch->column((*projection)[col]).ints[index] : view.getInt((*projection)[col]);
+    }
+    std::string_view getChar(size_t col) const {
+        return batch ? batch->column((*projection)[col]).getChar(index) : view.getChar((*projection)[col]);
+    }
+    // ۺϽеֻͣ
+    int64_t getBigint(size_t col) const { return view.getBigint((*projection)[col]); }
+    double getDouble(size_t col) const { return view.getDouble((*projection)[col]); }
+
+private:
+    friend class Cursor;
+    const ColumnBatch* batch = nullptr;  // ΪʱǰĶ
+    RowView view;
+    const std::vector<size_t>* projection = nullptr;
+    uint32_t index = 0;
+};
+
+// SELECT Ľα꣬ DBMS::openCursor 
+// ѯÿδӻؽ벢һԿտɼУڴռֻСйأ
+// ѯȡ
+class Cursor {
+public:
+    // indexed Ϊ true ʱֻ rids Уȫɨ
+    // tableLocks Ϊ漰ıĹαرʱͷ
+    Cursor(BufferPool& pool, std::vector<std::shared_lock<std::shared_mutex>> tableLocks, const ReadView& view,
+           const std::string& tablePath, const Table& table, const Predicate& predicate,
+           const std::vector<size_t>& projection, bool indexed, std::vector<RID> rids);
+    // projection Ϊ root ек
+    Cursor(BufferPool& pool, std::vector<std::shared_lock<std::shared_mutex>> tableLocks,
+           std::unique_ptr<Operator> root, const std::vector<size_t>& projection);
+    ~Cursor() { close(); }
+
+    Cursor(const Cursor&) = delete;
+    Cursor& operator=(const Cursor&) = delete;
+
+    size_t columnCount() const { return projection.size(); }
+    const std::string& columnName(size_t col) const { return table.columns[projection[col]].name; }
+    ColumnType columnType(size_t col) const { return table.columns[projection[col]].type; }
+
+    // ȡһУûиʱ false
+    bool next(ResultRow& row);
+    // ǰ offset У෵ limit 
+    void setLimit(uint64_t limit, uint64_t offset);
+    void close();
+    // ִйгֵĴûдʱΪ
+    const std::string& error() const { return errorMessage; }
+
+    // ɨʱͳƼۼͳƣеɨɸɨӼ
+    void setTableStats(TableStats* tableStats) { this->tableStats = tableStats; }
+    // ȫɨͳƱûеĿ飬ȡһ֮ǰ
+    void setZoneMap(const ZoneMap* zones) { this->zones = zones; }
+    // ɨĹŻͳƹʱ
+    void setEstimatedRows(uint64_t rows) { estimated = rows; }
+    // ʼͳƸӵĺʱ(EXPLAIN ANALYZE)ȡһ֮ǰ
+    void enableTiming();
+    // ִмƻanalyze Ϊ true ʱʵʵʱͶȡҳ
+    void explain(std::ostream& out, bool analyze) const;
+
+private:
+    bool fetch(ResultRow& row);
+    bool fill();
+    // ִмƻеһڵ㣬depth Ϊ
+    struct PlanNode {
+        int depth;
+        std::string text;
+        uint64_t estimated;
+        uint64_t rowsIn;
+        OperatorStats stats;
+    };
+    void collectPlan(std::vector<PlanNode>& nodes) const;
+    void collectOperator(const Operator& op, int depth, std::vector<PlanNode>& nodes) const;
+    void fillFromScan();
+    void fillFromRids();
+
+    BufferPool& pool;
+    std::vector<std::shared_lock<std::shared_mutex>> tableLocks;
+    std::unique_ptr<Operator> root;
+    std::string errorMessage;
+    ReadView view;
+    Snapshot snapshot;
+    std::string tablePath;
+    Table table;
+    TableLayout layout;
+    Predicate predicate;
+    std::vector<size_t> projection;
+    const ZoneMap* zones = nullptr;
+
+    bool indexed;
+    std::vector<RID> rids;  // ҳ
+    size_t ridPos = 0;
+    uint32_t pageCount = 0;
+    uint32_t pageNo = 0;
+    uint32_t slot = 0;
+
+    ColumnBatch batch;
+    std::vector<uint32_t> all;       // 0..BATCH_SIZE-1
+    std::vector<uint32_t> selected;  // ǰ
+    uint32_t selectedCount = 0;
+    uint32_t position = 0;
+    uint64_t remaining = UINT64_MAX;
+    uint64_t skip = 0;
+    uint64_t limitCount = UINT64_MAX;
+    uint64_t offsetCount = 0;
+    uint64_t returned = 0;
+    bool started = false;
+    bool closed = false;
+
+    // ɨͳƣɱαֱɨʱʹ
+    uint64_t estimated = 0;
+    OperatorStats stats;
+    TableStats* tableStats = nullptr;
+    bool timed = false;
+    std::vector<PlanNode> profile;  // ʱαرǰ¼ִмƻͳ
+};
+
+#endif // CURSOR_H
@@ -6,103 +6,168 @@
 #include <iomanip>
 #include <filesystem>
 #include <ctime>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <chrono>
+#include <cctype>
+#include <cmath>
+#include <random>
+#include "SqlParser.h"
 
 // 캯
-DBMS::DBMS() {
+DBMS::DBMS(size_t bufferPoolBytes)
+    : bufferPool(bufferPoolBytes), scanWorkers(new ThreadPool(std::thread::hardware_concurrency())) {
     // ɨݿ
     for (const auto& entry : std::filesystem::directory_iterator(".")) {
         if (std::filesystem::is_directory(entry)) {
             std::string dbName = entry.path().filename().string();
-            databases[dbName] = std::vector<std::string>();
+            databases.emplace(dbName, Catalog(dbName));
+            transactionManagers.emplace(dbName, std::unique_ptr<TransactionManager>(new TransactionManager(dbName)));
+            recoverDatabase(dbName);
         }
     }
+
+    bufferPool.setLogger(this);
+    checkpointThread = std::thread(&DBMS::checkpointLoop, this);
+    vacuumThread = std::thread(&DBMS::vacuumLoop, this);
 }
 
 // 
 DBMS::~DBMS() {
-    // ״̬
-    if (!currentDB.empty()) {
-        for (const auto& table : tables) {
-            saveTableInfo(table.second);
-        }
+    {
+        std::lock_guard<std::mutex> lock(checkpointMutex);
+        stopping = true;
     }
+    checkpointWake.notify_all();
+    vacuumWake.notify_all();
+    checkpointThread.join();
+    vacuumThread.join();
+
+    // ṹÿ޸ʱѱ
+    std::unique_lock<std::shared_mutex> lock(engineMutex);
+    checkpointLocked();
+}
+
+bool DBMS::checkpoint() {
+    std::unique_lock<std::shared_mutex> lock(engineMutex);
+    return checkpointLocked();
 }
 
 // ݿ
-bool DBMS::createDatabase(const std::string& name) {
+bool DBMS::createDatabase(Session& session, const std::string& name) {
+    if (!checkNoTransaction(session, "CREATE DATABASE")) return false;
+    std::unique_lock<std::shared_mutex> lock(engineMutex);
     if (databases.find(name) != databases.end()) {
-        std::cout << "Error: Database '" << name << "' already exists." << std::endl;
+        session.out << "Error: Database '" << name << "' already exists." << std::endl;
         return false;
     }
 
     try {
         if (std::filesystem::create_directory(name)) {
-            databases[name] = std::vector<std::string>();
-            std::cout << "Database created successfully." << std::endl;
+            databases.emplace(name, Catalog(name));
+            transactionManagers.emplace(name, std::unique_ptr<TransactionManager>(new TransactionManager(name)));
+            session.out << "Database created successfully." << std::endl;
             return true;
         }
     }
     catch (const std::exception& e) {
-        std::cout << "Error: " << e.what() << std::endl;
+        session.out << "Error: " << e.what() << std::endl;
     }
     return false;
 }
 
-bool DBMS::useDatabase(const std::string& name) {
+bool DBMS::useDatabase(Session& session, const std::string& name) {
+    if (!checkNoTransaction(session, "USE")) return false;
+    std::unique_lock<std::shared_mutex> lock(engineMutex);
     if (databases.find(name) == databases.end()) {
-        std::cout << "Error: Database '" << name << "' does not exist." << std::endl;
+        session.out << "Error: Database '" << name << "' does not exist." << std::endl;
         return false;
     }
 
-    currentDB = name;
-    loadTables();
-    std::cout << "Database changed to '" << name << "'." << std::endl;
+    // ṹڵһỰʹøݿʱ룬֮Ự
+    if (!databases.at(name).isLoaded() && !loadTables(session, name)) return false;
+    session.currentDB = name;
+    session.out << "Database changed to '" << name << "'." << std::endl;
     return true;
 }
 
-bool DBMS::dropDatabase(const std::string& name) {
+bool DBMS::dropDatabase(Session& session, const std::string& name) {
+    if (!checkNoTransaction(session, "DROP DATABASE")) return false;
+    // ȴÿбϵ
+    std::vector<std::string> tableNames;
+    {
+        std::shared_lock<std::shared_mutex> lock(engineMutex);
+        auto it = databases.find(name);
+        if (it != databases.end()) tableNames = it->second.tableNames();
+    }
+    std::sort(tableNames.begin(), tableNames.end());
+    std::vector<std::unique_lock<std::shared_mutex>> tableGuards;
+    for (const auto& tableName : tableNames) {
+        tableGuards.emplace_back(tableLock(name, tableName));
+    }
+
+    std::unique_lock<std::shared_mutex> lock(engineMutex);
     if (databases.find(name) == databases.end()) {
-        std::cout << "Error: Database '" << name << "' does not exist." << std::endl;
+        session.out << "Error: Database '" << name << "' does not exist." << std::endl;
+        return false;
+    }
+    // Ự񻹳иÿĿ
+    if (transactions(name).hasActiveTransactions()) {
+        session.out << "Error: Database '" << name << "' has active transactions." << std::endl;
         return false;
     }
 
     try {
+        checkpointLocked();
+        {
+            std::lock_guard<std::mutex> walLock(walMutex);
+            wals.erase(name);
+        }
+        bufferPool.dropFiles(name + "/");
         std::filesystem::remove_all(name);
         databases.erase(name);
-        if (currentDB == name) {
-            currentDB.clear();
-            tables.clear();
+        transactionManagers.erase(name);
+        dropFreeSpace(name);
+        dropZoneMap(name);
+        dropStatistics(name);
+        resetTableStats(name);
+        if (session.currentDB == name) {
+            session.currentDB.clear();
         }
-        std::cout << "Database dropped successfully." << std::endl;
+        session.out << "Database dropped successfully." << std::endl;
         return true;
     }
     catch (const std::exception& e) {
-        std::cout << "Error: " << e.what() << std::endl;
+        session.out << "Error: " << e.what() << std::endl;
         return false;
     }
 }
 
-void DBMS::showDatabases() {
-    std::cout << "Databases:" << std::endl;
-    std::cout << "--------------------" << std::endl;
+void DBMS::showDatabases(Session& session) {
+    std::shared_lock<std::shared_mutex> lock(engineMutex);
+    session.out << "Databases:" << std::endl;
+    session.out << "--------------------" << std::endl;
     for (const auto& db : databases) {
-        std::cout << db.first << std::endl;
+        session.out << db.first << std::endl;
     }
-    std::cout << "--------------------" << std::endl;
-    std::cout << databases.size() << " database(s)" << std::endl;
+    session.out << "--------------------" << std::endl;
+    session.out << databases.size() << " database(s)" << std::endl;
 }
 
 // 
-bool DBMS::createTable(const std::string& name, const std::string& columnDefs) {
-    if (currentDB.empty()) {
-        std::cout << "Error: No database selected." << std::endl;
+bool DBMS::createTable(Session& session, const std::string& name, const std::string& columnDefs) {
+    if (!checkNoTransaction(session, "CREATE TABLE")) return false;
+    std::unique_lock<std::shared_mutex> lock(engineMutex);
+    if (databases.find(session.currentDB) == databases.end()) {
+        session.out << "Error: No database selected." << std::endl;
         return false;
     }
 
-    std::string tablePath = getTablePath(name);
+    std::string tablePath = getTablePath(session.currentDB, name);
     
     if (std::filesystem::exists(tablePath)) {
-        std::cout << "Error: Table '" << name << "' already exists." << std::endl;
+        session.out << "Error: Table '" << name << "' already exists." << std::endl;
         return false;
     }
 
@@ -135,391 +200,2255 @@ bool DBMS::createTable(const std::string& name, const std::string& columnDefs) {
         columns.push_back(col);
     }
 
+    // 鶨ܷһҳ
+    Table table;
+    table.name = name;
+    table.columns = columns;
+    if (TableLayout(table).slotsPerPage == 0) {
+        session.out << "Error: Row size exceeds page size." << std::endl;
+        return false;
+    }
+
     // ļ
     std::ofstream tableFile(tablePath);
     if (!tableFile) {
-        std::cout << "Error: Failed to create table file." << std::endl;
+        session.out << "Error: Failed to create table file." << std::endl;
         return false;
     }
     tableFile.close();
 
-    // ṹ
-    Table table;
-    table.name = name;
-    table.columns = columns;
-
-    // ڴеıϢ
-    tables[currentDB + "." + name] = table;
-    databases[currentDB].push_back(name);
+    // ±ṹĿ¼
+    databases.at(session.currentDB).addTable(table);
+    if (!saveCatalog(session, session.currentDB)) return false;
 
-    // ṹļ
-    saveTableInfo(table);
-
-    std::cout << "Table created successfully." << std::endl;
+    session.out << "Table created successfully." << std::endl;
     return true;
 }
 
-bool DBMS::dropTable(const std::string& name) {
-    if (currentDB.empty()) {
-        std::cout << "Error: No database selected." << std::endl;
+bool DBMS::dropTable(Session& session, const std::string& name) {
+    if (session.currentDB.empty()) {
+        session.out << "Error: No database selected." << std::endl;
         return false;
     }
+    if (!checkNoTransaction(session, "DROP TABLE")) return false;
 
-    std::string tablePath = getTablePath(name);
-    if (!tableExists(name)) {
-        std::cout << "Error: Table '" << name << "' does not exist." << std::endl;
+    std::unique_lock<std::shared_mutex> tableGuard(tableLock(session.currentDB, name));
+    std::unique_lock<std::shared_mutex> lock(engineMutex);
+    std::string tablePath = getTablePath(session.currentDB, name);
+    if (!tableExists(session.currentDB, name)) {
+        session.out << "Error: Table '" << name << "' does not exist." << std::endl;
+        return false;
+    }
+    if (transactions(session.currentDB).hasPendingWrites(name)) {
+        session.out << "Error: Table '" << name << "' has uncommitted changes." << std::endl;
         return false;
     }
 
     try {
+        // 㣬־оɱļ¼ؽͬطţʧʱɾ
+        if (!checkpointLocked()) {
+            session.out << "Error: Failed to write checkpoint" << std::endl;
+            return false;
+        }
+        for (const auto& index : findTable(session.currentDB, name)->indexes) {
+            std::string indexPath = getIndexPath(session.currentDB, name, index.name);
+            bufferPool.dropFile(indexPath);
+            std::filesystem::remove(indexPath);
+        }
+        bufferPool.dropFile(tablePath);
         std::filesystem::remove(tablePath);
-        std::filesystem::remove(tablePath + ".info");
-        
-        auto& dbTables = databases[currentDB];
-        dbTables.erase(std::remove(dbTables.begin(), dbTables.end(), name), dbTables.end());
-        tables.erase(currentDB + "." + name);
-
-        std::cout << "Table dropped successfully." << std::endl;
+        databases.at(session.currentDB).removeTable(name);
+        transactions(session.currentDB).dropTable(name);
+        dropFreeSpace(session.currentDB, name);
+        dropZoneMap(session.currentDB, name);
+        dropStatistics(session.currentDB, name);
+        resetTableStats(session.currentDB, name);
+        if (!saveCatalog(session, session.currentDB)) return false;
+
+        session.out << "Table dropped successfully." << std::endl;
         return true;
     }
     catch (const std::exception& e) {
-        std::cout << "Error: " << e.what() << std::endl;
+        session.out << "Error: " << e.what() << std::endl;
         return false;
     }
 }
 
-void DBMS::showTables() {
-    if (currentDB.empty()) {
-        std::cout << "Error: No database selected." << std::endl;
+void DBMS::showTables(Session& session) {
+    std::shared_lock<std::shared_mutex> lock(engineMutex);
+    auto db = databases.find(session.currentDB);
+    if (db == databases.end()) {
+        session.out << "Error: No database selected." << std::endl;
         return;
     }
 
-    std::cout << "Tables in database '" << currentDB << "':" << std::endl;
-    std::cout << "--------------------" << std::endl;
-    for (const auto& tableName : databases[currentDB]) {
-        std::cout << tableName << std::endl;
+    session.out << "Tables in database '" << session.currentDB << "':" << std::endl;
+    session.out << "--------------------" << std::endl;
+    for (const auto& tableName : db->second.tableNames()) {
+        session.out << tableName << std::endl;
+    }
+    session.out << "--------------------" << std::endl;
+    session.out << db->second.tableNames().size() << " table(s)" << std::endl;
+}
+
+// 
+bool DBMS::createIndex(Session& session,
+                      const std::string& indexName,
+                      const std::string& tableName,
+                      const std::string& columnName) {
+    if (session.currentDB.empty()) {
+        session.out << "Error: No database selected." << std::endl;
+        return false;
+    }
+    if (!checkNoTransaction(session, "CREATE INDEX")) return false;
+
+    std::unique_lock<std::shared_mutex> tableGuard(tableLock(session.currentDB, tableName));
+    std::unique_lock<std::shared_mutex> lock(engineMutex);
+    if (!tableExists(session.currentDB, tableName)) {
+        session.out << "Error: Table '" << tableName << "' does not exist." << std::endl;
+        return false;
+    }
+
+    // ݿΨһ
+    Catalog& catalog = databases.at(session.currentDB);
+    if (catalog.indexOwner(indexName)) {
+        session.out << "Error: Index '" << indexName << "' already exists." << std::endl;
+        return false;
+    }
+
+    const Table& table = *catalog.find(tableName);
+    size_t col = 0;
+    if (!catalog.columnIndex(tableName, columnName, col)) {
+        session.out << "Error: Unknown column '" << columnName << "'" << std::endl;
+        return false;
+    }
+    if (TableLayout(table).widths[col] > BTree::maxKeySize()) {
+        session.out << "Error: Column '" << columnName << "' is too wide to index (at most "
+                    << BTree::maxKeySize() << " bytes)" << std::endl;
+        return false;
+    }
+
+    if (!buildIndex(session.currentDB, table, indexName, col)) {
+        std::string indexPath = getIndexPath(session.currentDB, tableName, indexName);
+        bufferPool.dropFile(indexPath);
+        std::error_code ec;
+        std::filesystem::remove(indexPath, ec);
+        session.out << "Error: Failed to write index file." << std::endl;
+        return false;
+    }
+
+    IndexInfo index;
+    index.name = indexName;
+    index.column = columnName;
+    catalog.addIndex(tableName, index);
+    if (!saveCatalog(session, session.currentDB)) return false;
+
+    session.out << "Index created successfully." << std::endl;
+    return true;
+}
+
+bool DBMS::dropIndex(Session& session, const std::string& indexName, const std::string& tableName) {
+    if (session.currentDB.empty()) {
+        session.out << "Error: No database selected." << std::endl;
+        return false;
+    }
+    if (!checkNoTransaction(session, "DROP INDEX")) return false;
+
+    // δָʱҳڵıٸ
+    std::string owner = tableName;
+    if (owner.empty()) {
+        std::shared_lock<std::shared_mutex> lock(engineMutex);
+        auto db = databases.find(session.currentDB);
+        const std::string* table = (db != databases.end()) ? db->second.indexOwner(indexName) : nullptr;
+        if (table) owner = *table;
+    }
+
+    if (!owner.empty()) {
+        std::unique_lock<std::shared_mutex> tableGuard(tableLock(session.currentDB, owner));
+        std::unique_lock<std::shared_mutex> lock(engineMutex);
+        auto db = databases.find(session.currentDB);
+        const std::string* table = (db != databases.end()) ? db->second.indexOwner(indexName) : nullptr;
+        if (table && *table == owner) {
+            std::string indexPath = getIndexPath(session.currentDB, owner, indexName);
+            if (!checkpointLocked()) {
+                session.out << "Error: Failed to write checkpoint" << std::endl;
+                return false;
+            }
+            bufferPool.dropFile(indexPath);
+            std::filesystem::remove(indexPath);
+            db->second.removeIndex(owner, indexName);
+            if (!saveCatalog(session, session.currentDB)) return false;
+
+            session.out << "Index dropped successfully." << std::endl;
+            return true;
+        }
     }
-    std::cout << "--------------------" << std::endl;
-    std::cout << databases[currentDB].size() << " table(s)" << std::endl;
+
+    session.out << "Error: Index '" << indexName << "' does not exist." << std::endl;
+    return false;
 }
 
 // ݲ
-bool DBMS::insertInto(const std::string& tableName, 
+bool DBMS::insertInto(Session& session,
+                     const std::string& tableName,
                      const std::string& columnList, 
                      const std::string& valueList) {
-    if (currentDB.empty()) {
-        std::cout << "Error: No database selected." << std::endl;
+    return insertRows(session, tableName, columnList, std::vector<std::string>(1, valueList));
+}
+
+bool DBMS::insertRows(Session& session,
+                      const std::string& tableName,
+                      const std::string& columnList,
+                      const std::vector<std::string>& valueLists) {
+    insertCount++;
+    if (session.currentDB.empty()) {
+        session.out << "Error: No database selected." << std::endl;
         return false;
     }
 
-    if (!tableExists(tableName)) {
-        std::cout << "Error: Table '" << tableName << "' does not exist." << std::endl;
+    std::shared_lock<std::shared_mutex> tableGuard(tableLock(session.currentDB, tableName));
+    std::shared_lock<std::shared_mutex> lock(engineMutex);
+    if (!tableExists(session.currentDB, tableName)) {
+        session.out << "Error: Table '" << tableName << "' does not exist." << std::endl;
         return false;
     }
 
     // ȡṹ
-    const Table& table = tables[currentDB + "." + tableName];
-    
-    // ֵб
-    std::vector<std::string> values = splitString(valueList, ',');
-    
-    // ṩбֵ֤ƥ
+    const Table& table = *findTable(session.currentDB, tableName);
+    TableLayout layout(table);
+
+    // ȷÿֵӦ
+    std::vector<size_t> targets;
     if (!columnList.empty()) {
-        std::vector<std::string> columns = splitString(columnList, ',');
-        if (columns.size() != values.size()) {
-            std::cout << "Error: Column count doesn't match value count" << std::endl;
-            return false;
+        const Catalog& catalog = databases.at(session.currentDB);
+        for (const auto& colName : splitString(columnList, ',')) {
+            size_t i = 0;
+            if (!catalog.columnIndex(tableName, colName, i)) {
+                session.out << "Error: Unknown column '" << colName << "'" << std::endl;
+                return false;
+            }
+            targets.push_back(i);
         }
     } else {
-        // ûṩбֵ֤Ƿƥ
-        if (values.size() != table.columns.size()) {
-            std::cout << "Error: Value count doesn't match column count" << std::endl;
+        for (size_t i = 0; i < table.columns.size(); ++i) {
+            targets.push_back(i);
+        }
+    }
+
+    // ȰбΪУδָбΪ 0 մ
+    size_t count = valueLists.size();
+    std::vector<char> rows(count * layout.rowSize, 0);
+    std::vector<std::string_view> values;
+    for (size_t r = 0; r < count; ++r) {
+        splitValues(valueLists[r], ',', values);
+        if (values.size() != targets.size()) {
+            if (!columnList.empty()) {
+                session.out << "Error: Column count doesn't match value count" << std::endl;
+            } else {
+                session.out << "Error: Value count doesn't match column count" << std::endl;
+            }
             return false;
         }
+        char* row = rows.data() + r * layout.rowSize;
+        for (size_t i = 0; i < values.size(); ++i) {
+            std::string error;
+            if (!encodeField(layout, targets[i], values[i], row, error)) {
+                session.out << "Error: " << error << " for column '"
+                          << table.columns[targets[i]].name << "'" << std::endl;
+                return false;
+            }
+        }
     }
 
-    // д¼
-    if (!writeRecord(tableName, values)) {
-        std::cout << "Error: Failed to write record" << std::endl;
+    // һҳд룬д룬еĿλ
+    std::string tablePath = getTablePath(session.currentDB, tableName);
+    std::unique_lock<TableLatch> latch(tableLatch(session.currentDB, tableName));
+    FreeSpaceMap& space = freeSpace(session.currentDB, tableName);
+    ZoneMap& zones = zoneMap(session.currentDB, table);
+    Statement statement(*this, session);
+    if (!statement.isValid()) {
+        session.out << "Error: Failed to write transaction clock" << std::endl;
+        return false;
+    }
+    if (count < layout.slotsPerPage) {
+        for (size_t r = 0; r < count; ++r) {
+            const char* row = rows.data() + r * layout.rowSize;
+            RID rid;
+            if (!writeRecord(tablePath, layout, space, zones, row, statement.stamp(), rid)) {
+                session.out << "Error: Failed to write record" << std::endl;
+                return false;
+            }
+            updateIndexes(session.currentDB, table, layout, nullptr, row, rid);
+            statement.wrote(tableName, rid.page, false);
+        }
+    } else {
+        BulkLoader loader(bufferPool, statement.getWal(), statement.getId(), tablePath, tableName + ".table",
+                          layout, space, zones, bulkIndexes(session.currentDB, table), statement.stamp());
+        for (size_t r = 0; r < count; ++r) {
+            if (!loader.add(rows.data() + r * layout.rowSize)) break;
+        }
+        bool loaded = loader.rowCount() == count && loader.finish();
+        for (uint32_t p : loader.writtenPages()) statement.wrote(tableName, p, false);
+        if (!loaded) {
+            session.out << "Error: Failed to write record" << std::endl;
+            return false;
+        }
+    }
+    if (!statement.commit()) {
+        session.out << "Error: Failed to write log" << std::endl;
         return false;
     }
 
-    std::cout << "1 row inserted successfully." << std::endl;
+    tableStats(session.currentDB, tableName).addRows(count, 0, 0);
+    if (count == 1) {
+        session.out << "1 row inserted successfully." << std::endl;
+    } else {
+        session.out << count << " row(s) inserted successfully." << std::endl;
+    }
     return true;
 }
 
-bool DBMS::selectFrom(const std::string& tableName, 
-                     const std::string& columnList, 
-                     const std::string& whereClause) {
-    if (currentDB.empty()) {
-        std::cout << "Error: No database selected." << std::endl;
+bool DBMS::loadData(Session& session, const std::string& fileName, const std::string& tableName) {
+    if (session.currentDB.empty()) {
+        session.out << "Error: No database selected." << std::endl;
         return false;
     }
 
-    if (!tableExists(tableName)) {
-        std::cout << "Error: Table '" << tableName << "' does not exist." << std::endl;
+    std::shared_lock<std::shared_mutex> tableGuard(tableLock(session.currentDB, tableName));
+    std::shared_lock<std::shared_mutex> lock(engineMutex);
+    if (!tableExists(session.currentDB, tableName)) {
+        session.out << "Error: Table '" << tableName << "' does not exist." << std::endl;
         return false;
     }
 
-    // ȡṹ
-    const Table& table = tables[currentDB + "." + tableName];
-    
-    // ȡм¼
-    auto records = readRecords(tableName);
-    
-    // ȷҪʾ
-    std::vector<std::string> columnsToShow;
+    CsvReader reader(fileName);
+    if (!reader.isOpen()) {
+        session.out << "Error: Cannot open file '" << fileName << "'." << std::endl;
+        return false;
+    }
+
+    const Table& table = *findTable(session.currentDB, tableName);
+    TableLayout layout(table);
+
+    // ߶У飬ʱֹ֮ͣǰճύ
+    std::string tablePath = getTablePath(session.currentDB, tableName);
+    std::unique_lock<TableLatch> latch(tableLatch(session.currentDB, tableName));
+    FreeSpaceMap& space = freeSpace(session.currentDB, tableName);
+    ZoneMap& zones = zoneMap(session.currentDB, table);
+    Statement statement(*this, session);
+    if (!statement.isValid()) {
+        session.out << "Error: Failed to write transaction clock" << std::endl;
+        return false;
+    }
+    BulkLoader loader(bufferPool, statement.getWal(), statement.getId(), tablePath, tableName + ".table",
+                      layout, space, zones, bulkIndexes(session.currentDB, table), statement.stamp());
+    std::vector<char> row(layout.rowSize);
+    std::vector<std::string> fields;
+    std::string error;
+    bool loaded = true;
+    while (error.empty() && reader.next(fields)) {
+        if (fields.size() != table.columns.size()) {
+            error = "Value count doesn't match column count";
+            break;
+        }
+        std::fill(row.begin(), row.end(), 0);
+        for (size_t i = 0; i < fields.size() && error.empty(); ++i) {
+            if (!encodeValue(layout, i, fields[i], row.data(), error)) {
+                error += " for column '" + table.columns[i].name + "'";
+            }
+        }
+        if (error.empty() && !loader.add(row.data())) {
+            loaded = false;
+            break;
+        }
+    }
+    loaded = loader.finish() && loaded;
+    for (uint32_t p : loader.writtenPages()) statement.wrote(tableName, p, false);
+    if (!loaded) {
+        session.out << "Error: Failed to write record" << std::endl;
+        return false;
+    }
+    if (!statement.commit()) {
+        session.out << "Error: Failed to write log" << std::endl;
+        return false;
+    }
+
+    tableStats(session.currentDB, tableName).addRows(loader.rowCount(), 0, 0);
+    if (!error.empty()) {
+        session.out << "Error: " << error << " at line " << reader.lineNumber() << std::endl;
+    }
+    session.out << loader.rowCount() << " row(s) loaded." << std::endl;
+    return error.empty();
+}
+
+std::unique_ptr<Cursor> DBMS::openCursor(Session& session,
+                                         const std::string& tableName,
+                                         const std::string& columnList,
+                                         const Condition* where,
+                                         const std::string& groupBy,
+                                         const std::string& orderBy,
+                                         int64_t limit,
+                                         int64_t offset) {
+    selectCount++;
+    return buildCursor(session, tableName, columnList, where, groupBy, orderBy, limit, offset);
+}
+
+std::unique_ptr<Cursor> DBMS::buildCursor(Session& session,
+                                          const std::string& tableName,
+                                          const std::string& columnList,
+                                          const Condition* where,
+                                          const std::string& groupBy,
+                                          const std::string& orderBy,
+                                          int64_t limit,
+                                          int64_t offset) {
+    if (session.currentDB.empty()) {
+        session.out << "Error: No database selected." << std::endl;
+        return nullptr;
+    }
+    // ѯۺϲѯѯִ
+    std::vector<std::string> tableNames = splitString(tableName, ',');
+    bool aggregated = !groupBy.empty();
+    for (const auto& item : splitString(columnList, ',')) {
+        AggregateFunc func;
+        std::string argument;
+        aggregated = aggregated || parseAggregate(item, func, argument);
+    }
+    if (tableNames.size() > 1 || aggregated || !orderBy.empty()) {
+        return openOperatorCursor(session, tableNames, columnList, where, groupBy, orderBy, limit, offset);
+    }
+
+    std::vector<std::shared_lock<std::shared_mutex>> tableGuards;
+    tableGuards.emplace_back(tableLock(session.currentDB, tableName));
+    std::shared_lock<std::shared_mutex> lock(engineMutex);
+    if (!tableExists(session.currentDB, tableName)) {
+        session.out << "Error: Table '" << tableName << "' does not exist." << std::endl;
+        return nullptr;
+    }
+
+    const Table& table = *findTable(session.currentDB, tableName);
+    Predicate predicate;
+    std::vector<size_t> projection;
+    std::string error;
+    if (!resolveScan(table, columnList, where, projection, predicate, error)) {
+        session.out << "Error: " << error << std::endl;
+        return nullptr;
+    }
+    return openTableCursor(session, std::move(tableGuards), table, predicate, projection, limit, offset);
+}
+
+//  WHERE ΪνʲȷҪ
+bool DBMS::resolveScan(const Table& table, const std::string& columnList, const Condition* where,
+                       std::vector<size_t>& projection, Predicate& predicate, std::string& error) {
+    TableLayout layout(table);
+    if (!predicate.compile(where, table, layout, error)) return false;
     if (columnList == "*") {
-        for (const auto& col : table.columns) {
-            columnsToShow.push_back(col.name);
+        for (size_t i = 0; i < table.columns.size(); ++i) {
+            projection.push_back(i);
+        }
+        return true;
+    }
+    for (const auto& colName : splitString(columnList, ',')) {
+        size_t i = 0;
+        if (!resolveColumn(table, colName, i, error)) return false;
+        projection.push_back(i);
+    }
+    return true;
+}
+
+// ÷бĹ湲
+std::unique_ptr<Cursor> DBMS::openTableCursor(Session& session,
+                                              std::vector<std::shared_lock<std::shared_mutex>> tableGuards,
+                                              const Table& table, const Predicate& predicate,
+                                              const std::vector<size_t>& projection,
+                                              int64_t limit, int64_t offset) {
+    const std::string& tableName = table.name;
+    TableLayout layout(table);
+    // ʱֻУȫɨ谴͹
+    ReadView view;
+    view.snapshot = readSnapshot(session);
+    view.latch = &tableLatch(session.currentDB, tableName);
+    std::vector<RID> rids;
+    bool indexed;
+    const ZoneMap* zones = nullptr;
+    {
+        auto guard = view.lockPage();
+        indexed = findIndexedRows(session.currentDB, table, layout, predicate, rids);
+        if (!indexed && !predicate.empty()) zones = &zoneMap(session.currentDB, table);
+    }
+    std::string tablePath = getTablePath(session.currentDB, tableName);
+    uint32_t pageCount = bufferPool.pageCount(tablePath);
+    std::shared_ptr<const TableStatistics> statistics = analyzedStatistics(session.currentDB, table);
+    std::unique_ptr<Cursor> cursor;
+    if (!indexed && ScanOperator::parallelizable(scanWorkers.get(), pageCount)) {
+        // ̳߳زɨ
+        std::unique_ptr<ScanOperator> scan(new ScanOperator(bufferPool, tablePath, table, view, predicate, false, {},
+                                                            "", scanWorkers.get()));
+        scan->setTableStats(&tableStats(session.currentDB, tableName));
+        scan->setZoneMap(zones);
+        if (statistics) {
+            scan->setEstimatedRows(std::llround(statistics->estimatedRows(pageCount) * statistics->selectivity(predicate)));
         }
+        cursor.reset(new Cursor(bufferPool, std::move(tableGuards), std::move(scan), projection));
     } else {
-        columnsToShow = splitString(columnList, ',');
+        cursor.reset(new Cursor(bufferPool, std::move(tableGuards), view, tablePath,
+                                table, predicate, projection, indexed, std::move(rids)));
+        cursor->setTableStats(&tableStats(session.currentDB, tableName));
+        cursor->setZoneMap(zones);
+        if (statistics) {
+            cursor->setEstimatedRows(std::llround(statistics->estimatedRows(pageCount) * statistics->selectivity(predicate)));
+        }
     }
+    // α갴ȡȡ LIMIT кɨʣҳ
+    if (limit >= 0 || offset > 0) cursor->setLimit(limit >= 0 ? limit : UINT64_MAX, offset);
+    return cursor;
+}
+
+std::unique_ptr<Cursor> DBMS::openOperatorCursor(Session& session,
+                                                 const std::vector<std::string>& tableNames,
+                                                 const std::string& columnList,
+                                                 const Condition* where,
+                                                 const std::string& groupBy,
+                                                 const std::string& orderBy,
+                                                 int64_t limit, int64_t offset) {
+    const std::string& dbName = session.currentDB;
+    std::set<std::string> lockOrder;
+    for (const auto& name : tableNames) {
+        if (!lockOrder.insert(name).second) {
+            session.out << "Error: Table '" << name << "' appears more than once." << std::endl;
+            return nullptr;
+        }
+    }
+
+    // ˳ɾݿʱ˳һ
+    std::vector<std::shared_lock<std::shared_mutex>> tableGuards;
+    for (const auto& name : lockOrder) {
+        tableGuards.emplace_back(tableLock(dbName, name));
+    }
+    std::shared_lock<std::shared_mutex> lock(engineMutex);
+    std::vector<const Table*> joined;
+    for (const auto& name : tableNames) {
+        if (!tableExists(dbName, name)) {
+            session.out << "Error: Table '" << name << "' does not exist." << std::endl;
+            return nullptr;
+        }
+        joined.push_back(findTable(dbName, name));
+    }
+
+    std::vector<std::unique_ptr<ScanOperator>> scans;
+    std::vector<std::vector<const Condition*>> joinConditions;
+    std::vector<double> estimates;
+    // ʹͬһ
+    if (!planScans(session, tableNames, joined, where, readSnapshot(session), scans, joinConditions, estimates)) {
+        return nullptr;
+    }
+
+    std::vector<std::string> items = splitString(columnList, ',');
+    std::vector<AggregateFunc> funcs(items.size());
+    std::vector<std::string> arguments(items.size());
+    std::vector<bool> isAggregate(items.size(), false);
+    bool countOnly = groupBy.empty() && orderBy.empty() && joined.size() == 1;
+    for (size_t i = 0; i < items.size(); ++i) {
+        isAggregate[i] = parseAggregate(items[i], funcs[i], arguments[i]);
+        countOnly = countOnly && isAggregate[i] && funcs[i] == AggregateFunc::COUNT;
+    }
+    std::string error;
+
+    // ֻ COUNT ĵѯֱͳ
+    if (countOnly) {
+        std::vector<size_t> projection;
+        for (size_t i = 0; i < items.size(); ++i) {
+            size_t col;
+            if (arguments[i] != "*" && !resolveColumn(*joined[0], arguments[i], col, error)) {
+                session.out << "Error: " << error << std::endl;
+                return nullptr;
+            }
+            projection.push_back(i);
+        }
+        std::unique_ptr<Operator> root(new CountOperator(std::move(scans[0]), items));
+        return finishCursor(session, std::move(tableGuards), std::move(root), projection, orderBy, limit, offset);
+    }
+
+    std::unique_ptr<Operator> root = joinScans(session, std::move(scans), joinConditions, estimates);
+    if (!root) return nullptr;
+
+    std::vector<size_t> projection;
+    bool aggregated = !groupBy.empty() || std::find(isAggregate.begin(), isAggregate.end(), true) != isAggregate.end();
+    if (!aggregated) {
+        const Table& schema = root->schema();
+        if (columnList == "*") {
+            // ˳ FROM еĲͬ FROM е˳
+            for (size_t t = 0; t < joined.size(); ++t) {
+                for (const auto& column : joined[t]->columns) {
+                    size_t i = 0;
+                    resolveColumn(schema, joined.size() > 1 ? tableNames[t] + "." + column.name : column.name,
+                                  i, error);
+                    projection.push_back(i);
+                }
+            }
+        } else {
+            for (const auto& colName : items) {
+                size_t i = 0;
+                if (!resolveColumn(schema, colName, i, error)) {
+                    session.out << "Error: " << error << std::endl;
+                    return nullptr;
+                }
+                projection.push_back(i);
+            }
+        }
+        return finishCursor(session, std::move(tableGuards), std::move(root), projection, orderBy, limit, offset);
+    }
+
+    // ۺϣΪкӾۺУѡбеͨбǷ
+    if (columnList == "*") {
+        session.out << "Error: SELECT * cannot be used with GROUP BY." << std::endl;
+        return nullptr;
+    }
+    const Table& input = root->schema();
+    std::vector<size_t> groupColumns;
+    if (!groupBy.empty()) {
+        for (const auto& colName : splitString(groupBy, ',')) {
+            size_t col;
+            if (!resolveColumn(input, colName, col, error)) {
+                session.out << "Error: " << error << std::endl;
+                return nullptr;
+            }
+            if (std::find(groupColumns.begin(), groupColumns.end(), col) == groupColumns.end()) {
+                groupColumns.push_back(col);
+            }
+        }
+    }
+    std::vector<AggregateSpec> aggregates;
+    for (size_t i = 0; i < items.size(); ++i) {
+        size_t col = 0;
+        if (!isAggregate[i]) {
+            if (!resolveColumn(input, items[i], col, error)) {
+                session.out << "Error: " << error << std::endl;
+                return nullptr;
+            }
+            auto it = std::find(groupColumns.begin(), groupColumns.end(), col);
+            if (it == groupColumns.end()) {
+                session.out << "Error: Column '" << items[i] << "' must appear in GROUP BY." << std::endl;
+                return nullptr;
+            }
+            projection.push_back(it - groupColumns.begin());
+            continue;
+        }
+
+        AggregateSpec aggregate = {funcs[i], arguments[i] == "*", 0, items[i]};
+        if (aggregate.star && aggregate.func != AggregateFunc::COUNT) {
+            session.out << "Error: Only COUNT accepts '*'." << std::endl;
+            return nullptr;
+        }
+        if (!aggregate.star) {
+            if (!resolveColumn(input, arguments[i], aggregate.column, error)) {
+                session.out << "Error: " << error << std::endl;
+                return nullptr;
+            }
+            bool numeric = (aggregate.func == AggregateFunc::SUM || aggregate.func == AggregateFunc::AVG);
+            if (numeric && input.columns[aggregate.column].type != ColumnType::INT) {
+                session.out << "Error: " << items[i] << " requires an INT column." << std::endl;
+                return nullptr;
+            }
+        }
+        projection.push_back(groupColumns.size() + aggregates.size());
+        aggregates.push_back(aggregate);
+    }
+    root.reset(new HashAggregate(std::move(root), groupColumns, aggregates, dbName, workMemory));
+    return finishCursor(session, std::move(tableGuards), std::move(root), projection, orderBy, limit, offset);
+}
 
-    // ȡе
-    std::map<std::string, size_t> columnIndices;
-    for (size_t i = 0; i < table.columns.size(); ++i) {
-        columnIndices[table.columns[i].name] = i;
+//  root нۺϲѯпǷлѡбеľۺ
+std::unique_ptr<Cursor> DBMS::finishCursor(Session& session,
+                                           std::vector<std::shared_lock<std::shared_mutex>> tableGuards,
+                                           std::unique_ptr<Operator> root, const std::vector<size_t>& projection,
+                                           const std::string& orderBy, int64_t limit, int64_t offset) {
+    if (!orderBy.empty()) {
+        std::vector<SortKey> keys;
+        std::string error;
+        for (const auto& item : splitString(orderBy, ',')) {
+            std::string name = item;
+            bool descending = false;
+            size_t space = item.rfind(' ');
+            if (space != std::string::npos) {
+                name = item.substr(0, space);
+                descending = (item.substr(space + 1) == "DESC");
+            }
+            size_t col;
+            if (!resolveColumn(root->schema(), name, col, error)) {
+                session.out << "Error: " << error << std::endl;
+                return nullptr;
+            }
+            keys.push_back({col, descending});
+        }
+        // ֻҪ OFFSET + LIMIT ʱǰ N 
+        uint64_t needed = limit >= 0 ? static_cast<uint64_t>(limit) + static_cast<uint64_t>(offset) : 0;
+        root.reset(new SortOperator(std::move(root), keys, needed, session.currentDB, workMemory));
     }
+    std::unique_ptr<Cursor> cursor(new Cursor(bufferPool, std::move(tableGuards), std::move(root), projection));
+    if (limit >= 0 || offset > 0) cursor->setLimit(limit >= 0 ? limit : UINT64_MAX, offset);
+    return cursor;
+}
 
-    // ӡ
-    for (const auto& colName : columnsToShow) {
-        std::cout << std::setw(15) << std::left << colName;
+// õı WHERE ĺȡ飺ֻ漰һűɨʱˣ
+// ķŵ˳һűǴ
+//  ANALYZE ͳʱÿűɨٵһſʼÿνӵı
+// Ӻٵһţscans ˳Уestimates ΪһűɨÿӺĹ
+// ûͳʱ estimates Ϊգ FROM е˳
+bool DBMS::planScans(Session& session, const std::vector<std::string>& tableNames,
+                     const std::vector<const Table*>& joined, const Condition* where,
+                     const std::shared_ptr<const Snapshot>& snapshot,
+                     std::vector<std::unique_ptr<ScanOperator>>& scans,
+                     std::vector<std::vector<const Condition*>>& joinConditions, std::vector<double>& estimates) {
+    // ıҲʱ
+    auto owner = [&](const std::string& name, size_t& table, size_t& col) {
+        table = joined.size();
+        for (size_t i = 0; i < joined.size(); ++i) {
+            size_t found;
+            std::string ignored;
+            if (!resolveColumn(*joined[i], name, found, ignored)) continue;
+            if (table != joined.size()) {
+                session.out << "Error: Column '" << name << "' is ambiguous" << std::endl;
+                return false;
+            }
+            table = i;
+            col = found;
+        }
+        if (table == joined.size()) {
+            session.out << "Error: Unknown column '" << name << "'" << std::endl;
+            return false;
+        }
+        return true;
+    };
+
+    std::vector<const Condition*> conjuncts;
+    if (where) where->conjuncts(conjuncts);
+    std::vector<std::vector<const Condition*>> scanConditions(joined.size());
+    std::vector<std::pair<const Condition*, std::set<size_t>>> crossConditions;  // 漰űЩ
+    for (const Condition* condition : conjuncts) {
+        std::vector<std::string> names;
+        condition->columnNames(names);
+        std::set<size_t> referenced;
+        for (const auto& name : names) {
+            size_t table, col;
+            if (!owner(name, table, col)) return false;
+            referenced.insert(table);
+        }
+        if (referenced.size() == 1) {
+            scanConditions[*referenced.begin()].push_back(condition);
+        } else {
+            crossConditions.emplace_back(condition, referenced);
+        }
     }
-    std::cout << std::endl;
 
-    // ӡָ
-    for (size_t i = 0; i < columnsToShow.size(); ++i) {
-        std::cout << "---------------";
+    // ѯϱǰ׺
+    const std::string& dbName = session.currentDB;
+    std::string error;
+    std::vector<std::shared_ptr<const TableStatistics>> statistics(joined.size());
+    std::vector<double> rows(joined.size());
+    bool costed = true;
+    for (size_t i = 0; i < joined.size(); ++i) {
+        const Table& table = *joined[i];
+        TableLayout layout(table);
+        Predicate predicate;
+        if (!predicate.compile(scanConditions[i], table, layout, error)) {
+            session.out << "Error: " << error << std::endl;
+            return false;
+        }
+        ReadView view;
+        view.snapshot = snapshot;
+        view.latch = &tableLatch(dbName, tableNames[i]);
+        std::vector<RID> rids;
+        bool indexed;
+        const ZoneMap* zones = nullptr;
+        {
+            auto guard = view.lockPage();
+            indexed = findIndexedRows(dbName, table, layout, predicate, rids);
+            if (!indexed && !predicate.empty()) zones = &zoneMap(dbName, table);
+        }
+        std::string tablePath = getTablePath(dbName, tableNames[i]);
+        scans.emplace_back(new ScanOperator(bufferPool, tablePath, table,
+                                            view, predicate, indexed, std::move(rids),
+                                            joined.size() > 1 ? tableNames[i] : "", scanWorkers.get()));
+        scans.back()->setTableStats(&tableStats(dbName, tableNames[i]));
+        scans.back()->setZoneMap(zones);
+        statistics[i] = analyzedStatistics(dbName, table);
+        if (!statistics[i]) {
+            costed = false;
+            continue;
+        }
+        rows[i] = std::max(statistics[i]->estimatedRows(bufferPool.pageCount(tablePath)) *
+                           statistics[i]->selectivity(predicate), 1.0);
+        scans.back()->setEstimatedRows(std::llround(rows[i]));
     }
-    std::cout << std::endl;
 
-    // ӡ¼
-    int matchCount = 0;
-    for (const auto& record : records) {
-        if (evaluateCondition(record, whereClause, columnIndices)) {
-            for (const auto& colName : columnsToShow) {
-                auto it = columnIndices.find(colName);
-                if (it != columnIndices.end()) {
-                    std::cout << std::setw(15) << std::left << record[it->second];
+    std::vector<size_t> order(joined.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    estimates.clear();
+    if (costed) {
+        // ѡʣֵΪ 1 / ಻ֵͬĽϴߣఴĬֵ
+        std::vector<double> selectivity;
+        for (const auto& entry : crossConditions) {
+            const Condition* condition = entry.first;
+            double s = DEFAULT_RANGE_SELECTIVITY;
+            size_t a, ca, b, cb;
+            if (condition->kind == Condition::COMPARE && condition->isColumn &&
+                (condition->op == CompareOp::EQ || condition->op == CompareOp::NE) &&
+                owner(condition->column, a, ca) && owner(condition->value, b, cb)) {
+                s = 1 / std::max(statistics[a]->distinctValues(ca, rows[a]), statistics[b]->distinctValues(cb, rows[b]));
+                if (condition->op == CompareOp::NE) s = 1 - s;
+            }
+            selectivity.push_back(s);
+        }
+
+        std::vector<bool> placed(joined.size(), false);
+        order.assign(1, std::min_element(rows.begin(), rows.end()) - rows.begin());
+        placed[order[0]] = true;
+        estimates.push_back(rows[order[0]]);
+        while (order.size() < joined.size()) {
+            size_t best = joined.size();
+            double bestRows = 0;
+            bool bestConnected = false;
+            for (size_t t = 0; t < joined.size(); ++t) {
+                if (placed[t]) continue;
+                double result = estimates.back() * rows[t];
+                bool connected = false;
+                for (size_t k = 0; k < crossConditions.size(); ++k) {
+                    const std::set<size_t>& tables = crossConditions[k].second;
+                    bool ready = tables.count(t) > 0;
+                    for (size_t other : tables) ready = ready && (other == t || placed[other]);
+                    if (!ready) continue;
+                    connected = true;
+                    result *= selectivity[k];
+                }
+                // ѿ
+                if (best == joined.size() || (connected && !bestConnected) ||
+                    (connected == bestConnected && result < bestRows)) {
+                    best = t;
+                    bestRows = result;
+                    bestConnected = connected;
                 }
             }
-            std::cout << std::endl;
-            matchCount++;
+            placed[best] = true;
+            order.push_back(best);
+            estimates.push_back(std::max(bestRows, 1.0));
         }
+        std::vector<std::unique_ptr<ScanOperator>> ordered;
+        for (size_t i : order) ordered.push_back(std::move(scans[i]));
+        scans = std::move(ordered);
     }
 
-    std::cout << matchCount << " row(s) in set" << std::endl;
+    std::vector<size_t> position(joined.size());
+    for (size_t k = 0; k < order.size(); ++k) position[order[k]] = k;
+    joinConditions.assign(joined.size(), std::vector<const Condition*>());
+    for (const auto& entry : crossConditions) {
+        size_t last = 0;
+        for (size_t table : entry.second) last = std::max(last, position[table]);
+        joinConditions[last].push_back(entry.first);
+    }
     return true;
 }
 
-bool DBMS::update(const std::string& tableName, 
+// еֵʱùϣӣÿǶѭӣ
+// йʱȽߵĴۣһֻмʱǶѭʡȥϣ
+std::unique_ptr<Operator> DBMS::joinScans(Session& session, std::vector<std::unique_ptr<ScanOperator>> scans,
+                                          const std::vector<std::vector<const Condition*>>& joinConditions,
+                                          const std::vector<double>& estimates) {
+    std::unique_ptr<Operator> root = std::move(scans[0]);
+    std::string error;
+    for (size_t i = 1; i < scans.size(); ++i) {
+        Table schema = joinSchema(root->schema(), scans[i]->schema());
+        TableLayout layout(schema);
+        std::vector<JoinKey> keys;
+        std::vector<const Condition*> rest;
+        for (const Condition* condition : joinConditions[i]) {
+            size_t a = 0, b = 0;
+            std::string ignored;
+            bool isKey = false;
+            if (condition->kind == Condition::COMPARE && condition->isColumn && condition->op == CompareOp::EQ) {
+                if (resolveColumn(root->schema(), condition->column, a, ignored) &&
+                    resolveColumn(scans[i]->schema(), condition->value, b, ignored)) {
+                    isKey = true;
+                } else if (resolveColumn(root->schema(), condition->value, a, ignored) &&
+                           resolveColumn(scans[i]->schema(), condition->column, b, ignored)) {
+                    isKey = true;
+                }
+                isKey = isKey && root->layout().types[a] == scans[i]->layout().types[b];
+            }
+            if (isKey) {
+                keys.push_back({a, b});
+            } else {
+                rest.push_back(condition);
+            }
+        }
+        if (!keys.empty() && !estimates.empty()) {
+            double left = estimates[i - 1], right = static_cast<double>(scans[i]->estimatedRows());
+            uint32_t leftSize = root->layout().rowSize, rightSize = scans[i]->layout().rowSize;
+            if (nestedLoopCost(left, right, leftSize, rightSize, workMemory) <
+                hashJoinCost(left, right, leftSize, rightSize, workMemory)) {
+                keys.clear();
+                rest = joinConditions[i];
+            }
+        }
+
+        Predicate residual;
+        if (!residual.compile(rest, schema, layout, error)) {
+            session.out << "Error: " << error << std::endl;
+            return nullptr;
+        }
+        const std::string& dbName = session.currentDB;
+        if (!keys.empty()) {
+            root.reset(new HashJoin(std::move(root), std::move(scans[i]), keys, residual, dbName, workMemory));
+        } else {
+            root.reset(new NestedLoopJoin(std::move(root), std::move(scans[i]), residual, dbName, workMemory));
+        }
+        if (!estimates.empty()) root->setEstimatedRows(std::llround(estimates[i]));
+    }
+    return root;
+}
+
+bool DBMS::update(Session& session,
+                 const std::string& tableName,
                  const std::string& setClause, 
-                 const std::string& whereClause) {
-    if (currentDB.empty()) {
-        std::cout << "Error: No database selected." << std::endl;
+                 const Condition* where) {
+    updateCount++;
+    if (session.currentDB.empty()) {
+        session.out << "Error: No database selected." << std::endl;
         return false;
     }
 
-    if (!tableExists(tableName)) {
-        std::cout << "Error: Table '" << tableName << "' does not exist." << std::endl;
+    std::shared_lock<std::shared_mutex> tableGuard(tableLock(session.currentDB, tableName));
+    std::shared_lock<std::shared_mutex> lock(engineMutex);
+    if (!tableExists(session.currentDB, tableName)) {
+        session.out << "Error: Table '" << tableName << "' does not exist." << std::endl;
         return false;
     }
 
-    // ȡм¼
-    std::vector<std::vector<std::string>> records = readRecords(tableName);
-    const Table& table = tables[currentDB + "." + tableName];
+    const Table& table = *findTable(session.currentDB, tableName);
+    TableLayout layout(table);
+
+    const Catalog& catalog = databases.at(session.currentDB);
+
+    //  WHERE Ϊν
+    Predicate predicate;
+    std::string error;
+    if (!predicate.compile(where, table, layout, error)) {
+        session.out << "Error: " << error << std::endl;
+        return false;
+    }
 
-    //  SET Ӿ
-    std::vector<std::pair<std::string, std::string>> setValues;
-    std::vector<std::string> setParts = splitString(setClause, ',');
-    for (const auto& setPart : setParts) {
+    //  SET Ӿ䣬ֵԤȱ뵽һģ
+    std::vector<size_t> setColumns;
+    std::vector<char> newValues(layout.rowSize, 0);
+    std::vector<std::string_view> setParts;
+    splitValues(setClause, ',', setParts);
+    for (std::string_view setPart : setParts) {
         size_t eqPos = setPart.find('=');
-        if (eqPos != std::string::npos) {
-            std::string colName = setPart.substr(0, eqPos);
-            std::string value = setPart.substr(eqPos + 1);
-            // ȥǰո
-            colName.erase(0, colName.find_first_not_of(" \t"));
-            colName.erase(colName.find_last_not_of(" \t") + 1);
-            value.erase(0, value.find_first_not_of(" \t"));
-            value.erase(value.find_last_not_of(" \t") + 1);
-            // ȥֵ
-            if (!value.empty() && value.front() == '\'' && value.back() == '\'') {
-                value = value.substr(1, value.length() - 2);
-            }
-            setValues.push_back({colName, value});
-        }
-    }
-
-    // ȡе
-    std::map<std::string, size_t> columnIndices;
-    for (size_t i = 0; i < table.columns.size(); ++i) {
-        columnIndices[table.columns[i].name] = i;
-    }
-
-    // ¼¼
-    int updatedCount = 0;
-    for (auto& record : records) {
-        if (evaluateCondition(record, whereClause, columnIndices)) {
-            for (const auto& setValue : setValues) {
-                auto it = columnIndices.find(setValue.first);
-                if (it != columnIndices.end()) {
-                    record[it->second] = setValue.second;
-                }
+        if (eqPos != std::string_view::npos) {
+            std::string colName(trimBlank(setPart.substr(0, eqPos)));
+            std::string_view value = setPart.substr(eqPos + 1);
+
+            size_t col;
+            if (!catalog.columnIndex(tableName, colName, col)) {
+                session.out << "Error: Unknown column '" << colName << "'" << std::endl;
+                return false;
+            }
+            if (!encodeField(layout, col, value, newValues.data(), error)) {
+                session.out << "Error: " << error << " for column '" << colName << "'" << std::endl;
+                return false;
             }
-            updatedCount++;
+            setColumns.push_back(col);
         }
     }
 
-    // дļ
-    std::string tablePath = getTablePath(tableName);
-    std::ofstream file(tablePath);
-    if (!file) {
-        std::cout << "Error: Failed to write back to table file." << std::endl;
+    // ҳȫҪµУٽɰ汾д°汾°汾ٱƥ䵽
+    std::string tablePath = getTablePath(session.currentDB, tableName);
+    std::unique_lock<TableLatch> latch(tableLatch(session.currentDB, tableName));
+    FreeSpaceMap& space = freeSpace(session.currentDB, tableName);
+    ZoneMap& zones = zoneMap(session.currentDB, table);
+    Statement statement(*this, session);
+    if (!statement.isValid()) {
+        session.out << "Error: Failed to write transaction clock" << std::endl;
         return false;
     }
-
-    for (const auto& record : records) {
-        for (size_t i = 0; i < record.size(); ++i) {
-            if (i > 0) file << ",";
-            file << record[i];
-        }
-        file << std::endl;
+    std::vector<RID> rids;
+    if (!collectTargets(session, statement, table, layout, predicate, rids)) return false;
+
+    // °汾дھɰ汾ҳĿλУֻ޸漰ҳҳûпλʱдпλҳβ
+    // ɰ汾Ŀɰ汾ʱɾ°汾жĿ
+    size_t updatedCount = rids.size();
+    std::unique_ptr<BulkLoader> loader;
+    if (updatedCount >= layout.slotsPerPage) {
+        loader.reset(new BulkLoader(bufferPool, statement.getWal(), statement.getId(), tablePath,
+                                    tableName + ".table", layout, space, zones, bulkIndexes(session.currentDB, table),
+                                    statement.stamp()));
+    }
+    std::vector<char> newRow(layout.rowSize);
+    bool written = true;
+    bool read = visitRows(tablePath, layout, Predicate(), statement.getSnapshot(), rids,
+        [&](PageRef& page, RID rid) {
+            if (!written) return false;
+            std::memcpy(newRow.data(), page.slotData(rid.slot), layout.rowSize);
+            for (size_t col : setColumns) {
+                std::memcpy(newRow.data() + layout.offsets[col],
+                            newValues.data() + layout.offsets[col], layout.widths[col]);
+            }
+            RID newRid = rid;
+            int slot = page.findFreeSlot();
+            if (slot >= 0) {
+                newRid.slot = static_cast<uint16_t>(slot);
+                std::memcpy(page.slotData(slot), newRow.data(), layout.rowSize);
+                page.version(slot) = {statement.stamp(), 0};
+                page.setUsed(slot, true);
+                space.update(rid.page, page.slotCount() - page.usedCount());
+                zones.add(rid.page, newRow.data());
+            } else if (loader) {
+                written = loader->add(newRow.data());
+            } else {
+                written = writeRecord(tablePath, layout, space, zones, newRow.data(), statement.stamp(), newRid);
+            }
+            if (!written) return false;
+            if (!loader || slot >= 0) {
+                updateIndexes(session.currentDB, table, layout, nullptr, newRow.data(), newRid);
+                statement.wrote(tableName, newRid.page, false);
+            }
+            page.version(rid.slot).end = statement.stamp();
+            statement.wrote(tableName, rid.page, true);
+            return true;
+        });
+    if (!read) {
+        session.out << "Error: Failed to read table '" << tableName << "'" << std::endl;
+        return false;
+    }
+    if (loader) {
+        written = loader->finish() && written;
+        for (uint32_t p : loader->writtenPages()) statement.wrote(tableName, p, false);
+    }
+    if (!written) {
+        session.out << "Error: Failed to write record" << std::endl;
+        return false;
+    }
+    if (!statement.commit()) {
+        session.out << "Error: Failed to write log" << std::endl;
+        return false;
     }
 
-    std::cout << updatedCount << " row(s) updated." << std::endl;
+    tableStats(session.currentDB, tableName).addRows(0, updatedCount, 0);
+    session.out << updatedCount << " row(s) updated." << std::endl;
     return true;
 }
 
-bool DBMS::deleteFrom(const std::string& tableName, const std::string& whereClause) {
-    if (currentDB.empty()) {
-        std::cout << "Error: No database selected." << std::endl;
+bool DBMS::deleteFrom(Session& session, const std::string& tableName, const Condition* where) {
+    deleteCount++;
+    if (session.currentDB.empty()) {
+        session.out << "Error: No database selected." << std::endl;
         return false;
     }
 
-    if (!tableExists(tableName)) {
-        std::cout << "Error: Table '" << tableName << "' does not exist." << std::endl;
+    std::shared_lock<std::shared_mutex> tableGuard(tableLock(session.currentDB, tableName));
+    std::shared_lock<std::shared_mutex> lock(engineMutex);
+    if (!tableExists(session.currentDB, tableName)) {
+        session.out << "Error: Table '" << tableName << "' does not exist." << std::endl;
         return false;
     }
 
-    // ȡм¼
-    std::vector<std::vector<std::string>> records = readRecords(tableName);
-    const Table& table = tables[currentDB + "." + tableName];
+    const Table& table = *findTable(session.currentDB, tableName);
+    TableLayout layout(table);
 
-    // ȡе
-    std::map<std::string, size_t> columnIndices;
-    for (size_t i = 0; i < table.columns.size(); ++i) {
-        columnIndices[table.columns[i].name] = i;
+    //  WHERE Ϊν
+    Predicate predicate;
+    std::string error;
+    if (!predicate.compile(where, table, layout, error)) {
+        session.out << "Error: " << error << std::endl;
+        return false;
     }
 
-    // Ҫɾļ¼
-    std::vector<std::vector<std::string>> remainingRecords;
-    int deletedCount = 0;
-
-    for (const auto& record : records) {
-        if (!evaluateCondition(record, whereClause, columnIndices)) {
-            remainingRecords.push_back(record);
-        } else {
-            deletedCount++;
-        }
+    // ֻƥİ汾дϽʱλĿûпܿð汾ɺ̨
+    std::unique_lock<TableLatch> latch(tableLatch(session.currentDB, tableName));
+    zoneMap(session.currentDB, table);
+    Statement statement(*this, session);
+    if (!statement.isValid()) {
+        session.out << "Error: Failed to write transaction clock" << std::endl;
+        return false;
     }
-
-    // дļ
-    std::string tablePath = getTablePath(tableName);
-    std::ofstream file(tablePath);
-    if (!file) {
-        std::cout << "Error: Failed to write back to table file." << std::endl;
+    std::vector<RID> rids;
+    if (!collectTargets(session, statement, table, layout, predicate, rids)) return false;
+    size_t deletedCount = rids.size();
+    bool read = visitRows(getTablePath(session.currentDB, tableName), layout, Predicate(), statement.getSnapshot(),
+        rids, [&](PageRef& page, RID rid) {
+            page.version(rid.slot).end = statement.stamp();
+            statement.wrote(tableName, rid.page, true);
+            return true;
+        });
+    if (!read) {
+        session.out << "Error: Failed to read table '" << tableName << "'" << std::endl;
         return false;
     }
-
-    for (const auto& record : remainingRecords) {
-        for (size_t i = 0; i < record.size(); ++i) {
-            if (i > 0) file << ",";
-            file << record[i];
-        }
-        file << std::endl;
+    if (!statement.commit()) {
+        session.out << "Error: Failed to write log" << std::endl;
+        return false;
     }
 
-    std::cout << deletedCount << " row(s) deleted." << std::endl;
+    tableStats(session.currentDB, tableName).addRows(0, 0, deletedCount);
+    session.out << deletedCount << " row(s) deleted." << std::endl;
     return true;
 }
 
-// 
-std::string DBMS::getTablePath(const std::string& tableName) const {
-    return currentDB + "/" + tableName + ".table";
+// Ԥ
+std::unique_ptr<PreparedStatement> DBMS::prepare(Session& session, const std::string& sql) {
+    std::shared_ptr<const ParsedStatement> statement = parsePrepared(session, sql);
+    if (!statement) return nullptr;
+    return std::unique_ptr<PreparedStatement>(new PreparedStatement(*this, statement));
 }
 
-bool DBMS::tableExists(const std::string& tableName) const {
-    return tables.find(currentDB + "." + tableName) != tables.end();
+bool DBMS::prepareStatement(Session& session, const std::string& name, const std::string& sql) {
+    std::shared_ptr<const ParsedStatement> statement = parsePrepared(session, sql);
+    if (!statement) return false;
+    session.prepared[name] = statement;
+    session.out << "Statement prepared." << std::endl;
+    return true;
 }
 
-void DBMS::loadTables() {
-    tables.clear();
-    if (currentDB.empty()) return;
-
-    for (const auto& entry : std::filesystem::directory_iterator(currentDB)) {
-        std::string path = entry.path().string();
-        if (path.length() >= 6 && path.substr(path.length() - 6) == ".table") {
-            std::string tableName = entry.path().stem().string();
-            Table table = loadTableInfo(tableName);
-            tables[currentDB + "." + tableName] = table;
-            if (std::find(databases[currentDB].begin(), databases[currentDB].end(), tableName) 
-                == databases[currentDB].end()) {
-                databases[currentDB].push_back(tableName);
-            }
-        }
+bool DBMS::executeStatement(Session& session, const std::string& name, const std::vector<std::string>& params) {
+    auto it = session.prepared.find(name);
+    if (it == session.prepared.end()) {
+        session.out << "Error: Unknown prepared statement '" << name << "'" << std::endl;
+        return false;
     }
+    // ִڼܱ DEALLOCATEȳһ
+    std::shared_ptr<const ParsedStatement> statement = it->second;
+    return executePrepared(session, *statement, params);
 }
 
-void DBMS::saveTableInfo(const Table& table) {
-    if (currentDB.empty()) return;
-
-    std::string infoPath = currentDB + "/" + table.name + ".table.info";
-    std::ofstream infoFile(infoPath);
-    if (!infoFile) return;
-
-    for (const auto& column : table.columns) {
-        infoFile << column.name << " "
-                << (column.type == ColumnType::INT ? "INT" : "CHAR") << " "
-                << column.size << std::endl;
+bool DBMS::deallocateStatement(Session& session, const std::string& name) {
+    if (session.prepared.erase(name) == 0) {
+        session.out << "Error: Unknown prepared statement '" << name << "'" << std::endl;
+        return false;
     }
+    session.out << "Statement deallocated." << std::endl;
+    return true;
 }
 
-Table DBMS::loadTableInfo(const std::string& tableName) {
-    Table table;
-    table.name = tableName;
+bool DBMS::executePrepared(Session& session, const ParsedStatement& statement,
+                           const std::vector<std::string>& params) {
+    if (statement.kind == ParsedStatement::SELECT) {
+        std::unique_ptr<Cursor> cursor = queryPrepared(session, statement, params);
+        if (!cursor) return false;
+        printResult(*cursor, session.out);
+        return cursor->error().empty();
+    }
+    if (!checkParams(session, statement, params)) return false;
+    // ˳ţֵб SET Ӿеģ WHERE е
+    size_t next = 0;
+    std::unique_ptr<Condition> where(statement.where ? statement.where->bind(params) : nullptr);
+    switch (statement.kind) {
+    case ParsedStatement::INSERT: {
+        std::vector<std::string> rows;
+        rows.reserve(statement.rows.size());
+        for (const auto& row : statement.rows) rows.push_back(ParsedStatement::bindText(row, params, next));
+        return insertRows(session, statement.tables, statement.columns, rows);
+    }
+    case ParsedStatement::UPDATE:
+        return update(session, statement.tables, ParsedStatement::bindText(statement.assignments, params, next),
+                      where.get());
+    case ParsedStatement::DELETE:
+        return deleteFrom(session, statement.tables, where.get());
+    default:
+        return false;
+    }
+}
 
-    std::string infoPath = currentDB + "/" + tableName + ".table.info";
-    std::ifstream infoFile(infoPath);
-    if (!infoFile) return table;
+// 򵥲ѯûкźνʣֻṹı½
+std::unique_ptr<Cursor> DBMS::queryPrepared(Session& session, const ParsedStatement& statement,
+                                            const std::vector<std::string>& params) {
+    if (!checkParams(session, statement, params)) return nullptr;
+    if (!statement.simple) {
+        std::unique_ptr<Condition> where(statement.where ? statement.where->bind(params) : nullptr);
+        return openCursor(session, statement.tables, statement.columns, where.get(), statement.groupBy,
+                          statement.orderBy, statement.limit, statement.offset);
+    }
+    selectCount++;
+    if (session.currentDB.empty()) {
+        session.out << "Error: No database selected." << std::endl;
+        return nullptr;
+    }
 
-    std::string line;
-    while (std::getline(infoFile, line)) {
-        std::istringstream iss(line);
-        Column col;
-        std::string typeStr;
-        iss >> col.name >> typeStr >> col.size;
-        col.type = (typeStr == "INT" ? ColumnType::INT : ColumnType::CHAR);
-        table.columns.push_back(col);
+    const std::string& tableName = statement.tables;
+    std::vector<std::shared_lock<std::shared_mutex>> tableGuards;
+    tableGuards.emplace_back(tableLock(session.currentDB, tableName));
+    std::shared_lock<std::shared_mutex> lock(engineMutex);
+    if (!tableExists(session.currentDB, tableName)) {
+        session.out << "Error: Table '" << tableName << "' does not exist." << std::endl;
+        return nullptr;
     }
 
-    return table;
+    const Table& table = *findTable(session.currentDB, tableName);
+    std::string error;
+    std::shared_ptr<const ScanPlan> plan = statement.plan();
+    if (!plan || plan->database != session.currentDB || plan->schemaVersion != schemaVersion) {
+        std::shared_ptr<ScanPlan> fresh(new ScanPlan());
+        fresh->database = session.currentDB;
+        fresh->schemaVersion = schemaVersion;
+        if (!resolveScan(table, statement.columns, statement.where.get(), fresh->projection, fresh->predicate,
+                         error)) {
+            session.out << "Error: " << error << std::endl;
+            return nullptr;
+        }
+        statement.setPlan(fresh);
+        plan = fresh;
+    }
+    Predicate predicate = plan->predicate;
+    if (!predicate.bind(params, error)) {
+        session.out << "Error: " << error << std::endl;
+        return nullptr;
+    }
+    return openTableCursor(session, std::move(tableGuards), table, predicate, plan->projection,
+                           statement.limit, statement.offset);
 }
 
-std::vector<std::string> DBMS::splitString(const std::string& str, char delimiter) const {
-    std::vector<std::string> result;
-    std::istringstream iss(str);
-    std::string token;
+// ֻһɾĲ䣬Ͷ﷨֮ǰ;ܾʱִκ
+std::shared_ptr<const ParsedStatement> DBMS::parsePrepared(Session& session, const std::string& sql) {
+    std::string key = normalizeSql(sql);
+    std::shared_ptr<const ParsedStatement> cached = planCache.find(key);
+    if (cached) return cached;
 
-    while (std::getline(iss, token, delimiter)) {
-        // ȥǰո
-        token.erase(0, token.find_first_not_of(" \t"));
-        token.erase(token.find_last_not_of(" \t") + 1);
-        result.push_back(token);
+    std::string verb;
+    for (size_t i = 0; i < key.size() && std::isalpha(static_cast<unsigned char>(key[i])); ++i) {
+        verb += static_cast<char>(std::toupper(static_cast<unsigned char>(key[i])));
+    }
+    if (verb != "SELECT" && verb != "INSERT" && verb != "UPDATE" && verb != "DELETE") {
+        session.out << "Error: Only SELECT, INSERT, UPDATE and DELETE statements can be prepared" << std::endl;
+        return nullptr;
+    }
+    bool quoted = false;
+    for (char c : key) {
+        if (c == '\'') quoted = !quoted;
+        if (c == ';' && !quoted) {
+            session.out << "Error: Only one statement can be prepared at a time" << std::endl;
+            return nullptr;
+        }
     }
 
-    return result;
+    std::shared_ptr<ParsedStatement> statement(new ParsedStatement());
+    if (!parseStatement(*this, session, key, *statement)) return nullptr;
+    if (statement->kind == ParsedStatement::SELECT) {
+        bool aggregated = false;
+        for (const auto& item : splitString(statement->columns, ',')) {
+            AggregateFunc func;
+            std::string argument;
+            aggregated = aggregated || parseAggregate(item, func, argument);
+        }
+        statement->simple = statement->tables.find(',') == std::string::npos && statement->groupBy.empty() &&
+                            statement->orderBy.empty() && !aggregated;
+    }
+    planCache.insert(key, statement);
+    return statement;
+}
+
+bool DBMS::checkParams(Session& session, const ParsedStatement& statement, const std::vector<std::string>& params) {
+    if (params.size() != statement.paramCount) {
+        session.out << "Error: Statement expects " << statement.paramCount << " parameter(s), got "
+                    << params.size() << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < params.size(); ++i) {
+        if (params[i].empty()) {
+            session.out << "Error: Parameter " << i + 1 << " is not bound" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// ִмƻͳ
+bool DBMS::explain(Session& session, bool analyze,
+                   const std::string& tableName,
+                   const std::string& columnList,
+                   const Condition* where,
+                   const std::string& groupBy,
+                   const std::string& orderBy,
+                   int64_t limit, int64_t offset) {
+    // ֻ EXPLAIN ANALYZE ִвѯ Com_select
+    if (analyze) selectCount++;
+    std::unique_ptr<Cursor> cursor = buildCursor(session, tableName, columnList, where, groupBy, orderBy, limit, offset);
+    if (!cursor) return false;
+    if (!analyze) {
+        cursor->explain(session.out, false);
+        return true;
+    }
+
+    cursor->enableTiming();
+    auto start = std::chrono::steady_clock::now();
+    ResultRow row;
+    uint64_t rows = 0;
+    while (cursor->next(row)) rows++;
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (!cursor->error().empty()) {
+        session.out << "Error: " << cursor->error() << std::endl;
+        return false;
+    }
+    cursor->explain(session.out, true);
+    char time[32];
+    std::snprintf(time, sizeof(time), "%.3f", elapsed);
+    session.out << rows << " row(s), execution time: " << time << " ms" << std::endl;
+    return true;
+}
+
+// еͳƱѯĸʽͬ
+static void printStatusRows(std::ostream& out, const std::vector<std::pair<std::string, uint64_t>>& rows) {
+    out << std::left << std::setw(28) << "Variable_name" << "Value" << std::endl;
+    out << "-------------------------------------------" << std::endl;
+    for (const auto& row : rows) {
+        out << std::setw(28) << row.first << row.second << std::endl;
+    }
+    out << std::right << rows.size() << " row(s) in set" << std::endl;
+}
+
+void DBMS::showStatus(Session& session) {
+    std::vector<std::pair<std::string, uint64_t>> rows = {
+        {"Com_select", selectCount},
+        {"Com_insert", insertCount},
+        {"Com_update", updateCount},
+        {"Com_delete", deleteCount},
+        {"Com_commit", commitCount},
+        {"Com_rollback", rollbackCount},
+        {"Seq_scans", totalStats.seqScans},
+        {"Index_scans", totalStats.indexScans},
+        {"Rows_scanned", totalStats.rowsScanned},
+        {"Rows_returned", totalStats.rowsReturned},
+        {"Rows_inserted", totalStats.rowsInserted},
+        {"Rows_updated", totalStats.rowsUpdated},
+        {"Rows_deleted", totalStats.rowsDeleted},
+        {"Scan_pages_read", totalStats.pagesRead},
+        {"Scan_pool_hits", totalStats.poolHits},
+        {"Buffer_pool_pages", bufferPool.capacity()},
+        {"Buffer_pool_hits", bufferPool.hits()},
+        {"Buffer_pool_misses", bufferPool.misses()},
+        {"Buffer_pool_mapped_reads", bufferPool.mappedReads()},
+        {"Buffer_pool_evictions", bufferPool.evictions()},
+        {"Buffer_pool_pages_written", bufferPool.pagesWritten()},
+        {"Plan_cache_entries", planCache.size()},
+        {"Plan_cache_hits", planCache.hits()},
+        {"Plan_cache_misses", planCache.misses()},
+    };
+    printStatusRows(session.out, rows);
+}
+
+void DBMS::showTableStatus(Session& session) {
+    std::vector<std::string> tableNames;
+    {
+        std::shared_lock<std::shared_mutex> lock(engineMutex);
+        auto db = databases.find(session.currentDB);
+        if (db == databases.end()) {
+            session.out << "Error: No database selected." << std::endl;
+            return;
+        }
+        tableNames = db->second.tableNames();
+    }
+
+    static const char* const HEADERS[] = {"Name", "Format", "Pages", "Data_length", "Seq_scans", "Index_scans",
+                                          "Rows_scanned", "Rows_returned", "Rows_inserted", "Rows_updated",
+                                          "Rows_deleted", "Pages_read", "Pool_hits"};
+    std::ostream& out = session.out;
+    out << std::left;
+    for (const char* header : HEADERS) out << std::setw(15) << header;
+    out << std::endl;
+    for (size_t i = 0; i < sizeof(HEADERS) / sizeof(HEADERS[0]); ++i) out << "---------------";
+    out << std::endl;
+    for (const auto& name : tableNames) {
+        const TableStats& stats = tableStats(session.currentDB, name);
+        std::string path = getTablePath(session.currentDB, name);
+        std::error_code ec;
+        uintmax_t bytes = std::filesystem::file_size(path, ec);
+        out << std::setw(15) << name << std::setw(15) << (isCompressedFile(path) ? "Compressed" : "Fixed")
+            << std::setw(15) << bufferPool.pageCount(path) << std::setw(15) << (ec ? 0 : bytes);
+        for (const auto* counter : {&stats.seqScans, &stats.indexScans, &stats.rowsScanned, &stats.rowsReturned,
+                                    &stats.rowsInserted, &stats.rowsUpdated, &stats.rowsDeleted, &stats.pagesRead,
+                                    &stats.poolHits}) {
+            out << std::setw(15) << counter->load();
+        }
+        out << std::endl;
+    }
+    out << std::right << tableNames.size() << " row(s) in set" << std::endl;
+}
+
+// 
+bool DBMS::beginTransaction(Session& session) {
+    if (session.currentDB.empty()) {
+        session.out << "Error: No database selected." << std::endl;
+        return false;
+    }
+    if (session.transaction) {
+        session.out << "Error: A transaction is already in progress." << std::endl;
+        return false;
+    }
+
+    std::shared_lock<std::shared_mutex> lock(engineMutex);
+    TransactionManager& manager = transactions(session.currentDB);
+    std::unique_ptr<Transaction> transaction(new Transaction());
+    if (!manager.beginTransaction(transaction->id)) {
+        session.out << "Error: Failed to write transaction clock" << std::endl;
+        return false;
+    }
+    transaction->database = session.currentDB;
+    transaction->snapshot = manager.openSnapshot(transaction->id);
+    session.transaction = std::move(transaction);
+    session.out << "Transaction started." << std::endl;
+    return true;
+}
+
+bool DBMS::commitTransaction(Session& session) {
+    if (!session.transaction) {
+        session.out << "Error: No transaction in progress." << std::endl;
+        return false;
+    }
+    if (!finishTransaction(session, true)) return false;
+    commitCount++;
+    session.out << "Transaction committed." << std::endl;
+    return true;
+}
+
+bool DBMS::rollbackTransaction(Session& session) {
+    if (!session.transaction) {
+        session.out << "Error: No transaction in progress." << std::endl;
+        return false;
+    }
+    if (!finishTransaction(session, false)) return false;
+    rollbackCount++;
+    session.out << "Transaction rolled back." << std::endl;
+    return true;
+}
+
+void DBMS::closeSession(Session& session) {
+    if (session.transaction) finishTransaction(session, false);
+}
+
+// ύʱŻύʱعʱɾдİ汾ָİ汾
+// 漰бһ־ɣҪôȫЧҪôȫ
+bool DBMS::finishTransaction(Session& session, bool commit) {
+    Transaction& transaction = *session.transaction;
+    const std::string& dbName = transaction.database;
+
+    // ˳ɾݿʱ˳һ
+    std::vector<std::shared_lock<std::shared_mutex>> tableGuards;
+    for (const auto& entry : transaction.writes) {
+        tableGuards.emplace_back(tableLock(dbName, entry.first));
+    }
+    std::shared_lock<std::shared_mutex> lock(engineMutex);
+    std::vector<std::unique_lock<TableLatch>> latches;
+    for (const auto& entry : transaction.writes) {
+        latches.emplace_back(tableLatch(dbName, entry.first));
+    }
+
+    TransactionManager& manager = transactions(dbName);
+    uint64_t timestamp = 0;
+    if (commit && !manager.beginCommit(timestamp)) {
+        session.out << "Error: Failed to write transaction clock" << std::endl;
+        return false;
+    }
+    // عͷŵĲλпռ
+    std::map<std::string, FreeSpaceMap*> spaces;
+    if (!commit) {
+        for (const auto& entry : transaction.writes) {
+            if (findTable(dbName, entry.first)) spaces[entry.first] = &freeSpace(dbName, entry.first);
+        }
+    }
+    bool logged;
+    {
+        Statement statement(*this, dbName);
+        for (const auto& entry : transaction.writes) {
+            const Table* table = findTable(dbName, entry.first);
+            if (!table) continue;
+            TableLayout layout(*table);
+            std::string tablePath = getTablePath(dbName, entry.first);
+            std::set<uint32_t> ended;
+            for (uint32_t p : entry.second) {
+                char* data = bufferPool.fetchPage(tablePath, p);
+                if (!data) continue;
+                PageRef page(data, layout);
+                bool dirty = false;
+                for (uint32_t s = 0; page.isValid() && s < page.slotCount(); ++s) {
+                    if (!page.isUsed(s)) continue;
+                    RowVersion& version = page.version(s);
+                    if (version.begin == transaction.id) {
+                        dirty = true;
+                        if (commit) {
+                            version.begin = timestamp;
+                        } else {
+                            RID rid = {p, static_cast<uint16_t>(s)};
+                            updateIndexes(dbName, *table, layout, page.slotData(s), nullptr, rid);
+                            page.setUsed(s, false);
+                            version = RowVersion();
+                        }
+                    }
+                    if (version.end == transaction.id) {
+                        dirty = true;
+                        version.end = commit ? timestamp : 0;
+                        if (commit) ended.insert(p);
+                    }
+                }
+                if (!commit && page.isValid()) spaces[entry.first]->update(p, page.slotCount() - page.usedCount());
+                bufferPool.unpinPage(tablePath, p, dirty);
+            }
+            manager.addGarbage(entry.first, ended);
+        }
+        logged = statement.commit();
+    }
+    if (commit) manager.finishCommit(timestamp);
+    manager.endTransaction(transaction.id);
+    session.transaction.reset();
+    if (manager.garbagePages() >= VACUUM_GARBAGE_PAGES) requestVacuum();
+
+    if (!logged) {
+        session.out << "Error: Failed to write log" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<const Snapshot> DBMS::readSnapshot(Session& session) {
+    if (session.transaction) return session.transaction->snapshot;
+    return transactions(session.currentDB).openSnapshot();
+}
+
+bool DBMS::checkNoTransaction(Session& session, const char* statement) {
+    if (!session.transaction) return true;
+    session.out << "Error: " << statement << " is not allowed inside a transaction." << std::endl;
+    return false;
+}
+
+// ҳҪ޸ĵУѱ֮ύĻδ޸ʱͻκ޸
+bool DBMS::collectTargets(Session& session, const Statement& statement, const Table& table,
+                          const TableLayout& layout, const Predicate& predicate, std::vector<RID>& rids) {
+    TransactionManager& manager = transactions(session.currentDB);
+    bool conflict = false;
+    bool read = forEachMatch(session.currentDB, table, layout, predicate, statement.getSnapshot(),
+        [&](PageRef& page, RID rid) {
+            // ǰδµΪѻعԸ
+            uint64_t end = page.version(rid.slot).end;
+            if (end != 0 && !(isTransactionId(end) && !manager.isActive(end))) conflict = true;
+            rids.push_back(rid);
+            return false;
+        });
+    if (!read) {
+        session.out << "Error: Failed to read table '" << table.name << "'" << std::endl;
+        return false;
+    }
+    if (conflict) {
+        session.out << "Error: Rows in table '" << table.name
+                    << "' were modified by a concurrent transaction." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void DBMS::requestVacuum() {
+    std::lock_guard<std::mutex> lock(checkpointMutex);
+    vacuumRequested = true;
+    vacuumWake.notify_one();
+}
+
+// ̨̣߳ʱҳʱվɰ汾
+void DBMS::vacuumLoop() {
+    std::unique_lock<std::mutex> lock(checkpointMutex);
+    while (!stopping) {
+        vacuumWake.wait_for(lock, std::chrono::seconds(VACUUM_INTERVAL_SECONDS),
+                            [this] { return stopping || vacuumRequested; });
+        if (stopping) break;
+        vacuumRequested = false;
+        lock.unlock();
+        std::vector<std::string> dbNames;
+        {
+            std::shared_lock<std::shared_mutex> engineLock(engineMutex);
+            for (const auto& entry : transactionManagers) {
+                if (entry.second->garbagePages() > 0) dbNames.push_back(entry.first);
+            }
+        }
+        for (const auto& dbName : dbNames) vacuumDatabase(dbName);
+        lock.lock();
+    }
+}
+
+// սʱпյİ汾ѻعµİ汾ɾǵĿ
+// пܿİ汾ڵҳŻشбвλı
+void DBMS::vacuumDatabase(const std::string& dbName) {
+    std::map<std::string, std::set<uint32_t>> garbage;
+    {
+        std::shared_lock<std::shared_mutex> lock(engineMutex);
+        auto it = transactionManagers.find(dbName);
+        if (it == transactionManagers.end()) return;
+        garbage = it->second->takeGarbage();
+    }
+
+    std::vector<std::string> sparse;
+    for (const auto& entry : garbage) {
+        std::shared_lock<std::shared_mutex> tableGuard(tableLock(dbName, entry.first));
+        std::shared_lock<std::shared_mutex> lock(engineMutex);
+        auto it = transactionManagers.find(dbName);
+        const Table* table = findTable(dbName, entry.first);
+        if (it == transactionManagers.end() || !table) continue;
+        std::unique_lock<TableLatch> latch(tableLatch(dbName, entry.first));
+        std::set<uint32_t> remaining;
+        reclaimVersions(dbName, *table, *it->second, entry.second, remaining);
+        it->second->addGarbage(entry.first, remaining);
+
+        uint32_t pageCount = bufferPool.pageCount(getTablePath(dbName, entry.first));
+        uint64_t slots = static_cast<uint64_t>(pageCount) * TableLayout(*table).slotsPerPage;
+        if (autoCompact && pageCount >= COMPACT_MIN_PAGES &&
+            freeSpace(dbName, entry.first).freeSlots() > COMPACT_FREE_RATIO * slots) {
+            sparse.push_back(entry.first);
+        }
+    }
+
+    // ҪƶУֱûнеĲѯδдñʱ
+    for (const auto& tableName : sparse) {
+        std::unique_lock<std::shared_mutex> tableGuard(tableLock(dbName, tableName));
+        std::unique_lock<std::shared_mutex> lock(engineMutex);
+        auto it = transactionManagers.find(dbName);
+        const Table* table = findTable(dbName, tableName);
+        if (it == transactionManagers.end() || !table || it->second->hasPendingWrites(tableName)) continue;
+        compactTable(dbName, *table);
+    }
+}
+
+size_t DBMS::reclaimVersions(const std::string& dbName, const Table& table, TransactionManager& manager,
+                             const std::set<uint32_t>& pages, std::set<uint32_t>& remaining) {
+    TableLayout layout(table);
+    std::string tablePath = getTablePath(dbName, table.name);
+    FreeSpaceMap& space = freeSpace(dbName, table.name);
+    uint32_t pageCount = bufferPool.pageCount(tablePath);
+    uint64_t oldest = manager.oldestSnapshot();
+    size_t reclaimed = 0;
+    Statement statement(*this, dbName);
+    for (uint32_t p : pages) {
+        // ض̱ļбпܻѲڵҳ
+        if (p >= pageCount) break;
+        char* data = bufferPool.fetchPage(tablePath, p);
+        if (!data) continue;
+        PageRef page(data, layout);
+        bool dirty = false;
+        for (uint32_t s = 0; page.isValid() && s < page.slotCount(); ++s) {
+            if (!page.isUsed(s)) continue;
+            RowVersion& version = page.version(s);
+            if (isTransactionId(version.end) && !manager.isActive(version.end)) {
+                version.end = 0;
+                dirty = true;
+            }
+            bool aborted = isTransactionId(version.begin) && !manager.isActive(version.begin);
+            bool expired = version.end != 0 && !isTransactionId(version.end) && version.end <= oldest;
+            if (aborted || expired) {
+                RID rid = {p, static_cast<uint16_t>(s)};
+                updateIndexes(dbName, table, layout, page.slotData(s), nullptr, rid);
+                page.setUsed(s, false);
+                version = RowVersion();
+                dirty = true;
+                reclaimed++;
+            } else if (version.end != 0) {
+                remaining.insert(p);
+            }
+        }
+        if (dirty) space.update(p, page.slotCount() - page.usedCount());
+        bufferPool.unpinPage(tablePath, p, dirty);
+    }
+    statement.commit();
+    return reclaimed;
+}
+
+// ӱβҳͬ汾ϢҳŸСҳĿλƿյҳΪֹٽض̱ļ
+// ƶ־ضǰ㣬־вѽصҳ
+uint32_t DBMS::compactTable(const std::string& dbName, const Table& table) {
+    TableLayout layout(table);
+    std::string tablePath = getTablePath(dbName, table.name);
+    std::unique_lock<TableLatch> latch(tableLatch(dbName, table.name));
+    FreeSpaceMap& space = freeSpace(dbName, table.name);
+    uint32_t pageCount = bufferPool.pageCount(tablePath);
+    uint32_t end = pageCount;
+    std::set<uint32_t> ended;
+    {
+        Statement statement(*this, dbName);
+        char* target = nullptr;
+        uint32_t targetNo = 0;
+        bool targetDirty = false;
+        bool full = false;
+        while (!full && end > 0) {
+            uint32_t source = end - 1;
+            char* data = bufferPool.fetchPage(tablePath, source);
+            if (!data) break;
+            PageRef from(data, layout);
+            bool dirty = false;
+            for (uint32_t s = 0; from.isValid() && s < from.slotCount() && !full; ++s) {
+                if (!from.isUsed(s)) continue;
+                // ҳűȵǰҳСпλҳ
+                int slot = -1;
+                while (slot < 0) {
+                    // Ƶ뵱ǰҳͬҳʱƿ
+                    if (target && targetNo >= source) {
+                        bufferPool.unpinPage(tablePath, targetNo, targetDirty);
+                        target = nullptr;
+                    }
+                    if (!target) {
+                        if (!space.findPage(targetNo) || targetNo >= source) break;
+                        target = bufferPool.fetchPage(tablePath, targetNo);
+                        if (!target) break;
+                        targetDirty = false;
+                    }
+                    PageRef to(target, layout);
+                    if (to.isValid()) slot = to.findFreeSlot();
+                    if (slot < 0) {
+                        space.update(targetNo, 0);
+                        bufferPool.unpinPage(tablePath, targetNo, targetDirty);
+                        target = nullptr;
+                    }
+                }
+                if (slot < 0) {
+                    full = true;
+                    break;
+                }
+                PageRef to(target, layout);
+                RID oldRid = {source, static_cast<uint16_t>(s)};
+                RID newRid = {targetNo, static_cast<uint16_t>(slot)};
+                std::memcpy(to.slotData(slot), from.slotData(s), layout.rowSize);
+                to.version(slot) = from.version(s);
+                to.setUsed(slot, true);
+                targetDirty = true;
+                space.update(targetNo, to.slotCount() - to.usedCount());
+                if (to.version(slot).end != 0) ended.insert(targetNo);
+                updateIndexes(dbName, table, layout, from.slotData(s), nullptr, oldRid);
+                updateIndexes(dbName, table, layout, nullptr, to.slotData(slot), newRid);
+                from.setUsed(s, false);
+                from.version(s) = RowVersion();
+                dirty = true;
+            }
+            bufferPool.unpinPage(tablePath, source, dirty);
+            if (!full) end = source;
+        }
+        if (target) bufferPool.unpinPage(tablePath, targetNo, targetDirty);
+        if (!statement.commit()) return 0;
+    }
+    // Ƶ飬ͳ´ʹʱɨ轨ͬʱխɾֵµķΧ
+    // Ҫڼ֮ǰɾᱣ治еķΧ
+    dropZoneMap(dbName, table.name);
+    transactions(dbName).addGarbage(table.name, ended);
+    if (end == pageCount || !checkpointLocked()) return 0;
+
+    bufferPool.dropFile(tablePath);
+    bool truncated = TableFile(tablePath).truncate(end);
+    dropFreeSpace(dbName, table.name);
+    return truncated ? pageCount - end : 0;
+}
+
+bool DBMS::vacuumTable(Session& session, const std::string& tableName) {
+    if (session.currentDB.empty()) {
+        session.out << "Error: No database selected." << std::endl;
+        return false;
+    }
+    if (!checkNoTransaction(session, "VACUUM")) return false;
+
+    std::unique_lock<std::shared_mutex> tableGuard(tableLock(session.currentDB, tableName));
+    std::unique_lock<std::shared_mutex> lock(engineMutex);
+    const Table* table = findTable(session.currentDB, tableName);
+    if (!table) {
+        session.out << "Error: Table '" << tableName << "' does not exist." << std::endl;
+        return false;
+    }
+
+    TransactionManager& manager = transactions(session.currentDB);
+    std::set<uint32_t> pages, remaining;
+    uint32_t pageCount = bufferPool.pageCount(getTablePath(session.currentDB, tableName));
+    for (uint32_t p = 0; p < pageCount; ++p) pages.insert(p);
+    size_t reclaimed;
+    {
+        std::unique_lock<TableLatch> latch(tableLatch(session.currentDB, tableName));
+        reclaimed = reclaimVersions(session.currentDB, *table, manager, pages, remaining);
+    }
+    manager.addGarbage(tableName, remaining);
+    // δдñʱֻհ汾ƶ
+    uint32_t released = manager.hasPendingWrites(tableName) ? 0 : compactTable(session.currentDB, *table);
+
+    session.out << "Table '" << tableName << "' vacuumed: " << reclaimed << " row version(s) removed, "
+                << released << " page(s) released." << std::endl;
+    return true;
+}
+
+bool DBMS::compressTable(Session& session, const std::string& tableName, bool compressed) {
+    if (session.currentDB.empty()) {
+        session.out << "Error: No database selected." << std::endl;
+        return false;
+    }
+    if (!checkNoTransaction(session, "ALTER TABLE")) return false;
+
+    std::unique_lock<std::shared_mutex> tableGuard(tableLock(session.currentDB, tableName));
+    std::unique_lock<std::shared_mutex> lock(engineMutex);
+    const Table* table = findTable(session.currentDB, tableName);
+    if (!table) {
+        session.out << "Error: Table '" << tableName << "' does not exist." << std::endl;
+        return false;
+    }
+
+    // ҳźҳݲ䣬־иñļ¼תȻֻȰҳд
+    std::string tablePath = getTablePath(session.currentDB, tableName);
+    if (!bufferPool.flushFile(tablePath)) {
+        session.out << "Error: Failed to write table '" << tableName << "'" << std::endl;
+        return false;
+    }
+    bufferPool.dropFile(tablePath);
+    if (!convertPageFile(tablePath, *table, compressed)) {
+        session.out << "Error: Failed to convert table file '" << tablePath << "'" << std::endl;
+        return false;
+    }
+    std::error_code ec;
+    uintmax_t bytes = std::filesystem::file_size(tablePath, ec);
+    session.out << "Table '" << tableName << "' " << (compressed ? "compressed" : "decompressed") << ": "
+                << bufferPool.pageCount(tablePath) << " page(s), " << (ec ? 0 : bytes) << " byte(s) on disk."
+                << std::endl;
+    return true;
+}
+
+// ɨһˮس ANALYZE_SAMPLE_ROWS Уеͳ
+// ӹ̶ݲʱÿεõͬͳ
+bool DBMS::analyzeTable(Session& session, const std::string& tableName) {
+    if (session.currentDB.empty()) {
+        session.out << "Error: No database selected." << std::endl;
+        return false;
+    }
+
+    std::shared_lock<std::shared_mutex> tableGuard(tableLock(session.currentDB, tableName));
+    std::shared_lock<std::shared_mutex> lock(engineMutex);
+    const Table* table = findTable(session.currentDB, tableName);
+    if (!table) {
+        session.out << "Error: Table '" << tableName << "' does not exist." << std::endl;
+        return false;
+    }
+
+    TableLayout layout(*table);
+    std::string tablePath = getTablePath(session.currentDB, tableName);
+    ReadView view;
+    view.snapshot = readSnapshot(session);
+    view.latch = &tableLatch(session.currentDB, tableName);
+    uint32_t pageCount = bufferPool.pageCount(tablePath);
+    std::vector<char> sample;
+    uint64_t total = 0;
+    {
+        ScanOperator scan(bufferPool, tablePath, *table, view, Predicate(), false, {}, "", scanWorkers.get());
+        std::mt19937_64 random;
+        while (const char* row = scan.next()) {
+            if (total < ANALYZE_SAMPLE_ROWS) {
+                sample.insert(sample.end(), row, row + layout.rowSize);
+            } else {
+                uint64_t k = random() % (total + 1);
+                if (k < ANALYZE_SAMPLE_ROWS) std::memcpy(&sample[k * layout.rowSize], row, layout.rowSize);
+            }
+            total++;
+        }
+        if (!scan.error().empty()) {
+            session.out << "Error: " << scan.error() << std::endl;
+            return false;
+        }
+    }
+
+    std::shared_ptr<const TableStatistics> statistics(
+        new TableStatistics(TableStatistics::build(layout, sample, total, pageCount)));
+    if (!statistics->save(TableStatistics::filePath(tablePath), layout)) {
+        session.out << "Error: Failed to write statistics for table '" << tableName << "'" << std::endl;
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> guard(tableLocksMutex);
+        analyzedTables[session.currentDB + "." + tableName] = statistics;
+    }
+
+    std::ostream& out = session.out;
+    out << std::left << std::setw(15) << "Column" << std::setw(15) << "Type" << std::setw(15) << "Distinct"
+        << std::setw(15) << "Min" << "Max" << std::endl;
+    out << "---------------------------------------------------------------------------" << std::endl;
+    for (size_t i = 0; i < table->columns.size(); ++i) {
+        const Column& column = table->columns[i];
+        const ColumnStatistics& stats = statistics->columns[i];
+        std::string type = "INT", low, high;
+        if (column.type == ColumnType::INT) {
+            if (!stats.ints.empty()) {
+                low = std::to_string(stats.ints.front());
+                high = std::to_string(stats.ints.back());
+            }
+        } else {
+            type = "CHAR(" + std::to_string(column.size) + ")";
+            if (!stats.chars.empty()) {
+                low = stats.chars.front();
+                high = stats.chars.back();
+            }
+        }
+        out << std::setw(15) << column.name << std::setw(15) << type
+            << std::setw(15) << static_cast<uint64_t>(stats.distinct + 0.5) << std::setw(15) << low << high
+            << std::endl;
+    }
+    out << std::right << "Table '" << tableName << "' analyzed: " << total << " row(s) in " << pageCount
+        << " page(s), " << sample.size() / layout.rowSize << " row(s) sampled." << std::endl;
+    return true;
+}
+
+// Ԥд־
+DBMS::Statement::Statement(DBMS& dbms, const std::string& dbName) : dbms(dbms), dbName(dbName) {
+    wal = dbms.getWal(dbName);
+    id = wal->beginStatement();
+    dbms.bufferPool.beginCapture(id);
+}
+
+DBMS::Statement::Statement(DBMS& dbms, Session& session) : Statement(dbms, session.currentDB) {
+    manager = &dbms.transactions(session.currentDB);
+    transaction = session.transaction.get();
+    if (transaction) {
+        snapshot = *transaction->snapshot;
+        return;
+    }
+    // Զύֱύʱд룬ȡʱܿύ
+    valid = manager->beginCommit(commitTimestamp);
+    snapshot.timestamp = commitTimestamp - 1;
+    snapshot.writer = commitTimestamp;
+}
+
+DBMS::Statement::~Statement() {
+    abort();
+}
+
+void DBMS::Statement::wrote(const std::string& tableName, uint32_t pageNo, bool ended) {
+    if (transaction) {
+        std::set<uint32_t>& pages = transaction->writes[tableName];
+        if (pages.empty()) manager->noteWrite(transaction->id, tableName);
+        pages.insert(pageNo);
+    } else if (ended) {
+        garbage[tableName].insert(pageNo);
+    }
+}
+
+bool DBMS::Statement::commit() {
+    if (done) return true;
+    done = true;
+    dbms.bufferPool.endCapture();
+    bool logged = wal->commit(id);
+    if (commitTimestamp != 0) {
+        for (const auto& entry : garbage) manager->addGarbage(entry.first, entry.second);
+        manager->finishCommit(commitTimestamp);
+        if (manager->garbagePages() >= VACUUM_GARBAGE_PAGES) dbms.requestVacuum();
+    }
+    if (!logged) return false;
+    if (wal->size() > CHECKPOINT_LOG_BYTES) {
+        std::lock_guard<std::mutex> lock(dbms.checkpointMutex);
+        dbms.checkpointRequested = true;
+        dbms.checkpointWake.notify_one();
+    }
+    return true;
+}
+
+// ر־¼ָ޸ǰֽڣ׷ӵҳ(ɨʱЧҳ)
+// ͬд־дύ¼ָʱԭ޸ĺͳûִͬ
+// ύ¼ǰͬһ𱻳
+void DBMS::Statement::abort() {
+    if (done) return;
+    done = true;
+    dbms.bufferPool.endCapture();
+    std::string log;
+    std::vector<WriteAheadLog::Change> changes;
+    if (wal->readStatement(id, log, changes) && !changes.empty()) {
+        BufferPool& pool = dbms.bufferPool;
+        pool.beginCapture(id);
+        for (auto it = changes.rbegin(); it != changes.rend(); ++it) {
+            std::string path = dbName + "/" + it->fileName;
+            uint32_t last = it->extend ? pool.pageCount(path) : it->pageNo + 1;
+            for (uint32_t p = it->pageNo; p < last; ++p) {
+                char* data = pool.fetchPage(path, p);
+                if (!data) continue;
+                if (it->extend) std::memset(data, 0, PAGE_SIZE);
+                for (const auto& run : it->runs) {
+                    if (run.offset + run.length <= PAGE_SIZE) std::memcpy(data + run.offset, run.before, run.length);
+                }
+                pool.unpinPage(path, p, true);
+            }
+        }
+        pool.endCapture();
+        wal->commit(id);
+    }
+    // дİ汾ѳʱκҳ
+    if (commitTimestamp != 0) manager->abortCommit(commitTimestamp);
+}
+
+WriteAheadLog* DBMS::getWal(const std::string& dbName) {
+    std::lock_guard<std::mutex> lock(walMutex);
+    auto it = wals.find(dbName);
+    if (it == wals.end()) {
+        it = wals.emplace(dbName, std::unique_ptr<WriteAheadLog>(
+            new WriteAheadLog(dbName + "/wal.log"))).first;
+    }
+    return it->second.get();
+}
+
+// ʱطϴδ־
+void DBMS::recoverDatabase(const std::string& dbName) {
+    std::string logPath = dbName + "/wal.log";
+    std::error_code ec;
+    bool logged = std::filesystem::exists(logPath, ec) && std::filesystem::file_size(logPath, ec) > 0;
+    // ϴʱļ־ϴμ֮дʱͳѹڣʹʱ½
+    for (const auto& entry : std::filesystem::directory_iterator(dbName, ec)) {
+        std::string extension = entry.path().extension().string();
+        if (extension == ".spill" || (logged && extension == ".zone")) std::filesystem::remove(entry.path(), ec);
+    }
+    if (!logged) return;
+
+    int replayed = WriteAheadLog::replay(dbName, logPath);
+    if (replayed < 0) {
+        std::cout << "Warning: Failed to recover database '" << dbName << "'." << std::endl;
+        return;
+    }
+    std::ofstream(logPath, std::ios::binary | std::ios::trunc);
+    if (replayed > 0) {
+        std::cout << "Database '" << dbName << "' recovered " << replayed << " statement(s)." << std::endl;
+    }
+}
+
+// ڲʱѳ engineMutex 
+bool DBMS::checkpointLocked() {
+    bool ok = bufferPool.flushAll() && bufferPool.syncAll();
+    if (!ok) return false;
+    // ͳ־棬󲻻ȱ־ееͳ
+    {
+        std::lock_guard<std::mutex> lock(tableLocksMutex);
+        for (auto& entry : zoneMaps) ok = entry.second.save() && ok;
+    }
+    if (!ok) return false;
+    std::lock_guard<std::mutex> lock(walMutex);
+    for (auto& wal : wals) {
+        ok = wal.second->truncate() && ok;
+    }
+    return ok;
+}
+
+// ̨̣߳ʱ־ʱִ
+void DBMS::checkpointLoop() {
+    std::unique_lock<std::mutex> lock(checkpointMutex);
+    while (!stopping) {
+        checkpointWake.wait_for(lock, std::chrono::seconds(CHECKPOINT_INTERVAL_SECONDS),
+                                [this] { return stopping || checkpointRequested; });
+        if (stopping) break;
+        checkpointRequested = false;
+        lock.unlock();
+        {
+            std::unique_lock<std::shared_mutex> engineLock(engineMutex);
+            checkpointLocked();
+        }
+        lock.lock();
+    }
+}
+
+void DBMS::logPageChange(uint64_t statement, const std::string& path, uint32_t pageNo,
+                         const char* before, const char* after) {
+    size_t slash = path.find('/');
+    getWal(path.substr(0, slash))->logPageChange(statement, path.substr(slash + 1), pageNo, before, after);
+}
+
+void DBMS::flushLog(const std::string& path) {
+    getWal(path.substr(0, path.find('/')))->flush();
+}
+
+// 
+std::shared_mutex& DBMS::tableLock(const std::string& dbName, const std::string& tableName) {
+    std::lock_guard<std::mutex> lock(tableLocksMutex);
+    return tableLocks[dbName + "." + tableName];
+}
+
+TableLatch& DBMS::tableLatch(const std::string& dbName, const std::string& tableName) {
+    std::lock_guard<std::mutex> lock(tableLocksMutex);
+    return tableLatches[dbName + "." + tableName];
+}
+
+// пռ״ʹʱɨҳͷҪڿʼҳ޸֮ǰ
+FreeSpaceMap& DBMS::freeSpace(const std::string& dbName, const std::string& tableName) {
+    FreeSpaceMap* space;
+    {
+        std::lock_guard<std::mutex> lock(tableLocksMutex);
+        space = &freeSpaceMaps[dbName + "." + tableName];
+    }
+    if (!space->isLoaded()) space->load(bufferPool, getTablePath(dbName, tableName));
+    return *space;
+}
+
+void DBMS::dropFreeSpace(const std::string& dbName, const std::string& tableName) {
+    std::lock_guard<std::mutex> lock(tableLocksMutex);
+    if (!tableName.empty()) {
+        freeSpaceMaps.erase(dbName + "." + tableName);
+        return;
+    }
+    std::string prefix = dbName + ".";
+    auto it = freeSpaceMaps.lower_bound(prefix);
+    while (it != freeSpaceMaps.end() && it->first.compare(0, prefix.size(), prefix) == 0) {
+        it = freeSpaceMaps.erase(it);
+    }
+}
+
+ZoneMap& DBMS::zoneMap(const std::string& dbName, const Table& table) {
+    ZoneMap* zones;
+    {
+        std::lock_guard<std::mutex> lock(tableLocksMutex);
+        zones = &zoneMaps[dbName + "." + table.name];
+    }
+    if (!zones->isLoaded()) zones->load(bufferPool, getTablePath(dbName, table.name), TableLayout(table));
+    return *zones;
+}
+
+void DBMS::dropZoneMap(const std::string& dbName, const std::string& tableName) {
+    std::lock_guard<std::mutex> lock(tableLocksMutex);
+    if (!tableName.empty()) {
+        zoneMaps.erase(dbName + "." + tableName);
+        std::error_code ec;
+        std::filesystem::remove(ZoneMap::filePath(getTablePath(dbName, tableName)), ec);
+        return;
+    }
+    std::string prefix = dbName + ".";
+    auto it = zoneMaps.lower_bound(prefix);
+    while (it != zoneMaps.end() && it->first.compare(0, prefix.size(), prefix) == 0) {
+        it = zoneMaps.erase(it);
+    }
+}
+
+TableStats& DBMS::tableStats(const std::string& dbName, const std::string& tableName) {
+    std::lock_guard<std::mutex> lock(tableLocksMutex);
+    TableStats& stats = tableStatistics[dbName + "." + tableName];
+    if (!stats.total) stats.total = &totalStats;
+    return stats;
+}
+
+void DBMS::resetTableStats(const std::string& dbName, const std::string& tableName) {
+    std::lock_guard<std::mutex> lock(tableLocksMutex);
+    std::string prefix = tableName.empty() ? dbName + "." : dbName + "." + tableName;
+    for (auto it = tableStatistics.lower_bound(prefix);
+         it != tableStatistics.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it) {
+        if (tableName.empty() || it->first == prefix) it->second.reset();
+    }
+}
+
+// ͳļ룬ͬʱ ANALYZE дͳʱ ANALYZE Ľ
+std::shared_ptr<const TableStatistics> DBMS::analyzedStatistics(const std::string& dbName, const Table& table) {
+    std::string key = dbName + "." + table.name;
+    {
+        std::lock_guard<std::mutex> lock(tableLocksMutex);
+        auto it = analyzedTables.find(key);
+        if (it != analyzedTables.end()) return it->second;
+    }
+    std::shared_ptr<TableStatistics> loaded(new TableStatistics());
+    if (!loaded->load(TableStatistics::filePath(getTablePath(dbName, table.name)), TableLayout(table))) {
+        loaded.reset();
+    }
+    std::lock_guard<std::mutex> lock(tableLocksMutex);
+    return analyzedTables.emplace(key, loaded).first->second;
+}
+
+void DBMS::dropStatistics(const std::string& dbName, const std::string& tableName) {
+    std::lock_guard<std::mutex> lock(tableLocksMutex);
+    if (!tableName.empty()) {
+        analyzedTables.erase(dbName + "." + tableName);
+        std::error_code ec;
+        std::filesystem::remove(TableStatistics::filePath(getTablePath(dbName, tableName)), ec);
+        return;
+    }
+    std::string prefix = dbName + ".";
+    auto it = analyzedTables.lower_bound(prefix);
+    while (it != analyzedTables.end() && it->first.compare(0, prefix.size(), prefix) == 0) {
+        it = analyzedTables.erase(it);
+    }
+}
+
+// 
+std::string DBMS::getTablePath(const std::string& dbName, const std::string& tableName) const {
+    return dbName + "/" + tableName + ".table";
+}
+
+bool DBMS::tableExists(const std::string& dbName, const std::string& tableName) const {
+    auto db = databases.find(dbName);
+    return db != databases.end() && db->second.find(tableName) != nullptr;
+}
+
+Table* DBMS::findTable(const std::string& dbName, const std::string& tableName) {
+    auto db = databases.find(dbName);
+    return db == databases.end() ? nullptr : db->second.find(tableName);
+}
+
+// ṹĿ¼ӾɰǨʱıʽв汾ҳʽļתΪǰʽ
+// еλøıؽȫɺű°汾Ŀ¼;ʧʱ´ʹøÿǨ
+bool DBMS::loadTables(Session& session, const std::string& dbName) {
+    Catalog& catalog = databases.at(dbName);
+    bool migrated;
+    std::string error;
+    if (!catalog.load(migrated, error)) {
+        session.out << "Error: " << error << std::endl;
+        return false;
+    }
+    if (!migrated) return true;
+
+    for (const auto& tableName : catalog.tableNames()) {
+        const Table& table = *catalog.find(tableName);
+        std::string path = getTablePath(dbName, tableName);
+        bool upgraded = true;
+        if (std::filesystem::file_size(path) > 0 && !isPageFile(path)) {
+            if (convertTableFile(dbName, table)) {
+                std::cout << "Table '" << tableName << "' converted to page format." << std::endl;
+            } else {
+                std::cout << "Warning: Failed to convert table '" << tableName << "'." << std::endl;
+            }
+        } else if (isLegacyPageFile(path)) {
+            bufferPool.dropFile(path);
+            upgraded = upgradePageFile(path, TableLayout(table));
+        }
+        // ϴǨƿؽǰжϣؽ
+        for (const auto& index : table.indexes) {
+            size_t col;
+            if (!upgraded || !catalog.columnIndex(tableName, index.column, col)) continue;
+            upgraded = buildIndex(dbName, table, index.name, col);
+        }
+        if (!upgraded) {
+            session.out << "Error: Failed to upgrade table '" << tableName << "'." << std::endl;
+            databases.at(dbName) = Catalog(dbName);
+            return false;
+        }
+    }
+    return saveCatalog(session, dbName);
+}
+
+bool DBMS::saveCatalog(Session& session, const std::string& dbName) {
+    schemaVersion++;
+    if (databases.at(dbName).save()) return true;
+    session.out << "Error: Failed to write catalog of database '" << dbName << "'." << std::endl;
+    return false;
+}
+
+std::vector<std::string> DBMS::splitString(const std::string& str, char delimiter) const {
+    std::vector<std::string_view> fields;
+    splitFields(str, delimiter, fields);
+    return std::vector<std::string>(fields.begin(), fields.end());
+}
+
+// ȥǰո񣻿մûжΣĩβķָпն
+void DBMS::splitFields(std::string_view str, char delimiter, std::vector<std::string_view>& fields) {
+    fields.clear();
+    size_t start = 0;
+    while (start < str.size()) {
+        size_t end = str.find(delimiter, start);
+        if (end == std::string_view::npos) end = str.size();
+        fields.push_back(trimBlank(str.substr(start, end - start)));
+        start = end + 1;
+    }
+}
+
+// ÿ ' ת״̬'' תκ
+void DBMS::splitValues(std::string_view str, char delimiter, std::vector<std::string_view>& fields) {
+    fields.clear();
+    size_t start = 0;
+    bool quoted = false;
+    for (size_t i = 0; i < str.size(); ++i) {
+        if (str[i] == '\'') {
+            quoted = !quoted;
+        } else if (str[i] == delimiter && !quoted) {
+            fields.push_back(trimBlank(str.substr(start, i - start)));
+            start = i + 1;
+        }
+    }
+    if (start < str.size()) fields.push_back(trimBlank(str.substr(start)));
 }
 
 std::vector<std::string> DBMS::splitString(const std::string& str, const std::string& delimiter) const {
@@ -547,125 +2476,312 @@ std::vector<std::string> DBMS::splitString(const std::string& str, const std::st
     return result;
 }
 
-bool DBMS::writeRecord(const std::string& tableName, const std::vector<std::string>& values) {
-    std::string tablePath = getTablePath(tableName);
-    std::ofstream file(tablePath, std::ios::app);
-    if (!file) return false;
-
-    for (size_t i = 0; i < values.size(); ++i) {
-        if (i > 0) file << ",";
-        file << values[i];
+bool DBMS::writeRecord(const std::string& tablePath, const TableLayout& layout, FreeSpaceMap& freeSpace,
+                       ZoneMap& zones, const char* row, uint64_t stamp, RID& rid) {
+    // дҳСпвλҳ׷ҳ
+    uint32_t pageNo = 0;
+    char* data = nullptr;
+    int slot = -1;
+    while (slot < 0 && freeSpace.findPage(pageNo)) {
+        data = bufferPool.fetchPage(tablePath, pageNo);
+        if (!data) return false;
+        PageRef page(data, layout);
+        if (page.isValid()) slot = page.findFreeSlot();
+        if (slot < 0) {
+            bufferPool.unpinPage(tablePath, pageNo, false);
+            freeSpace.update(pageNo, 0);
+        }
     }
-    file << std::endl;
+    if (slot < 0) {
+        data = bufferPool.newPage(tablePath, pageNo);
+        if (!data) return false;
+        PageRef(data, layout).init();
+        slot = 0;
+    }
+
+    PageRef page(data, layout);
+    std::memcpy(page.slotData(slot), row, layout.rowSize);
+    page.setUsed(slot, true);
+    page.version(slot) = {stamp, 0};
+    freeSpace.update(pageNo, page.slotCount() - page.usedCount());
+    zones.add(pageNo, row);
+    bufferPool.unpinPage(tablePath, pageNo, true);
+    rid.page = pageNo;
+    rid.slot = static_cast<uint16_t>(slot);
     return true;
 }
 
-std::vector<std::vector<std::string>> DBMS::readRecords(const std::string& tableName) {
-    std::vector<std::vector<std::string>> records;
-    std::string tablePath = getTablePath(tableName);
-    std::ifstream file(tablePath);
-    if (!file) return records;
+std::string DBMS::getIndexPath(const std::string& dbName, const std::string& tableName,
+                               const std::string& indexName) const {
+    return dbName + "/" + tableName + "." + indexName + ".idx";
+}
 
-    std::string line;
-    while (std::getline(file, line)) {
-        if (line.empty()) continue;
-        records.push_back(splitString(line, ','));
-    }
-
-    return records;
-}
-
-bool DBMS::evaluateCondition(const std::vector<std::string>& record,
-                           const std::string& condition,
-                           const std::map<std::string, size_t>& columnIndices) {
-    if (condition.empty()) {
-        return true;  // ûƥм¼
-    }
-
-    // 
-    std::vector<std::string> andConditions = splitString(condition, " AND ");
-    bool result = true;
-
-    for (const auto& andCondition : andConditions) {
-        bool orResult = false;
-        std::vector<std::string> orConditions = splitString(andCondition, " OR ");
-
-        for (const auto& orCondition : orConditions) {
-            // ȥźͿո
-            std::string cleanCondition = orCondition;
-            cleanCondition.erase(std::remove(cleanCondition.begin(), cleanCondition.end(), '('), cleanCondition.end());
-            cleanCondition.erase(std::remove(cleanCondition.begin(), cleanCondition.end(), ')'), cleanCondition.end());
-            cleanCondition.erase(0, cleanCondition.find_first_not_of(" \t"));
-            cleanCondition.erase(cleanCondition.find_last_not_of(" \t") + 1);
-
-            // ұȽ
-            size_t opPos = std::string::npos;
-            std::string op;
-            if ((opPos = cleanCondition.find("!=")) != std::string::npos) op = "!=";
-            else if ((opPos = cleanCondition.find("=")) != std::string::npos) op = "=";
-            else if ((opPos = cleanCondition.find(">")) != std::string::npos) op = ">";
-            else if ((opPos = cleanCondition.find("<")) != std::string::npos) op = "<";
-
-            if (opPos != std::string::npos) {
-                std::string colName = cleanCondition.substr(0, opPos);
-                std::string value = cleanCondition.substr(opPos + op.length());
-                
-                // ֵ
-                colName.erase(0, colName.find_first_not_of(" \t"));
-                colName.erase(colName.find_last_not_of(" \t") + 1);
-                value.erase(0, value.find_first_not_of(" \t"));
-                value.erase(value.find_last_not_of(" \t") + 1);
-                
-                // رַȽϣѰҴŵֵ
-                if (!value.empty()) {
-                    if (value.front() == '\'' && value.back() == '\'') {
-                        value = value.substr(1, value.length() - 2);
-                    }
-                }
+// пɼ WHERE Уʺ true ʾ޸˸ҳ
+// ÷иñ
+bool DBMS::forEachMatch(const std::string& dbName, const Table& table, const TableLayout& layout,
+                        const Predicate& predicate, const Snapshot& snapshot,
+                        const std::function<bool(PageRef&, RID)>& visit) {
+    std::string tablePath = getTablePath(dbName, table.name);
+
+    // ʹʱֻ
+    std::vector<RID> rids;
+    if (findIndexedRows(dbName, table, layout, predicate, rids)) {
+        return visitRows(tablePath, layout, predicate, snapshot, rids, visit);
+    }
 
-                auto it = columnIndices.find(colName);
-                if (it != columnIndices.end()) {
-                    size_t colIndex = it->second;
-                    if (colIndex < record.size()) {
-                        std::string recordValue = record[colIndex];
-                        if (!recordValue.empty() && recordValue.front() == '\'' && recordValue.back() == '\'') {
-                            recordValue = recordValue.substr(1, recordValue.length() - 2);
-                        }
+    // ̳߳زҳеУڱ߳зʣͳƱûеĿ
+    const ZoneMap* zones = predicate.empty() ? nullptr : &zoneMap(dbName, table);
+    uint32_t pageCount = bufferPool.pageCount(tablePath);
+    if (ScanOperator::parallelizable(scanWorkers.get(), pageCount)) {
+        ReadView view;
+        view.snapshot = std::make_shared<Snapshot>(snapshot);
+        ScanOperator scan(bufferPool, tablePath, table, view, predicate, false, {}, "", scanWorkers.get());
+        scan.setZoneMap(zones);
+        if (!scan.collectRids(rids)) return false;
+        return visitRows(tablePath, layout, Predicate(), snapshot, rids, visit);
+    }
 
-                        // Ƚֵ
-                        bool compareResult = false;
-                        if (op == "=") {
-                            compareResult = (recordValue == value);
-                        } else if (op == "!=") {
-                            compareResult = (recordValue != value);
-                        } else if (op == ">") {
-                            // ֵȽ
-                            try {
-                                int recordNum = std::stoi(recordValue);
-                                int valueNum = std::stoi(value);
-                                compareResult = (recordNum > valueNum);
-                            } catch (...) {
-                                compareResult = (recordValue > value);
-                            }
-                        } else if (op == "<") {
-                            // ֵȽ
-                            try {
-                                int recordNum = std::stoi(recordValue);
-                                int valueNum = std::stoi(value);
-                                compareResult = (recordNum < valueNum);
-                            } catch (...) {
-                                compareResult = (recordValue < value);
-                            }
-                        }
+    // ȫɨ
+    for (uint32_t p = 0; p < pageCount; ++p) {
+        if (zones && !zones->mayMatch(p, predicate)) continue;
+        char* data = bufferPool.fetchPage(tablePath, p);
+        if (!data) return false;
+        PageRef page(data, layout);
+        bool dirty = false;
+        if (page.isValid()) {
+            for (uint32_t s = 0; s < page.slotCount(); ++s) {
+                if (!page.isUsed(s) || !snapshot.visible(page.version(s))) continue;
+                if (!predicate.evaluate(page.slotData(s))) continue;
+                RID rid = {p, static_cast<uint16_t>(s)};
+                dirty = visit(page, rid) || dirty;
+            }
+        }
+        bufferPool.unpinPage(tablePath, p, dirty);
+    }
+    return true;
+}
 
-                        orResult = orResult || compareResult;
-                    }
+//  RID УȰҳԱÿҳֻȡһ
+bool DBMS::visitRows(const std::string& tablePath, const TableLayout& layout,
+                     const Predicate& predicate, const Snapshot& snapshot, std::vector<RID>& rids,
+                     const std::function<bool(PageRef&, RID)>& visit) {
+    std::sort(rids.begin(), rids.end(), [](const RID& a, const RID& b) {
+        return a.page != b.page ? a.page < b.page : a.slot < b.slot;
+    });
+    size_t i = 0;
+    while (i < rids.size()) {
+        uint32_t p = rids[i].page;
+        char* data = bufferPool.fetchPage(tablePath, p);
+        if (!data) return false;
+        bool dirty = false;
+        for (; i < rids.size() && rids[i].page == p; ++i) {
+            PageRef page(data, layout);
+            if (!page.isValid() || rids[i].slot >= page.slotCount() || !page.isUsed(rids[i].slot)) continue;
+            if (!snapshot.visible(page.version(rids[i].slot))) continue;
+            if (!predicate.evaluate(page.slotData(rids[i].slot))) continue;
+            dirty = visit(page, rids[i]) || dirty;
+        }
+        bufferPool.unpinPage(tablePath, p, dirty);
+    }
+    return true;
+}
+
+//  col ʱõνʵѡʣеֵνʱֻõһ > ͵һ <
+//  findIndexedRows ҼĹͬ
+static double indexSelectivity(const TableStatistics& statistics,
+                               const std::vector<const Predicate::Node*>& conjuncts, size_t col) {
+    double below = -1, above = -1;
+    for (const auto* node : conjuncts) {
+        if (node->column != col || node->op == CompareOp::NE) continue;
+        if (node->kind == Predicate::Node::CMP_CHAR && node->charValue.size() > node->width) continue;
+        double s = statistics.compareSelectivity(*node);
+        if (node->op == CompareOp::EQ) return s;
+        if (node->op == CompareOp::LT && below < 0) below = s;
+        if (node->op == CompareOp::GT && above < 0) above = s;
+    }
+    if (below >= 0 && above >= 0) return std::max(below + above - 1, 0.0);
+    return below >= 0 ? below : above;
+}
+
+// Ӷ AND ҳ =<> νʲ
+//  ANALYZE ͳʱȽϸȫɨĹƴۣȫɨʱ false
+// ûͳʱѡֵνʣǷΧν
+bool DBMS::findIndexedRows(const std::string& dbName, const Table& table, const TableLayout& layout,
+                           const Predicate& predicate, std::vector<RID>& rids) {
+    if (predicate.empty() || table.indexes.empty()) return false;
+
+    std::vector<const Predicate::Node*> conjuncts;
+    predicate.conjuncts(conjuncts);
+
+    std::shared_ptr<const TableStatistics> statistics = analyzedStatistics(dbName, table);
+    uint32_t pageCount = statistics ? bufferPool.pageCount(getTablePath(dbName, table.name)) : 0;
+    double rows = statistics ? statistics->estimatedRows(pageCount) : 0;
+    double bestCost = seqScanCost(pageCount, rows);
+    const IndexInfo* chosen = nullptr;
+    size_t chosenCol = 0;
+    bool chosenEq = false;
+    for (const auto& index : table.indexes) {
+        for (const auto* node : conjuncts) {
+            if (node->op == CompareOp::NE || table.columns[node->column].name != index.column) continue;
+            if (node->kind == Predicate::Node::CMP_CHAR && node->charValue.size() > node->width) continue;
+            if (statistics) {
+                double cost = indexScanCost(pageCount, rows * indexSelectivity(*statistics, conjuncts, node->column));
+                if (cost < bestCost) {
+                    chosen = &index;
+                    chosenCol = node->column;
+                    bestCost = cost;
                 }
+                continue;
+            }
+            bool eq = (node->op == CompareOp::EQ);
+            if (!chosen || (eq && !chosenEq)) {
+                chosen = &index;
+                chosenCol = node->column;
+                chosenEq = eq;
             }
         }
+    }
+    if (!chosen) return false;
+
+    BTree tree(bufferPool, getIndexPath(dbName, table.name, chosen->name));
+    if (!tree.isValid()) return false;
+
+    // пΪ
+    std::vector<char> lowKey(layout.widths[chosenCol], 0);
+    std::vector<char> highKey(layout.widths[chosenCol], 0);
+    const char* low = nullptr;
+    const char* high = nullptr;
+    bool lowInclusive = false;
+    bool highInclusive = false;
+    for (const auto* node : conjuncts) {
+        if (node->column != chosenCol || node->op == CompareOp::NE) continue;
+        if (node->kind == Predicate::Node::CMP_CHAR && node->charValue.size() > node->width) continue;
+        // ͬνԻϸˣȡһ߽缴
+        std::vector<char>& key = (node->op == CompareOp::LT) ? highKey : lowKey;
+        if (node->op == CompareOp::GT && low) continue;
+        if (node->op == CompareOp::LT && high) continue;
+        if (node->kind == Predicate::Node::CMP_INT) {
+            std::memcpy(key.data(), &node->intValue, sizeof(node->intValue));
+        } else {
+            std::fill(key.begin(), key.end(), 0);
+            std::memcpy(key.data(), node->charValue.data(), node->charValue.size());
+        }
+        if (node->op == CompareOp::EQ) {
+            low = high = lowKey.data();
+            lowInclusive = highInclusive = true;
+            break;
+        }
+        if (node->op == CompareOp::GT) low = lowKey.data();
+        if (node->op == CompareOp::LT) high = highKey.data();
+    }
+    tree.search(low, lowInclusive, high, highInclusive, rids);
+    return true;
+}
 
-        result = result && orResult;
+// ͬάoldRow Ϊձʾ룬newRow Ϊձʾɾ
+void DBMS::updateIndexes(const std::string& dbName, const Table& table, const TableLayout& layout,
+                         const char* oldRow, const char* newRow, RID rid) {
+    for (const auto& index : table.indexes) {
+        size_t col = 0;
+        while (col < table.columns.size() && table.columns[col].name != index.column) ++col;
+        if (col == table.columns.size()) continue;
+
+        uint32_t offset = layout.offsets[col];
+        if (oldRow && newRow && std::memcmp(oldRow + offset, newRow + offset, layout.widths[col]) == 0) {
+            continue;  // δ仯
+        }
+        BTree tree(bufferPool, getIndexPath(dbName, table.name, index.name));
+        if (oldRow) tree.remove(oldRow + offset, rid);
+        if (newRow) tree.insert(newRow + offset, rid);
     }
+}
 
+// дʱҪάļ
+std::vector<BulkIndex> DBMS::bulkIndexes(const std::string& dbName, const Table& table) {
+    std::vector<BulkIndex> result;
+    for (const auto& index : table.indexes) {
+        size_t col = 0;
+        while (col < table.columns.size() && table.columns[col].name != index.column) ++col;
+        if (col == table.columns.size()) continue;
+        result.push_back({getIndexPath(dbName, table.name, index.name), col});
+    }
     return result;
+}
+
+// ɨеа汾ɰ汾Ŀʱɾ
+bool DBMS::buildIndex(const std::string& dbName, const Table& table, const std::string& indexName, size_t col) {
+    TableLayout layout(table);
+    std::string indexPath = getIndexPath(dbName, table.name, indexName);
+    bufferPool.dropFile(indexPath);
+    if (!BTree::create(indexPath, layout.types[col], layout.widths[col])) return false;
+
+    BTree tree(bufferPool, indexPath);
+    if (!tree.isValid()) return false;
+    std::string tablePath = getTablePath(dbName, table.name);
+    uint32_t pageCount = bufferPool.pageCount(tablePath);
+    for (uint32_t p = 0; p < pageCount; ++p) {
+        char* data = bufferPool.fetchPage(tablePath, p);
+        if (!data) return false;
+        PageRef page(data, layout);
+        bool ok = true;
+        if (page.isValid()) {
+            for (uint32_t s = 0; s < page.slotCount() && ok; ++s) {
+                if (!page.isUsed(s)) continue;
+                RID rid = {p, static_cast<uint16_t>(s)};
+                ok = tree.insert(page.slotData(s) + layout.offsets[col], rid);
+            }
+        }
+        bufferPool.unpinPage(tablePath, p, false);
+        if (!ok) return false;
+    }
+    // д־ֱӽļ
+    return bufferPool.flushFile(indexPath);
+}
+
+// ɰ涺ŷָıתΪҳʽ
+bool DBMS::convertTableFile(const std::string& dbName, const Table& table) {
+    std::string tablePath = getTablePath(dbName, table.name);
+    std::string tempPath = tablePath + ".tmp";
+    TableLayout layout(table);
+    if (layout.slotsPerPage == 0) return false;
+
+    std::ifstream in(tablePath);
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!in || !out) return false;
+
+    std::vector<char> buffer(PAGE_SIZE);
+    PageRef page(buffer.data(), layout);
+    page.init();
+    uint32_t slot = 0;
+    std::string line;
+    std::vector<std::string_view> values;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        splitFields(line, ',', values);
+        char* row = page.slotData(slot);
+        for (size_t i = 0; i < values.size() && i < layout.types.size(); ++i) {
+            std::string error;
+            if (!encodeField(layout, i, values[i], row, error)) {
+                std::cout << "Warning: " << error << " in table '" << table.name
+                          << "', column '" << table.columns[i].name << "'" << std::endl;
+            }
+        }
+        page.setUsed(slot, true);
+        if (++slot == layout.slotsPerPage) {
+            out.write(buffer.data(), PAGE_SIZE);
+            page.init();
+            slot = 0;
+        }
+    }
+    if (slot > 0) {
+        out.write(buffer.data(), PAGE_SIZE);
+    }
+    in.close();
+    out.close();
+    if (!out) return false;
+
+    bufferPool.dropFile(tablePath);
+    std::filesystem::rename(tempPath, tablePath);
+    return true;
 }
\ No newline at end of file
@@ -9,76 +9,363 @@
 #include <filesystem>
 #include <sstream>
 #include <iomanip>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <set>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include "Schema.h"
+#include "Storage.h"
+#include "BufferPool.h"
+#include "BTree.h"
+#include "Predicate.h"
+#include "ColumnBatch.h"
+#include "Cursor.h"
+#include "Operator.h"
+#include "Join.h"
+#include "Aggregate.h"
+#include "Sort.h"
+#include "Catalog.h"
+#include "BulkLoader.h"
+#include "FreeSpaceMap.h"
+#include "ZoneMap.h"
+#include "Statistics.h"
+#include "WriteAheadLog.h"
+#include "Transaction.h"
+#include "PlanCache.h"
+#include "Arena.h"
 
-// е
-enum class ColumnType {
-    INT,
-    CHAR
-};
+// ־ôСʱɺ̨߳ǰ
+const uint64_t CHECKPOINT_LOG_BYTES = 16 * 1024 * 1024;
+const int CHECKPOINT_INTERVAL_SECONDS = 30;
+// ҳʱɺ̨߳ǰɰ汾
+const size_t VACUUM_GARBAGE_PAGES = 1024;
+const int VACUUM_INTERVAL_SECONDS = 10;
+// ̨вλñҲ COMPACT_MIN_PAGES ҳıԶ
+const double COMPACT_FREE_RATIO = 0.5;
+const uint32_t COMPACT_MIN_PAGES = 64;
+// ƻ汣
+const size_t PLAN_CACHE_ENTRIES = 256;
 
-// еĽṹ
-struct Column {
-    std::string name;
-    ColumnType type;
-    int size;  //  CHAR ʹ
-};
+// ͻ˻Ựÿһ¼ǰݿ⡢еԤͽλ
+struct Session {
+    std::string currentDB;
+    std::ostream& out;
+    std::unique_ptr<Transaction> transaction;
+    std::map<std::string, std::shared_ptr<const ParsedStatement>> prepared;  // PREPARE  -> 
+    Arena arena;  // ִе﷨ıʱջ
 
-// Ľṹ
-struct Table {
-    std::string name;
-    std::vector<Column> columns;
+    explicit Session(std::ostream& out = std::cout) : out(out) {}
 };
 
-class DBMS {
+// ɱỰ߳ͬʱ
+// ˳̶ΪѯɾĳֱĹ޸ıṹֱ
+// ͨ湲޸Ŀ¼ͼ
+// д汾ʱɾֱд°汾ѯնȡÿҳֻݳ
+class DBMS : private PageLogger {
 public:
-    DBMS();
+    explicit DBMS(size_t bufferPoolBytes = DEFAULT_BUFFER_POOL_BYTES);
     ~DBMS();
 
     // ݿ
-    bool createDatabase(const std::string& name);
-    bool useDatabase(const std::string& name);
-    bool dropDatabase(const std::string& name);
-    void showDatabases();
+    bool createDatabase(Session& session, const std::string& name);
+    bool useDatabase(Session& session, const std::string& name);
+    bool dropDatabase(Session& session, const std::string& name);
+    void showDatabases(Session& session);
 
     // 
-    bool createTable(const std::string& name, const std::string& columnDefs);
-    bool dropTable(const std::string& name);
-    void showTables();
+    bool createTable(Session& session, const std::string& name, const std::string& columnDefs);
+    bool dropTable(Session& session, const std::string& name);
+    void showTables(Session& session);
+
+    // 
+    bool createIndex(Session& session,
+                    const std::string& indexName,
+                    const std::string& tableName,
+                    const std::string& columnName);
+    bool dropIndex(Session& session, const std::string& indexName, const std::string& tableName = "");
 
     // ݲ
-    bool insertInto(const std::string& tableName, 
+    bool insertInto(Session& session,
+                   const std::string& tableName,
                    const std::string& columnList = "", 
                    const std::string& valueList = "");
-    bool selectFrom(const std::string& tableName, 
-                   const std::string& columnList = "*", 
-                   const std::string& whereClause = "");
-    bool update(const std::string& tableName, 
+    // в룬ȫУͨд
+    bool insertRows(Session& session,
+                    const std::string& tableName,
+                    const std::string& columnList,
+                    const std::vector<std::string>& valueLists);
+    //  CSV ļ룬ÿֶһһӦ
+    bool loadData(Session& session, const std::string& fileName, const std::string& tableName);
+    //  SELECT α꣬ʱϢؿָ룻 Com_select
+    // αڼбĹorderBy  "col DESC,col2"limit Ϊʾ
+    std::unique_ptr<Cursor> openCursor(Session& session,
+                                       const std::string& tableName,
+                                       const std::string& columnList = "*",
+                                       const Condition* where = nullptr,
+                                       const std::string& groupBy = "",
+                                       const std::string& orderBy = "",
+                                       int64_t limit = -1,
+                                       int64_t offset = 0);
+    bool update(Session& session,
+               const std::string& tableName,
                const std::string& setClause, 
-               const std::string& whereClause = "");
-    bool deleteFrom(const std::string& tableName, 
-                   const std::string& whereClause = "");
+               const Condition* where = nullptr);
+    bool deleteFrom(Session& session,
+                   const std::string& tableName,
+                   const Condition* where = nullptr);
+
+    // BEGIN ֮乲һգ޸ COMMIT ʱһỰɼ
+    bool beginTransaction(Session& session);
+    bool commitTransaction(Session& session);
+    bool rollbackTransaction(Session& session);
+    // Ựʱعδύ
+    void closeSession(Session& session);
+    // ձвٿɼа汾ѱβǰĿλض̱ļ
+    bool vacuumTable(Session& session, const std::string& tableName);
+    // ALTER TABLE ... COMPRESS / DECOMPRESSѱļдΪѹҳ򶨳ҳеλò
+    bool compressTable(Session& session, const std::string& tableName, bool compressed);
+    // ANALYZE [TABLE] tռеĲֱֵͬͼŻѡ·˳㷨
+    bool analyzeTable(Session& session, const std::string& tableName);
+
+    // Ԥ䣺SELECTINSERTUPDATEDELETE еĳдɲ ?
+    // ﷨淶 SQL ı棬򵥲ѯִмƻ
+    std::unique_ptr<PreparedStatement> prepare(Session& session, const std::string& sql);
+    bool executePrepared(Session& session, const ParsedStatement& statement, const std::vector<std::string>& params);
+    std::unique_ptr<Cursor> queryPrepared(Session& session, const ParsedStatement& statement,
+                                          const std::vector<std::string>& params);
+    // PREPARE name FROM '...' / EXECUTE name USING ... / DEALLOCATE PREPARE name
+    bool prepareStatement(Session& session, const std::string& name, const std::string& sql);
+    bool executeStatement(Session& session, const std::string& name, const std::vector<std::string>& params);
+    bool deallocateStatement(Session& session, const std::string& name);
+
+    // EXPLAIN [ANALYZE] SELECT ...ִмƻanalyze Ϊ true ʱִвѯ()
+    // ϸʵʵʱͶȡҳ
+    bool explain(Session& session, bool analyze,
+                 const std::string& tableName,
+                 const std::string& columnList,
+                 const Condition* where,
+                 const std::string& groupBy,
+                 const std::string& orderBy,
+                 int64_t limit, int64_t offset);
+    // SHOW STATUSغͼƻļ
+    void showStatus(Session& session);
+    // SHOW TABLE STATUSǰݿۼƷͳ
+    void showTableStatus(Session& session);
+
+    // ͳ
+    const BufferPool& getBufferPool() const { return bufferPool; }
+    const PlanCache& getPlanCache() const { return planCache; }
+    // ӵӿõڴ棬ʱдʱļ
+    void setWorkMemory(size_t bytes) { workMemory = bytes; }
+    // ɨִֻ֮߳ǰ
+    void setScanThreads(size_t threads) { scanWorkers.reset(new ThreadPool(threads)); }
+    // ̨߳ǷԶƬı
+    void setAutoCompact(bool enabled) { autoCompact = enabled; }
+
+    // ҳ̲־
+    bool checkpoint();
 
 private:
-    std::string currentDB;
-    std::map<std::string, std::vector<std::string>> databases;  // ݿ -> б
-    std::map<std::string, Table> tables;  // (db.table) -> ṹ
+    // һ޸־Χʱʼҳ޸ģcommit ʱдύ¼δύʱ޸
+    // Ựеɾͬʱȷдİ汾ʱΪţύʱ
+    // ύʱż
+    class Statement {
+    public:
+        Statement(DBMS& dbms, const std::string& dbName);
+        Statement(DBMS& dbms, Session& session);
+        ~Statement();
+        bool commit();
+        // дҳύʱ
+        void abort();
+        WriteAheadLog& getWal() const { return *wal; }
+        uint64_t getId() const { return id; }
+        bool isValid() const { return valid; }
+        const Snapshot& getSnapshot() const { return snapshot; }
+        uint64_t stamp() const { return snapshot.writer; }
+        // ¼дҳended ʾҳа汾
+        void wrote(const std::string& tableName, uint32_t pageNo, bool ended);
+
+    private:
+        DBMS& dbms;
+        std::string dbName;
+        WriteAheadLog* wal;
+        uint64_t id;
+        TransactionManager* manager = nullptr;
+        Transaction* transaction = nullptr;
+        Snapshot snapshot;
+        uint64_t commitTimestamp = 0;
+        std::map<std::string, std::set<uint32_t>> garbage;
+        bool valid = true;
+        bool done = false;
+    };
+
+    std::map<std::string, Catalog> databases;  // ݿ -> ṹĿ¼״ʹʱ
+    BufferPool bufferPool;  // ݿ⹲ҳ
+    std::map<std::string, std::unique_ptr<WriteAheadLog>> wals;  // ݿ -> Ԥд־
+    std::mutex walMutex;
+    // ݿ -> 汾״̬Ŀ¼һ engineMutex 
+    std::map<std::string, std::unique_ptr<TransactionManager>> transactionManagers;
+
+    // Ŀ¼ų̳̃́߳
+    std::shared_mutex engineMutex;
+    //  -> 󴴽ɾ
+    std::map<std::string, std::shared_mutex> tableLocks;
+    std::map<std::string, TableLatch> tableLatches;
+    std::map<std::string, FreeSpaceMap> freeSpaceMaps;
+    std::map<std::string, ZoneMap> zoneMaps;  //  -> ͳƣڼʱ
+    std::map<std::string, TableStats> tableStatistics;  //  -> ۼͳƣ󴴽ɾ
+    //  -> ANALYZE ͳƣ״ʹʱ룬ûͳƵıΪָ
+    std::map<std::string, std::shared_ptr<const TableStatistics>> analyzedTables;
+    std::mutex tableLocksMutex;
+    TableStats totalStats;  // бͳ֮ͣɾʱ
+    // ִеĸ
+    std::atomic<uint64_t> selectCount{0};
+    std::atomic<uint64_t> insertCount{0};
+    std::atomic<uint64_t> updateCount{0};
+    std::atomic<uint64_t> deleteCount{0};
+    std::atomic<uint64_t> commitCount{0};
+    std::atomic<uint64_t> rollbackCount{0};
+    std::atomic<size_t> workMemory{DEFAULT_WORK_MEMORY_BYTES};
+    std::unique_ptr<ThreadPool> scanWorkers;  // ɨ̳߳
+    std::atomic<bool> autoCompact{true};
+    PlanCache planCache{PLAN_CACHE_ENTRIES};
+    uint64_t schemaVersion = 0;  // ÿ޸ıṹĿ¼һ engineMutex 
+    std::thread checkpointThread;
+    std::mutex checkpointMutex;
+    std::condition_variable checkpointWake;
+    bool checkpointRequested = false;
+    bool stopping = false;
+    std::thread vacuumThread;  // ̹߳ checkpointMutex  stopping
+    std::condition_variable vacuumWake;
+    bool vacuumRequested = false;
+
+    // Ԥд־
+    WriteAheadLog* getWal(const std::string& dbName);
+    void recoverDatabase(const std::string& dbName);
+    bool checkpointLocked();
+    void checkpointLoop();
+    void logPageChange(uint64_t statement, const std::string& path, uint32_t pageNo,
+                       const char* before, const char* after) override;
+    void flushLog(const std::string& path) override;
+
+    // 汾
+    TransactionManager& transactions(const std::string& dbName) { return *transactionManagers.at(dbName); }
+    // ĶգĿգǼһ¿
+    std::shared_ptr<const Snapshot> readSnapshot(Session& session);
+    bool checkNoTransaction(Session& session, const char* statement);
+    bool finishTransaction(Session& session, bool commit);
+    bool collectTargets(Session& session, const Statement& statement, const Table& table,
+                        const TableLayout& layout, const Predicate& predicate, std::vector<RID>& rids);
+    void requestVacuum();
+    void vacuumLoop();
+    void vacuumDatabase(const std::string& dbName);
+    // ҳеľɰ汾ػյİ汾÷б
+    size_t reclaimVersions(const std::string& dbName, const Table& table, TransactionManager& manager,
+                           const std::set<uint32_t>& pages, std::set<uint32_t>& remaining);
+    // ÷бͷŵҳ
+    uint32_t compactTable(const std::string& dbName, const Table& table);
+
+    // 
+    std::shared_mutex& tableLock(const std::string& dbName, const std::string& tableName);
+    TableLatch& tableLatch(const std::string& dbName, const std::string& tableName);
+    // Ŀпռ״ʹʱ÷б
+    FreeSpaceMap& freeSpace(const std::string& dbName, const std::string& tableName);
+    // tableName ΪʱɾݿĿпռ
+    void dropFreeSpace(const std::string& dbName, const std::string& tableName = "");
+    // Ŀͳƣ״ʹʱɨ轨Ҫڿʼҳ޸֮ǰã÷б
+    ZoneMap& zoneMap(const std::string& dbName, const Table& table);
+    // ɾͳƼļ֮ɨ轨tableName ΪʱɾݿĿͳ(ɾļ)
+    void dropZoneMap(const std::string& dbName, const std::string& tableName = "");
+    TableStats& tableStats(const std::string& dbName, const std::string& tableName);
+    // ɾݿʱ㣬tableName Ϊʱݿı
+    void resetTableStats(const std::string& dbName, const std::string& tableName = "");
+    //  ANALYZE ͳƣûʱؿָ룬Żѡƻ
+    std::shared_ptr<const TableStatistics> analyzedStatistics(const std::string& dbName, const Table& table);
+    // ɾͳƼļtableName Ϊʱɾݿͳ(ɾļ)
+    void dropStatistics(const std::string& dbName, const std::string& tableName = "");
+
+    // Ԥ﷨Ȳƻ
+    std::shared_ptr<const ParsedStatement> parsePrepared(Session& session, const std::string& sql);
+    bool checkParams(Session& session, const ParsedStatement& statement, const std::vector<std::string>& params);
+
+    // ͬ openCursor Com_selectEXPLAIN ֻɼƻʱʹ
+    std::unique_ptr<Cursor> buildCursor(Session& session,
+                                        const std::string& tableName,
+                                        const std::string& columnList,
+                                        const Condition* where,
+                                        const std::string& groupBy,
+                                        const std::string& orderBy,
+                                        int64_t limit, int64_t offset);
+    // ѯۺϲѯѯȰֻ漰ɨ裬ӣȻۺϡ
+    //  ANALYZE ͳʱƵĴ۾˳㷨 FROM е˳
+    std::unique_ptr<Cursor> openOperatorCursor(Session& session,
+                                               const std::vector<std::string>& tableNames,
+                                               const std::string& columnList,
+                                               const Condition* where,
+                                               const std::string& groupBy,
+                                               const std::string& orderBy,
+                                               int64_t limit, int64_t offset);
+    //  ORDER BY  root ϼٰ LIMIT/OFFSET α
+    std::unique_ptr<Cursor> finishCursor(Session& session,
+                                         std::vector<std::shared_lock<std::shared_mutex>> tableGuards,
+                                         std::unique_ptr<Operator> root, const std::vector<size_t>& projection,
+                                         const std::string& orderBy, int64_t limit, int64_t offset);
+    bool resolveScan(const Table& table, const std::string& columnList, const Condition* where,
+                     std::vector<size_t>& projection, Predicate& predicate, std::string& error);
+    std::unique_ptr<Cursor> openTableCursor(Session& session,
+                                            std::vector<std::shared_lock<std::shared_mutex>> tableGuards,
+                                            const Table& table, const Predicate& predicate,
+                                            const std::vector<size_t>& projection, int64_t limit, int64_t offset);
+    bool planScans(Session& session, const std::vector<std::string>& tableNames,
+                   const std::vector<const Table*>& joined, const Condition* where,
+                   const std::shared_ptr<const Snapshot>& snapshot,
+                   std::vector<std::unique_ptr<ScanOperator>>& scans,
+                   std::vector<std::vector<const Condition*>>& joinConditions, std::vector<double>& estimates);
+    // estimates Ϊʱеֵùϣ
+    std::unique_ptr<Operator> joinScans(Session& session, std::vector<std::unique_ptr<ScanOperator>> scans,
+                                        const std::vector<std::vector<const Condition*>>& joinConditions,
+                                        const std::vector<double>& estimates);
 
     // 
-    std::string getTablePath(const std::string& tableName) const;
-    bool tableExists(const std::string& tableName) const;
-    void loadTables();
-    void saveTableInfo(const Table& table);
-    Table loadTableInfo(const std::string& tableName);
+    std::string getTablePath(const std::string& dbName, const std::string& tableName) const;
+    std::string getIndexPath(const std::string& dbName, const std::string& tableName,
+                             const std::string& indexName) const;
+    bool tableExists(const std::string& dbName, const std::string& tableName) const;
+    // ṹʱ nullptr
+    Table* findTable(const std::string& dbName, const std::string& tableName);
+    bool loadTables(Session& session, const std::string& dbName);
+    bool saveCatalog(Session& session, const std::string& dbName);
     
     // ַָ
     std::vector<std::string> splitString(const std::string& str, char delimiter) const;
+    // ͬ splitStringָ str fields ڶεü临
+    static void splitFields(std::string_view str, char delimiter, std::vector<std::string_view>& fields);
+    // ֵб SET Ӿ䣺ַеķָ֣е '' Ϊתĵ
+    static void splitValues(std::string_view str, char delimiter, std::vector<std::string_view>& fields);
     std::vector<std::string> splitString(const std::string& str, const std::string& delimiter) const;
     
-    bool writeRecord(const std::string& tableName, const std::vector<std::string>& values);
-    std::vector<std::vector<std::string>> readRecords(const std::string& tableName);
-    bool evaluateCondition(const std::vector<std::string>& record,
-                          const std::string& condition,
-                          const std::map<std::string, size_t>& columnIndices);
+    // ҳʽ¼д
+    bool writeRecord(const std::string& tablePath, const TableLayout& layout, FreeSpaceMap& freeSpace,
+                     ZoneMap& zones, const char* row, uint64_t stamp, RID& rid);
+    bool convertTableFile(const std::string& dbName, const Table& table);
+    bool buildIndex(const std::string& dbName, const Table& table, const std::string& indexName, size_t col);
+
+    // зάҳʧʱ false
+    bool forEachMatch(const std::string& dbName, const Table& table, const TableLayout& layout,
+                      const Predicate& predicate, const Snapshot& snapshot,
+                      const std::function<bool(PageRef&, RID)>& visit);
+    bool visitRows(const std::string& tablePath, const TableLayout& layout,
+                   const Predicate& predicate, const Snapshot& snapshot, std::vector<RID>& rids,
+                   const std::function<bool(PageRef&, RID)>& visit);
+    bool findIndexedRows(const std::string& dbName, const Table& table, const TableLayout& layout,
+                         const Predicate& predicate, std::vector<RID>& rids);
+    void updateIndexes(const std::string& dbName, const Table& table, const TableLayout& layout,
+                       const char* oldRow, const char* newRow, RID rid);
+    std::vector<BulkIndex> bulkIndexes(const std::string& dbName, const Table& table);
 };
 
 #endif // DBMS_H
\ No newline at end of file
@@ -0,0 +1,38 @@
+#include "FreeSpaceMap.h"
+
+void FreeSpaceMap::load(BufferPool& pool, const std::string& path) {
+    clear();
+    uint32_t pageCount = pool.pageCount(path);
+    for (uint32_t p = 0; p < pageCount; ++p) {
+        bool pinned;
+        const char* data = pool.viewPage(path, p, pinned);
+        if (!data) break;
+        const PageHeader* header = reinterpret_cast<const PageHeader*>(data);
+        if (header->magic == PAGE_MAGIC) update(p, header->slotCount - header->usedCount);
+        if (pinned) pool.unpinPage(path, p, false);
+    }
+    loaded = true;
+}
+
+void FreeSpaceMap::clear() {
+    pages.clear();
+    total = 0;
+    loaded = false;
+}
+
+bool FreeSpaceMap::findPage(uint32_t& pageNo) const {
+    if (pages.empty()) return false;
+    pageNo = pages.begin()->first;
+    return true;
+}
+
+void FreeSpaceMap::update(uint32_t pageNo, uint32_t freeSlots) {
+    auto it = pages.find(pageNo);
+    if (it != pages.end()) {
+        total -= it->second;
+        pages.erase(it);
+    }
+    if (freeSlots == 0) return;
+    pages.emplace(pageNo, freeSlots);
+    total += freeSlots;
+}
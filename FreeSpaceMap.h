@@ -0,0 +1,28 @@
+#ifndef FREE_SPACE_MAP_H
+#define FREE_SPACE_MAP_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include "BufferPool.h"
+
+// һűпвλҳвλ״ʹʱɨҳҳͷ֮дͻά
+// дҳСпвλҳ÷иñ
+class FreeSpaceMap {
+public:
+    bool isLoaded() const { return loaded; }
+    void load(BufferPool& pool, const std::string& path);
+    void clear();
+
+    // ҳСпвλҳ
+    bool findPage(uint32_t& pageNo) const;
+    void update(uint32_t pageNo, uint32_t freeSlots);
+    uint64_t freeSlots() const { return total; }
+
+private:
+    std::map<uint32_t, uint32_t> pages;  // ҳ -> вλ
+    uint64_t total = 0;
+    bool loaded = false;
+};
+
+#endif // FREE_SPACE_MAP_H
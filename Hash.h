@@ -0,0 +1,25 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+// FNV-1a ϣɷֶۼӣmixHash ɢλҲڷ
+const uint64_t HASH_SEED = 14695981039346656037ULL;
+
+inline uint64_t hashBytes(const char* data, size_t size, uint64_t hash = HASH_SEED) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+inline uint64_t mixHash(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+#endif // HASH_H
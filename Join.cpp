@@ -0,0 +1,334 @@
+#include "Join.h"
+#include <algorithm>
+#include <cstring>
+
+static const uint32_t NO_ROW = UINT32_MAX;
+
+Table joinSchema(const Table& left, const Table& right) {
+    Table schema;
+    schema.columns = left.columns;
+    schema.columns.insert(schema.columns.end(), right.columns.begin(), right.columns.end());
+    return schema;
+}
+
+static const char* joinRows(std::vector<char>& out, const char* left, uint32_t leftSize, const char* right) {
+    std::memcpy(out.data(), left, leftSize);
+    std::memcpy(out.data() + leftSize, right, out.size() - leftSize);
+    return out.data();
+}
+
+static size_t charLength(const char* p, uint32_t width) {
+    size_t len = 0;
+    while (len < width && p[len] != '\0') ++len;
+    return len;
+}
+
+// ϣ
+HashJoin::HashJoin(std::unique_ptr<Operator> left, std::unique_ptr<Operator> right,
+                   const std::vector<JoinKey>& keys, const Predicate& residual,
+                   const std::string& spillDir, size_t memoryLimit)
+    : left(std::move(left)), right(std::move(right)), keys(keys), residual(residual),
+      spillDir(spillDir), memoryLimit(memoryLimit), chainPos(NO_ROW) {
+    setSchema(joinSchema(this->left->schema(), this->right->schema()));
+    buildLeft = this->left->estimatedRows() <= this->right->estimatedRows();
+    buildInput = buildLeft ? this->left.get() : this->right.get();
+    probeInput = buildLeft ? this->right.get() : this->left.get();
+    buildRowSize = buildInput->layout().rowSize;
+    probeRowSize = probeInput->layout().rowSize;
+
+    const TableLayout& l = this->left->layout();
+    const TableLayout& r = this->right->layout();
+    for (const auto& key : keys) {
+        KeyField leftField = {l.offsets[key.left], l.widths[key.left], l.types[key.left]};
+        KeyField rightField = {r.offsets[key.right], r.widths[key.right], r.types[key.right]};
+        buildKeys.push_back(buildLeft ? leftField : rightField);
+        probeKeys.push_back(buildLeft ? rightField : leftField);
+    }
+    out.resize(outLayout.rowSize);
+}
+
+uint64_t HashJoin::estimatedRows() const {
+    if (plannedRows != UINT64_MAX) return plannedRows;
+    return std::max(left->estimatedRows(), right->estimatedRows());
+}
+
+std::string HashJoin::describe() const {
+    std::string text = "Hash Join (";
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (i > 0) text += " AND ";
+        text += left->schema().columns[keys[i].left].name + " = " + right->schema().columns[keys[i].right].name;
+    }
+    text += std::string(") build: ") + (buildLeft ? "left" : "right");
+    if (!residual.empty()) text += " filter: " + residual.describe(outSchema);
+    return text;
+}
+
+// CHAR ȥݼ㣬пͬҲƥ
+uint64_t HashJoin::hashKey(const char* row, const std::vector<KeyField>& fields) const {
+    uint64_t hash = HASH_SEED;
+    for (const auto& field : fields) {
+        const char* p = row + field.offset;
+        size_t len = (field.type == ColumnType::INT) ? field.width : charLength(p, field.width);
+        hash = hashBytes(p, len, hash);
+        // ָڵļ
+        hash = hashBytes("\xff", 1, hash);
+    }
+    return mixHash(hash);
+}
+
+bool HashJoin::keysEqual(const char* buildRow, const char* probeRow) const {
+    for (size_t i = 0; i < buildKeys.size(); ++i) {
+        const char* a = buildRow + buildKeys[i].offset;
+        const char* b = probeRow + probeKeys[i].offset;
+        if (buildKeys[i].type == ColumnType::INT) {
+            if (std::memcmp(a, b, sizeof(int32_t)) != 0) return false;
+        } else {
+            size_t len = charLength(a, buildKeys[i].width);
+            if (len != charLength(b, probeKeys[i].width) || std::memcmp(a, b, len) != 0) return false;
+        }
+    }
+    return true;
+}
+
+void HashJoin::clearTable() {
+    rows.clear();
+    hashes.clear();
+    chain.clear();
+    heads.clear();
+    rowCount = 0;
+    chainPos = NO_ROW;
+}
+
+bool HashJoin::loadBuild(const RowSource& source, bool limited) {
+    clearTable();
+    // ÿжռùϣֵָ
+    size_t perRow = buildRowSize + sizeof(uint64_t) + 2 * sizeof(uint32_t);
+    while (const char* row = source()) {
+        rows.insert(rows.end(), row, row + buildRowSize);
+        hashes.push_back(hashKey(row, buildKeys));
+        rowCount++;
+        if (limited && static_cast<size_t>(rowCount) * perRow > memoryLimit) return false;
+    }
+    return true;
+}
+
+void HashJoin::indexTable() {
+    uint32_t buckets = 16;
+    while (buckets < rowCount * 2u) buckets *= 2;
+    heads.assign(buckets, NO_ROW);
+    chain.resize(rowCount);
+    // 룬ʹͬһͰڰ˳
+    for (uint32_t i = rowCount; i-- > 0;) {
+        uint32_t bucket = static_cast<uint32_t>(hashes[i]) & (buckets - 1);
+        chain[i] = heads[bucket];
+        heads[bucket] = i;
+    }
+}
+
+bool HashJoin::spill(const RowSource& buildRest, const RowSource& probe, int level) {
+    std::vector<Partition> parts(PARTITIONS);
+    for (auto& part : parts) {
+        part.build.reset(new SpillFile(spillDir, buildRowSize));
+        part.probe.reset(new SpillFile(spillDir, probeRowSize));
+        stats.spillFiles += 2;
+        part.level = level;
+        if (!part.build->isOpen() || !part.probe->isOpen()) {
+            errorMessage = "Failed to create temporary file in '" + spillDir + "'";
+            return false;
+        }
+    }
+
+    uint32_t shift = 32 + PARTITION_BITS * level;
+    bool ok = true;
+    for (uint32_t i = 0; i < rowCount; ++i) {
+        uint32_t p = static_cast<uint32_t>(hashes[i] >> shift) & (PARTITIONS - 1);
+        ok = parts[p].build->write(rows.data() + static_cast<size_t>(i) * buildRowSize) && ok;
+    }
+    clearTable();
+    while (const char* row = buildRest()) {
+        uint32_t p = static_cast<uint32_t>(hashKey(row, buildKeys) >> shift) & (PARTITIONS - 1);
+        ok = parts[p].build->write(row) && ok;
+    }
+    while (const char* row = probe()) {
+        uint32_t p = static_cast<uint32_t>(hashKey(row, probeKeys) >> shift) & (PARTITIONS - 1);
+        ok = parts[p].probe->write(row) && ok;
+    }
+
+    // һΪյķûн
+    for (auto& part : parts) {
+        if (part.build->rowCount() == 0 || part.probe->rowCount() == 0) continue;
+        ok = part.build->rewind() && part.probe->rewind() && ok;
+        partitions.push_back(std::move(part));
+    }
+    if (!ok) errorMessage = "Failed to write temporary file in '" + spillDir + "'";
+    return ok;
+}
+
+bool HashJoin::nextPartition() {
+    probeFile.reset();
+    while (!partitions.empty()) {
+        Partition part = std::move(partitions.back());
+        partitions.pop_back();
+        SpillFile* build = part.build.get();
+        SpillFile* probe = part.probe.get();
+        RowSource buildSource = [build] { return build->read(); };
+        if (!loadBuild(buildSource, part.level < MAX_LEVEL)) {
+            // ԳڴޣߵĹϣλϸ
+            if (!spill(buildSource, [probe] { return probe->read(); }, part.level + 1)) return false;
+            continue;
+        }
+        indexTable();
+        probeFile = std::move(part.probe);
+        return true;
+    }
+    return false;
+}
+
+const char* HashJoin::output(const char* buildRow, const char* probeRow) {
+    return buildLeft ? joinRows(out, buildRow, buildRowSize, probeRow)
+                     : joinRows(out, probeRow, probeRowSize, buildRow);
+}
+
+const char* HashJoin::produce() {
+    if (done) return nullptr;
+    if (!started) {
+        started = true;
+        RowSource buildSource = [this] { return buildInput->next(); };
+        if (loadBuild(buildSource, true)) {
+            indexTable();
+            // Ϊʱضȡ̽
+            if (rowCount == 0) done = true;
+        } else if (!spill(buildSource, [this] { return probeInput->next(); }, 0) || !nextPartition()) {
+            done = true;
+        }
+    }
+
+    while (!done) {
+        while (chainPos != NO_ROW) {
+            uint32_t i = chainPos;
+            chainPos = chain[i];
+            const char* buildRow = rows.data() + static_cast<size_t>(i) * buildRowSize;
+            if (hashes[i] != probeHash || !keysEqual(buildRow, probeRow)) continue;
+            const char* row = output(buildRow, probeRow);
+            if (residual.evaluate(row)) return row;
+        }
+
+        probeRow = probeFile ? probeFile->read() : probeInput->next();
+        if (!probeRow) {
+            if (probeFile && nextPartition()) continue;
+            done = true;
+            break;
+        }
+        probeHash = hashKey(probeRow, probeKeys);
+        chainPos = heads[static_cast<uint32_t>(probeHash) & (heads.size() - 1)];
+    }
+
+    clearTable();
+    partitions.clear();
+    probeFile.reset();
+    if (errorMessage.empty()) errorMessage = !left->error().empty() ? left->error() : right->error();
+    return nullptr;
+}
+
+// Ƕѭ
+NestedLoopJoin::NestedLoopJoin(std::unique_ptr<Operator> left, std::unique_ptr<Operator> right,
+                               const Predicate& condition, const std::string& spillDir, size_t memoryLimit)
+    : left(std::move(left)), right(std::move(right)), condition(condition),
+      spillDir(spillDir), memoryLimit(memoryLimit) {
+    setSchema(joinSchema(this->left->schema(), this->right->schema()));
+    blockLeft = this->left->estimatedRows() <= this->right->estimatedRows();
+    blockInput = blockLeft ? this->left.get() : this->right.get();
+    scanInput = blockLeft ? this->right.get() : this->left.get();
+    blockRowSize = blockInput->layout().rowSize;
+    out.resize(outLayout.rowSize);
+}
+
+uint64_t NestedLoopJoin::estimatedRows() const {
+    if (plannedRows != UINT64_MAX) return plannedRows;
+    uint64_t l = left->estimatedRows();
+    uint64_t r = right->estimatedRows();
+    if (!condition.empty()) return std::max(l, r);
+    return (l != 0 && r > UINT64_MAX / l) ? UINT64_MAX : l * r;
+}
+
+std::string NestedLoopJoin::describe() const {
+    std::string text = std::string("Nested Loop Join (block: ") + (blockLeft ? "left" : "right") + ")";
+    if (!condition.empty()) text += " filter: " + condition.describe(outSchema);
+    return text;
+}
+
+bool NestedLoopJoin::loadBlock() {
+    blockCount = 0;
+    blockPos = 0;
+    size_t limit = std::max<size_t>(memoryLimit / std::max<uint32_t>(blockRowSize, 1), 1);
+    while (blockCount < limit) {
+        const char* row = blockInput->next();
+        if (!row) {
+            blockExhausted = true;
+            break;
+        }
+        if (block.size() < static_cast<size_t>(blockCount + 1) * blockRowSize) {
+            block.resize(std::max<size_t>(block.size() * 2, static_cast<size_t>(blockCount + 1) * blockRowSize));
+        }
+        std::memcpy(block.data() + static_cast<size_t>(blockCount++) * blockRowSize, row, blockRowSize);
+    }
+    return blockCount > 0;
+}
+
+const char* NestedLoopJoin::nextScanRow() {
+    if (scanFile && !firstPass) return scanFile->read();
+    const char* row = scanInput->next();
+    if (row && scanFile && !scanFile->write(row)) {
+        errorMessage = "Failed to write temporary file in '" + spillDir + "'";
+        return nullptr;
+    }
+    return row;
+}
+
+bool NestedLoopJoin::rewindScan() {
+    firstPass = false;
+    return scanFile ? scanFile->rewind() : scanInput->rewind();
+}
+
+const char* NestedLoopJoin::produce() {
+    if (done) return nullptr;
+    if (!started) {
+        started = true;
+        if (!loadBlock()) done = true;
+        // һװʱҪȡһ
+        if (!done && !blockExhausted && !scanInput->rewind()) {
+            scanFile.reset(new SpillFile(spillDir, scanInput->layout().rowSize));
+            stats.spillFiles++;
+            if (!scanFile->isOpen()) {
+                errorMessage = "Failed to create temporary file in '" + spillDir + "'";
+                done = true;
+            }
+        }
+    }
+
+    while (!done) {
+        if (scanRow) {
+            while (blockPos < blockCount) {
+                const char* blockRow = block.data() + static_cast<size_t>(blockPos++) * blockRowSize;
+                const char* row = blockLeft ? joinRows(out, blockRow, blockRowSize, scanRow)
+                                            : joinRows(out, scanRow, scanInput->layout().rowSize, blockRow);
+                if (condition.evaluate(row)) return row;
+            }
+        }
+        scanRow = nextScanRow();
+        blockPos = 0;
+        if (!scanRow) {
+            if (!errorMessage.empty() || blockExhausted || !loadBlock()) {
+                done = true;
+            } else if (!rewindScan()) {
+                errorMessage = "Failed to read temporary file in '" + spillDir + "'";
+                done = true;
+            }
+        }
+    }
+
+    block.clear();
+    scanFile.reset();
+    if (errorMessage.empty()) errorMessage = !left->error().empty() ? left->error() : right->error();
+    return nullptr;
+}
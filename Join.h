@@ -0,0 +1,143 @@
+#ifndef JOIN_H
+#define JOIN_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Operator.h"
+
+// ֵӼек
+struct JoinKey {
+    size_t left;
+    size_t right;
+};
+
+// ΪкУмβ
+Table joinSchema(const Table& left, const Table& right);
+
+// ϣӣԹٵһཨϣһ̽
+// ೬ڴʱ඼ĹϣֵдʱļԷ(Grace ϣ)
+// ԷŲʱϸ֣ϸֵһٲ(ͨǴظ)
+class HashJoin : public Operator {
+public:
+    // residual Ϊб
+    HashJoin(std::unique_ptr<Operator> left, std::unique_ptr<Operator> right,
+             const std::vector<JoinKey>& keys, const Predicate& residual,
+             const std::string& spillDir, size_t memoryLimit);
+
+    uint64_t estimatedRows() const override;
+    std::string describe() const override;
+    std::vector<Operator*> inputs() const override { return {left.get(), right.get()}; }
+
+protected:
+    const char* produce() override;
+
+private:
+    static const uint32_t PARTITIONS = 16;
+    static const uint32_t PARTITION_BITS = 4;
+    static const int MAX_LEVEL = 3;
+
+    struct KeyField {
+        uint32_t offset;
+        uint32_t width;
+        ColumnType type;
+    };
+    struct Partition {
+        std::unique_ptr<SpillFile> build;
+        std::unique_ptr<SpillFile> probe;
+        int level;
+    };
+    typedef std::function<const char*()> RowSource;
+
+    uint64_t hashKey(const char* row, const std::vector<KeyField>& fields) const;
+    bool keysEqual(const char* buildRow, const char* probeRow) const;
+    void clearTable();
+    // 빹࣬ڴʱ falseѶڱ
+    bool loadBuild(const RowSource& source, bool limited);
+    void indexTable();
+    // ѱеСʣк̽ȫздʱļ
+    bool spill(const RowSource& buildRest, const RowSource& probe, int level);
+    bool nextPartition();
+    const char* output(const char* buildRow, const char* probeRow);
+
+    std::unique_ptr<Operator> left;
+    std::unique_ptr<Operator> right;
+    std::vector<JoinKey> keys;
+    Predicate residual;
+    std::string spillDir;
+    size_t memoryLimit;
+
+    bool buildLeft;  // ǷΪ
+    Operator* buildInput;
+    Operator* probeInput;
+    uint32_t buildRowSize;
+    uint32_t probeRowSize;
+    std::vector<KeyField> buildKeys;
+    std::vector<KeyField> probeKeys;
+
+    // ϣа˳ţͬһͰ chain 
+    std::vector<char> rows;
+    std::vector<uint64_t> hashes;
+    std::vector<uint32_t> chain;
+    std::vector<uint32_t> heads;
+    uint32_t rowCount = 0;
+
+    std::vector<Partition> partitions;  // ķ
+    std::unique_ptr<SpillFile> probeFile;  // ̽ķ
+    bool started = false;
+    bool done = false;
+
+    const char* probeRow = nullptr;
+    uint64_t probeHash = 0;
+    uint32_t chainPos;
+    std::vector<char> out;
+};
+
+// Ƕѭӣûеֵ
+// ٵһఴڴ޷ֿ룬ÿһȫֵ
+// һ಻ɨʱһȡʱдʱļ
+class NestedLoopJoin : public Operator {
+public:
+    // condition ΪбΪձʾѿ
+    NestedLoopJoin(std::unique_ptr<Operator> left, std::unique_ptr<Operator> right,
+                   const Predicate& condition, const std::string& spillDir, size_t memoryLimit);
+
+    uint64_t estimatedRows() const override;
+    std::string describe() const override;
+    std::vector<Operator*> inputs() const override { return {left.get(), right.get()}; }
+
+protected:
+    const char* produce() override;
+
+private:
+    bool loadBlock();
+    const char* nextScanRow();
+    bool rewindScan();
+
+    std::unique_ptr<Operator> left;
+    std::unique_ptr<Operator> right;
+    Predicate condition;
+    std::string spillDir;
+    size_t memoryLimit;
+
+    bool blockLeft;  // ֿǷΪ
+    Operator* blockInput;
+    Operator* scanInput;
+    uint32_t blockRowSize;
+
+    std::vector<char> block;
+    uint32_t blockCount = 0;
+    uint32_t blockPos = 0;
+    bool blockExhausted = false;
+
+    std::unique_ptr<SpillFile> scanFile;  // һ಻ɨʱĸ
+    bool firstPass = true;
+    bool started = false;
+    bool done = false;
+    const char* scanRow = nullptr;
+    std::vector<char> out;
+};
+
+#endif // JOIN_H
@@ -0,0 +1,378 @@
+#include "Operator.h"
+#include <algorithm>
+#include <atomic>
+
+// ɨ
+ScanOperator::ScanOperator(BufferPool& pool, const std::string& tablePath, const Table& table, const ReadView& view,
+                           const Predicate& predicate, bool indexed, std::vector<RID> rids,
+                           const std::string& qualifier, ThreadPool* workers)
+    : pool(pool), tablePath(tablePath), tableName(table.name), view(view), snapshot(*view.snapshot), predicate(predicate),
+      indexed(indexed), rids(std::move(rids)), workers(workers) {
+    Table schema = table;
+    if (!qualifier.empty()) {
+        schema.name.clear();
+        for (auto& column : schema.columns) column.name = qualifier + "." + column.name;
+    }
+    setSchema(schema);
+
+    // ֻνõУеп
+    needed.assign(table.columns.size(), false);
+    predicate.referencedColumns(needed);
+    batch.init(outLayout, needed);
+    all.resize(BATCH_SIZE);
+    selected.resize(BATCH_SIZE);
+    for (uint32_t i = 0; i < BATCH_SIZE; ++i) all[i] = i;
+
+    if (indexed) {
+        std::sort(this->rids.begin(), this->rids.end(), [](const RID& a, const RID& b) {
+            return a.page != b.page ? a.page < b.page : a.slot < b.slot;
+        });
+    } else {
+        pageCount = pool.pageCount(tablePath);
+        if (parallelizable(workers, pageCount)) morselCount = (pageCount + MORSEL_PAGES - 1) / MORSEL_PAGES;
+    }
+}
+
+// ȴɨС飬ʹñνʺͻ
+ScanOperator::~ScanOperator() {
+    if (tasks) tasks->wait();
+    if (tableStats && started) tableStats->addScan(indexed, stats);
+}
+
+const char* ScanOperator::produce() {
+    if (!errorMessage.empty()) return nullptr;
+    while (position == rowCount) {
+        if (!(morselCount > 0 ? fillParallel() : fill())) return nullptr;
+    }
+    return rows.data() + static_cast<size_t>(position++) * outLayout.rowSize;
+}
+
+bool ScanOperator::rewind() {
+    if (tasks) tasks->wait();
+    nextMorsel = emitMorsel = 0;
+    ridPos = 0;
+    pageNo = 0;
+    rowCount = position = 0;
+    return true;
+}
+
+uint64_t ScanOperator::estimatedRows() const {
+    if (plannedRows != UINT64_MAX) return plannedRows;
+    return indexed ? rids.size() : static_cast<uint64_t>(pageCount) * outLayout.slotsPerPage;
+}
+
+std::string ScanOperator::describe() const {
+    std::string text = std::string(indexed ? "Index Scan" : (morselCount > 0 ? "Parallel Seq Scan" : "Seq Scan")) +
+                       " on " + tableName;
+    if (morselCount > 0) text += " (" + std::to_string(workers->size()) + " workers)";
+    if (!predicate.empty()) text += " filter: " + predicate.describe(outSchema);
+    return text;
+}
+
+template <typename Visit>
+bool ScanOperator::filterPages(uint32_t first, uint32_t last, ColumnBatch& batch, uint32_t* selected,
+                               OperatorStats& counters, Visit visit) {
+    for (uint32_t p = first; p < last; ++p) {
+        auto guard = view.lockPage();
+        if (zones && !zones->mayMatch(p, predicate)) {
+            counters.pagesSkipped++;
+            continue;
+        }
+        bool pinned, hit;
+        const char* data = pool.viewPage(tablePath, p, pinned, &hit);
+        if (!data) return false;
+        counters.pagesRead++;
+        counters.poolHits += hit ? 1 : 0;
+        const PageRef page(const_cast<char*>(data), outLayout);
+        if (page.isValid()) {
+            uint32_t slot = 0;
+            while (slot < page.slotCount()) {
+                batch.clear();
+                slot = batch.appendPage(page, slot, p, snapshot);
+                counters.rowsScanned += batch.size();
+                uint32_t n = predicate.filter(batch, all.data(), batch.size(), selected);
+                visit(page, batch, selected, n);
+            }
+        }
+        if (pinned) pool.unpinPage(tablePath, p, false);
+    }
+    return true;
+}
+
+ScanOperator::Morsel* ScanOperator::newMorsel() {
+    Morsel* morsel = new Morsel();
+    morsel->batch.init(outLayout, needed);
+    morsel->selected.resize(BATCH_SIZE);
+    return morsel;
+}
+
+// ߳ÿȡһδС飬ֱȡ
+template <typename Work>
+void ScanOperator::forEachMorsel(Work work) {
+    std::atomic<uint32_t> next(0);
+    std::vector<std::unique_ptr<Morsel>> scratch;
+    TaskGroup group(*workers);
+    for (size_t i = 0; i < std::min<size_t>(workers->size(), morselCount); ++i) {
+        scratch.emplace_back(newMorsel());
+        Morsel* slot = scratch.back().get();
+        group.run([this, &next, &work, slot] {
+            for (uint32_t m; (m = next++) < morselCount;) {
+                work(m * MORSEL_PAGES, std::min(m * MORSEL_PAGES + MORSEL_PAGES, pageCount), m, *slot);
+            }
+        });
+    }
+    group.wait();
+    for (const auto& slot : scratch) stats.add(slot->stats);
+}
+
+uint64_t ScanOperator::countRows() {
+    started = true;
+    uint64_t count = 0;
+    if (indexed) {
+        while (ridPos < rids.size()) {
+            uint32_t p = rids[ridPos].page;
+            auto guard = view.lockPage();
+            bool hit;
+            char* data = pool.fetchPage(tablePath, p, &hit);
+            if (!data) {
+                readFailed();
+                ridPos = rids.size();
+                break;
+            }
+            PageRef page(data, outLayout);
+            for (; ridPos < rids.size() && rids[ridPos].page == p; ++ridPos) {
+                uint32_t s = rids[ridPos].slot;
+                if (!page.isValid() || s >= page.slotCount() || !page.isUsed(s)) continue;
+                if (!snapshot.visible(page.version(s))) continue;
+                stats.rowsScanned++;
+                if (predicate.evaluate(page.slotData(s))) count++;
+            }
+            stats.pagesRead++;
+            stats.poolHits += hit ? 1 : 0;
+            pool.unpinPage(tablePath, p, false);
+        }
+        stats.rowsOut += count;
+        return count;
+    }
+
+    // ûʱֻеİ汾
+    std::atomic<bool> failed(false);
+    auto countPages = [this, &failed](uint32_t first, uint32_t last, ColumnBatch& batch, uint32_t* selected,
+                                      OperatorStats& counters) {
+        uint64_t count = 0;
+        if (!predicate.empty()) {
+            if (!filterPages(first, last, batch, selected, counters,
+                             [&count](const PageRef&, const ColumnBatch&, const uint32_t*, uint32_t n) { count += n; })) {
+                failed = true;
+            }
+            return count;
+        }
+        for (uint32_t p = first; p < last; ++p) {
+            auto guard = view.lockPage();
+            bool pinned, hit;
+            const char* data = pool.viewPage(tablePath, p, pinned, &hit);
+            if (!data) {
+                failed = true;
+                break;
+            }
+            counters.pagesRead++;
+            counters.poolHits += hit ? 1 : 0;
+            const PageRef page(const_cast<char*>(data), outLayout);
+            if (page.isValid()) {
+                for (uint32_t s = 0; s < page.slotCount(); ++s) {
+                    count += (page.isUsed(s) && snapshot.visible(page.version(s))) ? 1 : 0;
+                }
+            }
+            if (pinned) pool.unpinPage(tablePath, p, false);
+        }
+        if (predicate.empty()) counters.rowsScanned += count;
+        return count;
+    };
+    if (morselCount > 0 && pageNo == 0) {
+        std::atomic<uint64_t> total(0);
+        forEachMorsel([&](uint32_t first, uint32_t last, uint32_t, Morsel& slot) {
+            total += countPages(first, last, slot.batch, slot.selected.data(), slot.stats);
+        });
+        count = total;
+    } else {
+        count = countPages(pageNo, pageCount, batch, selected.data(), stats);
+    }
+    if (failed) readFailed();
+    pageNo = pageCount;
+    stats.rowsOut += count;
+    return count;
+}
+
+bool ScanOperator::collectRids(std::vector<RID>& out) {
+    started = true;
+    auto collect = [](std::vector<RID>& rids) {
+        return [&rids](const PageRef&, const ColumnBatch& batch, const uint32_t* selected, uint32_t n) {
+            for (uint32_t i = 0; i < n; ++i) rids.push_back(batch.rid(selected[i]));
+        };
+    };
+    size_t before = out.size();
+    bool ok = true;
+    if (morselCount == 0) {
+        ok = filterPages(0, pageCount, batch, selected.data(), stats, collect(out));
+    } else {
+        // СĽֿţ󰴿ƴ
+        std::vector<std::vector<RID>> parts(morselCount);
+        std::atomic<bool> failed(false);
+        forEachMorsel([&](uint32_t first, uint32_t last, uint32_t m, Morsel& slot) {
+            if (!filterPages(first, last, slot.batch, slot.selected.data(), slot.stats, collect(parts[m]))) {
+                failed = true;
+            }
+        });
+        ok = !failed;
+        for (const auto& part : parts) out.insert(out.end(), part.begin(), part.end());
+    }
+    stats.rowsOut += out.size() - before;
+    if (!ok) readFailed();
+    return ok;
+}
+
+// ȡһҳеУûиҳʱ false
+bool ScanOperator::fill() {
+    started = true;
+    rowCount = position = 0;
+    uint32_t rowSize = outLayout.rowSize;
+    if (indexed) {
+        if (ridPos >= rids.size()) return false;
+        uint32_t p = rids[ridPos].page;
+        auto guard = view.lockPage();
+        bool hit;
+        char* data = pool.fetchPage(tablePath, p, &hit);
+        if (!data) {
+            readFailed();
+            return false;
+        }
+        PageRef page(data, outLayout);
+        for (; ridPos < rids.size() && rids[ridPos].page == p; ++ridPos) {
+            uint32_t s = rids[ridPos].slot;
+            if (!page.isValid() || s >= page.slotCount() || !page.isUsed(s)) continue;
+            if (!snapshot.visible(page.version(s))) continue;
+            stats.rowsScanned++;
+            if (!predicate.evaluate(page.slotData(s))) continue;
+            if (rows.size() < static_cast<size_t>(rowCount + 1) * rowSize) rows.resize(static_cast<size_t>(rowCount + 1) * rowSize);
+            std::memcpy(rows.data() + static_cast<size_t>(rowCount++) * rowSize, page.slotData(s), rowSize);
+        }
+        stats.pagesRead++;
+        stats.poolHits += hit ? 1 : 0;
+        pool.unpinPage(tablePath, p, false);
+        return true;
+    }
+
+    if (pageNo >= pageCount) return false;
+    if (!filterPages(pageNo, pageNo + 1, batch, selected.data(), stats,
+                     [this, rowSize](const PageRef& page, const ColumnBatch& batch, const uint32_t* selected, uint32_t n) {
+                         if (rows.size() < static_cast<size_t>(rowCount + n) * rowSize) {
+                             rows.resize(static_cast<size_t>(rowCount + n) * rowSize);
+                         }
+                         for (uint32_t i = 0; i < n; ++i) {
+                             std::memcpy(rows.data() + static_cast<size_t>(rowCount++) * rowSize,
+                                         page.slotData(batch.rid(selected[i]).slot), rowSize);
+                         }
+                     })) {
+        readFailed();
+        pageNo = pageCount;
+        return false;
+    }
+    pageNo++;
+    return true;
+}
+
+// СепÿĽҳʧʱ false
+bool ScanOperator::scanMorsel(uint32_t morsel, Morsel& slot) {
+    uint32_t rowSize = outLayout.rowSize;
+    uint32_t first = morsel * MORSEL_PAGES;
+    slot.rowCount = 0;
+    slot.stats = OperatorStats();
+    return filterPages(first, std::min(first + MORSEL_PAGES, pageCount), slot.batch, slot.selected.data(), slot.stats,
+                [&slot, rowSize](const PageRef& page, const ColumnBatch& batch, const uint32_t* selected, uint32_t n) {
+                    if (slot.rows.size() < static_cast<size_t>(slot.rowCount + n) * rowSize) {
+                        slot.rows.resize(static_cast<size_t>(slot.rowCount + n) * rowSize);
+                    }
+                    for (uint32_t i = 0; i < n; ++i) {
+                        std::memcpy(slot.rows.data() + static_cast<size_t>(slot.rowCount++) * rowSize,
+                                    page.slotData(batch.rid(selected[i]).slot), rowSize);
+                    }
+                });
+}
+
+void ScanOperator::schedule(uint32_t morsel) {
+    Morsel& slot = *morsels[morsel % morsels.size()];
+    {
+        std::lock_guard<std::mutex> lock(morselMutex);
+        slot.ready = false;
+    }
+    tasks->run([this, morsel, &slot] {
+        bool ok = scanMorsel(morsel, slot);
+        {
+            std::lock_guard<std::mutex> lock(morselMutex);
+            slot.failed = !ok;
+            slot.ready = true;
+        }
+        morselReady.notify_all();
+    });
+}
+
+// ˳ȡһСĽѿճλýС
+bool ScanOperator::fillParallel() {
+    started = true;
+    rowCount = position = 0;
+    if (emitMorsel >= morselCount) return false;
+    if (!tasks) {
+        tasks.reset(new TaskGroup(*workers));
+        size_t window = std::min<size_t>(2 * workers->size(), morselCount);
+        while (morsels.size() < window) morsels.emplace_back(newMorsel());
+    }
+    while (nextMorsel < morselCount && nextMorsel < emitMorsel + morsels.size()) schedule(nextMorsel++);
+
+    Morsel& slot = *morsels[emitMorsel % morsels.size()];
+    {
+        std::unique_lock<std::mutex> lock(morselMutex);
+        morselReady.wait(lock, [&slot] { return slot.ready; });
+    }
+    if (slot.failed) {
+        readFailed();
+        emitMorsel = nextMorsel = morselCount;
+        return false;
+    }
+    rows.swap(slot.rows);
+    rowCount = slot.rowCount;
+    stats.add(slot.stats);
+    emitMorsel++;
+    while (nextMorsel < morselCount && nextMorsel < emitMorsel + morsels.size()) schedule(nextMorsel++);
+    return true;
+}
+
+// ʱļ
+static std::atomic<uint64_t> spillCounter(0);
+
+SpillFile::SpillFile(const std::string& dir, uint32_t rowSize) : rowSize(rowSize), buffer(256 * 1024), row(rowSize) {
+    path = dir + "/" + std::to_string(spillCounter++) + ".spill";
+    file = std::fopen(path.c_str(), "w+b");
+    if (file) std::setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+}
+
+SpillFile::~SpillFile() {
+    if (file) {
+        std::fclose(file);
+        std::remove(path.c_str());
+    }
+}
+
+bool SpillFile::write(const char* data) {
+    if (!file || std::fwrite(data, 1, rowSize, file) != rowSize) return false;
+    rows++;
+    return true;
+}
+
+bool SpillFile::rewind() {
+    return file && std::fflush(file) == 0 && seekFile(file, 0);
+}
+
+const char* SpillFile::read() {
+    if (!file || rowSize == 0 || std::fread(row.data(), 1, rowSize, file) != rowSize) return nullptr;
+    return row.data();
+}
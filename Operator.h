@@ -0,0 +1,268 @@
+#ifndef OPERATOR_H
+#define OPERATOR_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Schema.h"
+#include "Storage.h"
+#include "BufferPool.h"
+#include "Predicate.h"
+#include "ColumnBatch.h"
+#include "ThreadPool.h"
+#include "Transaction.h"
+#include "ZoneMap.h"
+#include "Hash.h"
+
+// ӡۺϡĬϿõڴ棬ʱдʱļ
+const size_t DEFAULT_WORK_MEMORY_BYTES = 64 * 1024 * 1024;
+
+// ӵִͳƣEXPLAIN ANALYZE ʾ
+// ҳֻɨͳƣʱֻڿʱۼƣӵĺʱ
+struct OperatorStats {
+    uint64_t rowsOut = 0;
+    uint64_t rowsScanned = 0;  // ɨʱĶԿտɼ
+    uint64_t pagesRead = 0;
+    uint64_t pagesSkipped = 0;  // ͳûжȡҳ
+    uint64_t poolHits = 0;     // ȡҳڻеҳ
+    uint64_t spillFiles = 0;   // ڴʱʱļ
+    uint64_t nanos = 0;
+
+    void add(const OperatorStats& other) {
+        rowsOut += other.rowsOut;
+        rowsScanned += other.rowsScanned;
+        pagesRead += other.pagesRead;
+        pagesSkipped += other.pagesSkipped;
+        poolHits += other.poolHits;
+        spillFiles += other.spillFiles;
+        nanos += other.nanos;
+    }
+};
+
+// һűۼƷͳƣSHOW TABLE STATUS ʾɱỰ߳ͬʱۼ
+// 󴴽ɾɾʱ
+struct TableStats {
+    std::atomic<uint64_t> seqScans{0};
+    std::atomic<uint64_t> indexScans{0};
+    std::atomic<uint64_t> rowsScanned{0};
+    std::atomic<uint64_t> rowsReturned{0};
+    std::atomic<uint64_t> pagesRead{0};
+    std::atomic<uint64_t> poolHits{0};
+    std::atomic<uint64_t> rowsInserted{0};
+    std::atomic<uint64_t> rowsUpdated{0};
+    std::atomic<uint64_t> rowsDeleted{0};
+    TableStats* total = nullptr;  // ͬʱۼӵȫͳ
+
+    // һɨʱ
+    void addScan(bool indexed, const OperatorStats& scan) {
+        (indexed ? indexScans : seqScans)++;
+        rowsScanned += scan.rowsScanned;
+        rowsReturned += scan.rowsOut;
+        pagesRead += scan.pagesRead;
+        poolHits += scan.poolHits;
+        if (total) total->addScan(indexed, scan);
+    }
+    void addRows(uint64_t inserted, uint64_t updated, uint64_t deleted) {
+        rowsInserted += inserted;
+        rowsUpdated += updated;
+        rowsDeleted += deleted;
+        if (total) total->addRows(inserted, updated, deleted);
+    }
+    void reset() {
+        for (auto* counter : {&seqScans, &indexScans, &rowsScanned, &rowsReturned, &pagesRead, &poolHits,
+                              &rowsInserted, &rowsUpdated, &rowsDeleted}) {
+            *counter = 0;
+        }
+    }
+};
+
+// ִӣÿβһжУиʽ밴 schema() Ƶ TableLayout һ
+// ѯǰ׺(t.col)
+class Operator {
+public:
+    virtual ~Operator() {}
+
+    const Table& schema() const { return outSchema; }
+    const TableLayout& layout() const { return outLayout; }
+
+    // ȡһУûиʱ nullptrصһεǰЧ
+    const char* next() {
+        if (!timed) {
+            const char* row = produce();
+            if (row) stats.rowsOut++;
+            return row;
+        }
+        auto start = std::chrono::steady_clock::now();
+        const char* row = produce();
+        stats.nanos += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        if (row) stats.rowsOut++;
+        return row;
+    }
+    // صһУ֧ʱ false
+    virtual bool rewind() { return false; }
+    // Ƶ
+    virtual uint64_t estimatedRows() const = 0;
+    // ŻͳƹƵɨ水Ĺ
+    void setEstimatedRows(uint64_t rows) { plannedRows = rows; }
+
+    // ִмƻеһУ "Hash Join (a.id = b.id)"
+    virtual std::string describe() const = 0;
+    // ӣӵǰ
+    virtual std::vector<Operator*> inputs() const { return {}; }
+    // ʼʱ
+    void enableTiming() {
+        timed = true;
+        for (Operator* input : inputs()) input->enableTiming();
+    }
+    const OperatorStats& statistics() const { return stats; }
+
+    // ִг(ʱļдʧ)ʱĴϢ
+    const std::string& error() const { return errorMessage; }
+
+protected:
+    //  next ãһ
+    virtual const char* produce() = 0;
+
+    void setSchema(const Table& schema) {
+        outSchema = schema;
+        outLayout = TableLayout(outSchema);
+    }
+
+    Table outSchema;
+    TableLayout outLayout;
+    std::string errorMessage;
+    OperatorStats stats;
+    bool timed = false;
+    uint64_t plannedRows = UINT64_MAX;  // ûʱΪ UINT64_MAX
+};
+
+// ɨ裺ҳνõвˣٿԿտɼеУ
+// indexed Ϊ true ʱֻ rids 
+// ̳߳ұ㹻ʱȫɨ谴 MORSEL_PAGES ҳֳС齻̳߳زйˣ
+// ԰ҳ˳ͬʱеĿޣڴռС޹
+// ͳʱȫɨνʲܳĿ
+class ScanOperator : public Operator {
+public:
+    static const uint32_t MORSEL_PAGES = 16;
+    static const uint32_t PARALLEL_MIN_PAGES = 4 * MORSEL_PAGES;
+
+    // qualifier ǿʱϸǰ׺
+    ScanOperator(BufferPool& pool, const std::string& tablePath, const Table& table, const ReadView& view,
+                 const Predicate& predicate, bool indexed, std::vector<RID> rids,
+                 const std::string& qualifier = "", ThreadPool* workers = nullptr);
+    ~ScanOperator();
+
+    bool rewind() override;
+    uint64_t estimatedRows() const override;
+    std::string describe() const override;
+    // ֻͳеУҳʧʱ error()
+    uint64_t countRows();
+    // ȫɨееλãҳ˳򣻶ҳʧʱ false  error()
+    bool collectRids(std::vector<RID>& out);
+    // ɨ()ʱͳƼۼͳƣûжȡͽ( EXPLAIN)Ĳ
+    void setTableStats(TableStats* tableStats) { this->tableStats = tableStats; }
+    void setZoneMap(const ZoneMap* zones) { this->zones = zones; }
+    // Ƿֵòɨ
+    static bool parallelizable(const ThreadPool* workers, uint32_t pageCount) {
+        return workers && workers->size() > 1 && pageCount >= PARALLEL_MIN_PAGES;
+    }
+
+protected:
+    const char* produce() override;
+
+private:
+    // һСɨҲǴÿ̵߳Ĺ
+    struct Morsel {
+        ColumnBatch batch;
+        std::vector<uint32_t> selected;
+        std::vector<char> rows;
+        uint32_t rowCount = 0;
+        OperatorStats stats;  // ÿʱȡҳУÿʱ
+        bool failed = false;  // ҳʧ
+        bool ready = false;
+    };
+
+    bool fill();
+    bool fillParallel();
+    //  [first, last) ҳÿее visit(page, batch, selected, n)ȡҳм counters
+    // ҳʧʱ false
+    template <typename Visit>
+    bool filterPages(uint32_t first, uint32_t last, ColumnBatch& batch, uint32_t* selected,
+                     OperatorStats& counters, Visit visit);
+    bool scanMorsel(uint32_t morsel, Morsel& slot);
+    // ҳʧܺɨֹͣ
+    void readFailed() { errorMessage = "Failed to read table '" + tableName + "'"; }
+    void schedule(uint32_t morsel);
+    // ̳߳ÿ߳һȡС work(first, last, morsel, slot)ȫɺ󷵻
+    template <typename Work>
+    void forEachMorsel(Work work);
+    Morsel* newMorsel();
+
+    BufferPool& pool;
+    std::string tablePath;
+    std::string tableName;
+    ReadView view;
+    Snapshot snapshot;
+    Predicate predicate;
+    bool indexed;
+    std::vector<RID> rids;  // ҳ
+    size_t ridPos = 0;
+    uint32_t pageCount = 0;
+    uint32_t pageNo = 0;
+    TableStats* tableStats = nullptr;
+    const ZoneMap* zones = nullptr;
+    bool started = false;
+
+    ColumnBatch batch;
+    std::vector<bool> needed;  // Ҫ
+    std::vector<uint32_t> all;  // 0..BATCH_SIZE-1
+    std::vector<uint32_t> selected;
+    std::vector<char> rows;  // ǰҳе
+    uint32_t rowCount = 0;
+    uint32_t position = 0;
+
+    // ɨ裺С m Ľ morsels[m % morsels.size()]
+    ThreadPool* workers;
+    std::vector<std::unique_ptr<Morsel>> morsels;
+    uint32_t morselCount = 0;
+    uint32_t nextMorsel = 0;  // һҪύС
+    uint32_t emitMorsel = 0;  // һҪС
+    std::mutex morselMutex;
+    std::condition_variable morselReady;
+    std::unique_ptr<TaskGroup> tasks;
+};
+
+// ʱļ˳д붨Уٴͷ˳ʱɾ
+// ļݿĿ¼£ .spill βʱļ
+class SpillFile {
+public:
+    SpillFile(const std::string& dir, uint32_t rowSize);
+    ~SpillFile();
+    SpillFile(const SpillFile&) = delete;
+    SpillFile& operator=(const SpillFile&) = delete;
+
+    bool isOpen() const { return file != nullptr; }
+    bool write(const char* row);
+    // д벢صļͷ
+    bool rewind();
+    // ȡһУûиʱ nullptr
+    const char* read();
+    uint64_t rowCount() const { return rows; }
+
+private:
+    FILE* file = nullptr;
+    std::string path;
+    uint32_t rowSize;
+    std::vector<char> buffer;
+    std::vector<char> row;
+    uint64_t rows = 0;
+};
+
+#endif // OPERATOR_H
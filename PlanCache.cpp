@@ -0,0 +1,109 @@
+#include "PlanCache.h"
+#include <cctype>
+#include "DBMS.h"
+
+// ﷨
+std::shared_ptr<const ScanPlan> ParsedStatement::plan() const {
+    std::lock_guard<std::mutex> lock(planMutex);
+    return cachedPlan;
+}
+
+void ParsedStatement::setPlan(std::shared_ptr<const ScanPlan> plan) const {
+    std::lock_guard<std::mutex> lock(planMutex);
+    cachedPlan = std::move(plan);
+}
+
+//  ? ǲַת '' ʹ״̬תΣ䲻 ?
+std::string ParsedStatement::bindText(const std::string& text, const std::vector<std::string>& params,
+                                      size_t& next) {
+    std::string result;
+    result.reserve(text.size());
+    bool quoted = false;
+    for (char c : text) {
+        if (c == '\'') quoted = !quoted;
+        if (c == '?' && !quoted) {
+            result += params[next++];
+        } else {
+            result += c;
+        }
+    }
+    return result;
+}
+
+// ƻ
+std::shared_ptr<const ParsedStatement> PlanCache::find(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it == index.end()) {
+        missCount++;
+        return nullptr;
+    }
+    hitCount++;
+    entries.splice(entries.begin(), entries, it->second);
+    return it->second->second;
+}
+
+void PlanCache::insert(const std::string& key, std::shared_ptr<const ParsedStatement> statement) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it != index.end()) {
+        it->second->second = std::move(statement);
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+    entries.emplace_front(key, std::move(statement));
+    index[key] = entries.begin();
+    while (entries.size() > capacity) {
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+}
+
+size_t PlanCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+//  bindText һ'' ʹ״̬תΣַеĿհ׵
+std::string normalizeSql(const std::string& sql) {
+    std::string result;
+    result.reserve(sql.size());
+    bool quoted = false;
+    bool space = false;
+    for (char c : sql) {
+        if (c == '\'') quoted = !quoted;
+        if (!quoted && std::isspace(static_cast<unsigned char>(c))) {
+            space = true;
+            continue;
+        }
+        if (space && !result.empty()) result += ' ';
+        space = false;
+        result += c;
+    }
+    while (!result.empty() && (result.back() == ';' || result.back() == ' ')) result.pop_back();
+    return result;
+}
+
+// Ԥ
+PreparedStatement::PreparedStatement(DBMS& dbms, std::shared_ptr<const ParsedStatement> statement)
+    : dbms(dbms), statement(std::move(statement)), params(this->statement->paramCount) {}
+
+void PreparedStatement::bind(size_t index, int32_t value) {
+    if (index < params.size()) params[index] = std::to_string(value);
+}
+
+void PreparedStatement::bind(size_t index, const std::string& value) {
+    if (index < params.size()) params[index] = quoteLiteral(value);
+}
+
+bool PreparedStatement::execute(Session& session) {
+    return dbms.executePrepared(session, *statement, params);
+}
+
+std::unique_ptr<Cursor> PreparedStatement::query(Session& session) {
+    if (statement->kind != ParsedStatement::SELECT) {
+        session.out << "Error: Prepared statement is not a SELECT" << std::endl;
+        return nullptr;
+    }
+    return dbms.queryPrepared(session, *statement, params);
+}
@@ -0,0 +1,101 @@
+#ifndef PLAN_CACHE_H
+#define PLAN_CACHE_H
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Predicate.h"
+
+class DBMS;
+class Cursor;
+struct Session;
+
+// 򵥲ѯִмƻкźʹνʣṹ汾ʱ
+struct ScanPlan {
+    std::string database;
+    uint64_t schemaVersion = 0;
+    std::vector<size_t> projection;
+    Predicate predicate;
+};
+
+// Ԥ﷨ ? ʾ˳ 0 ʼ
+// ֵб SET Ӿб ? ԭģWHERE еĲ¼ Condition::param 
+struct ParsedStatement {
+    enum Kind { NONE, SELECT, INSERT, UPDATE, DELETE };
+
+    Kind kind = NONE;
+    std::string tables;                    // SELECT ıбı
+    std::string columns;                   // SELECT ѡб INSERT б
+    std::vector<std::string> rows;         // INSERT еֵб
+    std::string assignments;               // UPDATE  SET Ӿ
+    std::unique_ptr<Condition> where;
+    std::string groupBy;
+    std::string orderBy;
+    int64_t limit = -1;
+    int64_t offset = 0;
+    size_t paramCount = 0;
+    bool simple = false;  // ޾ۺϡĲѯԻִмƻ
+
+    // ִмƻɵһִʱṹıؽ
+    std::shared_ptr<const ScanPlan> plan() const;
+    void setPlan(std::shared_ptr<const ScanPlan> plan) const;
+
+    // Ѳֵб SET Ӿе ?next Ϊһ
+    static std::string bindText(const std::string& text, const std::vector<std::string>& params, size_t& next);
+
+private:
+    mutable std::mutex planMutex;
+    mutable std::shared_ptr<const ScanPlan> cachedPlan;
+};
+
+// 淶 SQL ı﷨ʱ̭δõ
+// ɱỰ߳ͬʱʹ
+class PlanCache {
+public:
+    explicit PlanCache(size_t capacity) : capacity(capacity) {}
+
+    std::shared_ptr<const ParsedStatement> find(const std::string& key);
+    void insert(const std::string& key, std::shared_ptr<const ParsedStatement> statement);
+
+    size_t size() const;
+    uint64_t hits() const { return hitCount; }
+    uint64_t misses() const { return missCount; }
+
+private:
+    typedef std::list<std::pair<std::string, std::shared_ptr<const ParsedStatement>>> Entries;
+
+    size_t capacity;
+    Entries entries;  // ʹõǰ
+    std::unordered_map<std::string, Entries::iterator> index;
+    mutable std::mutex mutex;
+    uint64_t hitCount = 0;
+    uint64_t missCount = 0;
+};
+
+// ϲհסȥβհ׺ĩβķֺţΪƻļ
+std::string normalizeSql(const std::string& sql);
+
+// DBMS::prepare صľȫԷִ
+class PreparedStatement {
+public:
+    PreparedStatement(DBMS& dbms, std::shared_ptr<const ParsedStatement> statement);
+
+    size_t paramCount() const { return statement->paramCount; }
+    void bind(size_t index, int32_t value);
+    void bind(size_t index, const std::string& value);
+    // ִ䣬ʹϢд session.out
+    bool execute(Session& session);
+    // ִ SELECT ؽα꣬ʱؿָ
+    std::unique_ptr<Cursor> query(Session& session);
+
+private:
+    DBMS& dbms;
+    std::shared_ptr<const ParsedStatement> statement;
+    std::vector<std::string> params;  //  SQL ıַ
+};
+
+#endif // PLAN_CACHE_H
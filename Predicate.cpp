@@ -0,0 +1,547 @@
+#include "Predicate.h"
+#include <cerrno>
+#include <cstdlib>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <string_view>
+
+// 
+Condition* Condition::makeCompare(const std::string& column, CompareOp op, const std::string& value) {
+    Condition* condition = new Condition();
+    condition->kind = COMPARE;
+    condition->op = op;
+    condition->column = column;
+    std::string_view text;
+    std::string buffer;
+    condition->isString = unquoteLiteral(value, text, buffer);
+    condition->value = std::string(text);
+    return condition;
+}
+
+Condition* Condition::makeColumnCompare(const std::string& column, CompareOp op, const std::string& other) {
+    Condition* condition = new Condition();
+    condition->kind = COMPARE;
+    condition->op = op;
+    condition->column = column;
+    condition->value = other;
+    condition->isColumn = true;
+    return condition;
+}
+
+Condition* Condition::makeLogical(Kind kind, Condition* left, Condition* right) {
+    Condition* condition = new Condition();
+    condition->kind = kind;
+    condition->left.reset(left);
+    condition->right.reset(right);
+    return condition;
+}
+
+Condition* Condition::bind(const std::vector<std::string>& params) const {
+    if (kind != COMPARE) return makeLogical(kind, left->bind(params), right->bind(params));
+    if (param >= 0) return makeCompare(column, op, params[param]);
+    Condition* condition = new Condition();
+    condition->op = op;
+    condition->column = column;
+    condition->value = value;
+    condition->isString = isString;
+    condition->isColumn = isColumn;
+    return condition;
+}
+
+void Condition::conjuncts(std::vector<const Condition*>& result) const {
+    if (kind == AND) {
+        left->conjuncts(result);
+        right->conjuncts(result);
+    } else {
+        result.push_back(this);
+    }
+}
+
+void Condition::columnNames(std::vector<std::string>& result) const {
+    if (kind != COMPARE) {
+        left->columnNames(result);
+        right->columnNames(result);
+        return;
+    }
+    result.push_back(column);
+    if (isColumn) result.push_back(value);
+}
+
+// 
+bool resolveColumn(const Table& table, const std::string& name, size_t& col, std::string& error) {
+    for (col = 0; col < table.columns.size(); ++col) {
+        if (table.columns[col].name == name) return true;
+    }
+    size_t dot = name.find('.');
+    if (dot != std::string::npos) {
+        // ǰ׺޶ıֱһ
+        if (name.compare(0, dot, table.name) == 0 && dot == table.name.size()) {
+            for (col = 0; col < table.columns.size(); ++col) {
+                if (table.columns[col].name == name.substr(dot + 1)) return true;
+            }
+        }
+    } else {
+        // ǰ׺׺ƥ
+        size_t found = table.columns.size();
+        for (size_t i = 0; i < table.columns.size(); ++i) {
+            const std::string& candidate = table.columns[i].name;
+            if (candidate.size() > name.size() && candidate[candidate.size() - name.size() - 1] == '.' &&
+                candidate.compare(candidate.size() - name.size(), name.size(), name) == 0) {
+                if (found != table.columns.size()) {
+                    error = "Column '" + name + "' is ambiguous";
+                    return false;
+                }
+                found = i;
+            }
+        }
+        col = found;
+        if (found != table.columns.size()) return true;
+    }
+    error = "Unknown column '" + name + "'";
+    return false;
+}
+
+// 
+bool Predicate::compile(const Condition* condition, const Table& table,
+                        const TableLayout& layout, std::string& error) {
+    nodes.clear();
+    root = -1;
+    if (!condition) return true;
+    root = compileNode(condition, table, layout, error);
+    if (root < 0) {
+        nodes.clear();
+        return false;
+    }
+    return true;
+}
+
+bool Predicate::compile(const std::vector<const Condition*>& conjuncts, const Table& table,
+                        const TableLayout& layout, std::string& error) {
+    nodes.clear();
+    root = -1;
+    for (const Condition* condition : conjuncts) {
+        int node = compileNode(condition, table, layout, error);
+        if (node < 0) {
+            nodes.clear();
+            root = -1;
+            return false;
+        }
+        if (root >= 0) {
+            Node both = {};
+            both.kind = Node::AND;
+            both.left = root;
+            both.right = node;
+            nodes.push_back(both);
+            node = static_cast<int>(nodes.size() - 1);
+        }
+        root = node;
+    }
+    return true;
+}
+
+int Predicate::compileNode(const Condition* condition, const Table& table,
+                           const TableLayout& layout, std::string& error) {
+    if (condition->kind != Condition::COMPARE) {
+        int left = compileNode(condition->left.get(), table, layout, error);
+        if (left < 0) return -1;
+        int right = compileNode(condition->right.get(), table, layout, error);
+        if (right < 0) return -1;
+
+        Node node = {};
+        node.kind = (condition->kind == Condition::AND) ? Node::AND : Node::OR;
+        node.left = left;
+        node.right = right;
+        nodes.push_back(node);
+        return static_cast<int>(nodes.size() - 1);
+    }
+
+    size_t col = 0;
+    if (!resolveColumn(table, condition->column, col, error)) return -1;
+    if (layout.types[col] != ColumnType::INT && layout.types[col] != ColumnType::CHAR) {
+        error = "Cannot compare aggregate column '" + condition->column + "'";
+        return -1;
+    }
+
+    Node node = {};
+    node.op = condition->op;
+    node.column = col;
+    node.offset = layout.offsets[col];
+    node.width = layout.widths[col];
+    node.left = node.right = -1;
+    node.param = condition->param;
+    if (condition->param >= 0) {
+        node.kind = (layout.types[col] == ColumnType::INT) ? Node::CMP_INT : Node::CMP_CHAR;
+    } else if (condition->isColumn) {
+        size_t other = 0;
+        if (!resolveColumn(table, condition->value, other, error)) return -1;
+        if (layout.types[other] != layout.types[col]) {
+            error = "Type mismatch comparing '" + condition->column + "' and '" + condition->value + "'";
+            return -1;
+        }
+        node.kind = (layout.types[col] == ColumnType::INT) ? Node::COL_INT : Node::COL_CHAR;
+        node.otherColumn = other;
+        node.otherOffset = layout.offsets[other];
+        node.otherWidth = layout.widths[other];
+    } else {
+        node.kind = (layout.types[col] == ColumnType::INT) ? Node::CMP_INT : Node::CMP_CHAR;
+        if (!setConstant(node, condition->value)) {
+            error = "Invalid integer value '" + condition->value + "' for column '" + condition->column + "'";
+            return -1;
+        }
+    }
+    nodes.push_back(node);
+    return static_cast<int>(nodes.size() - 1);
+}
+
+bool Predicate::setConstant(Node& node, const std::string& value) {
+    if (node.kind == Node::CMP_CHAR) {
+        node.charValue = value;
+        return true;
+    }
+    char* end = nullptr;
+    errno = 0;
+    long number = std::strtol(value.c_str(), &end, 10);
+    if (value.empty() || *end != '\0' || errno == ERANGE || number < INT32_MIN || number > INT32_MAX) return false;
+    node.intValue = static_cast<int32_t>(number);
+    return true;
+}
+
+// ı WHERE еĳһŵȥ
+bool Predicate::bind(const std::vector<std::string>& params, std::string& error) {
+    for (auto& node : nodes) {
+        if ((node.kind != Node::CMP_INT && node.kind != Node::CMP_CHAR) || node.param < 0) continue;
+        std::string_view text;
+        std::string buffer;
+        unquoteLiteral(params[node.param], text, buffer);
+        std::string value(text);
+        if (!setConstant(node, value)) {
+            error = "Invalid integer value '" + value + "' for parameter " + std::to_string(node.param + 1);
+            return false;
+        }
+    }
+    return true;
+}
+
+// ִмƻʾı
+std::string Predicate::describe(const Table& table) const {
+    return nodes.empty() ? "" : describeNode(root, table);
+}
+
+std::string Predicate::describeNode(int index, const Table& table) const {
+    static const char* const OPS[] = {" = ", " != ", " < ", " > "};
+    const Node& node = nodes[index];
+    switch (node.kind) {
+    case Node::AND:
+    case Node::OR:
+        return "(" + describeNode(node.left, table) + (node.kind == Node::AND ? " AND " : " OR ") +
+               describeNode(node.right, table) + ")";
+    case Node::CMP_INT:
+        return table.columns[node.column].name + OPS[static_cast<int>(node.op)] + std::to_string(node.intValue);
+    case Node::CMP_CHAR:
+        return table.columns[node.column].name + OPS[static_cast<int>(node.op)] + quoteLiteral(node.charValue);
+    case Node::COL_INT:
+    case Node::COL_CHAR:
+        return table.columns[node.column].name + OPS[static_cast<int>(node.op)] + table.columns[node.otherColumn].name;
+    }
+    return "";
+}
+
+// ֵ
+static bool compareResult(CompareOp op, int cmp) {
+    switch (op) {
+    case CompareOp::EQ: return cmp == 0;
+    case CompareOp::NE: return cmp != 0;
+    case CompareOp::LT: return cmp < 0;
+    case CompareOp::GT: return cmp > 0;
+    }
+    return false;
+}
+
+static std::string_view fieldText(const char* row, uint32_t offset, uint32_t width) {
+    const char* field = row + offset;
+    size_t len = 0;
+    while (len < width && field[len] != '\0') ++len;
+    return std::string_view(field, len);
+}
+
+bool Predicate::evaluateNode(int index, const char* row) const {
+    const Node& node = nodes[index];
+    switch (node.kind) {
+    case Node::AND:
+        return evaluateNode(node.left, row) && evaluateNode(node.right, row);
+    case Node::OR:
+        return evaluateNode(node.left, row) || evaluateNode(node.right, row);
+    case Node::CMP_INT: {
+        int32_t value;
+        std::memcpy(&value, row + node.offset, sizeof(value));
+        switch (node.op) {
+        case CompareOp::EQ: return value == node.intValue;
+        case CompareOp::NE: return value != node.intValue;
+        case CompareOp::LT: return value < node.intValue;
+        case CompareOp::GT: return value > node.intValue;
+        }
+        return false;
+    }
+    case Node::CMP_CHAR: {
+        const char* field = row + node.offset;
+        size_t len = 0;
+        while (len < node.width && field[len] != '\0') ++len;
+        size_t common = len < node.charValue.size() ? len : node.charValue.size();
+        int cmp = std::memcmp(field, node.charValue.data(), common);
+        if (cmp == 0) cmp = (len < node.charValue.size()) ? -1 : (len > node.charValue.size() ? 1 : 0);
+        switch (node.op) {
+        case CompareOp::EQ: return cmp == 0;
+        case CompareOp::NE: return cmp != 0;
+        case CompareOp::LT: return cmp < 0;
+        case CompareOp::GT: return cmp > 0;
+        }
+        return false;
+    }
+    case Node::COL_INT: {
+        int32_t value, other;
+        std::memcpy(&value, row + node.offset, sizeof(value));
+        std::memcpy(&other, row + node.otherOffset, sizeof(other));
+        return compareResult(node.op, value < other ? -1 : (value > other ? 1 : 0));
+    }
+    case Node::COL_CHAR:
+        return compareResult(node.op, fieldText(row, node.offset, node.width)
+                                          .compare(fieldText(row, node.otherOffset, node.otherWidth)));
+    }
+    return false;
+}
+
+// ΧֵcmpLowcmpHigh ΪСֵֵ볣ȽϵĽ
+static bool rangeMayMatch(CompareOp op, int cmpLow, int cmpHigh) {
+    switch (op) {
+    case CompareOp::EQ: return cmpLow <= 0 && cmpHigh >= 0;
+    case CompareOp::NE: return cmpLow != 0 || cmpHigh != 0;
+    case CompareOp::LT: return cmpLow < 0;
+    case CompareOp::GT: return cmpHigh > 0;
+    }
+    return true;
+}
+
+// бȽʱɸеķΧжϣǷ true
+bool Predicate::mayMatchNode(int index, const char* low, const char* high) const {
+    const Node& node = nodes[index];
+    switch (node.kind) {
+    case Node::AND:
+        return mayMatchNode(node.left, low, high) && mayMatchNode(node.right, low, high);
+    case Node::OR:
+        return mayMatchNode(node.left, low, high) || mayMatchNode(node.right, low, high);
+    case Node::CMP_INT: {
+        int32_t lowValue, highValue;
+        std::memcpy(&lowValue, low + node.offset, sizeof(lowValue));
+        std::memcpy(&highValue, high + node.offset, sizeof(highValue));
+        return rangeMayMatch(node.op, lowValue < node.intValue ? -1 : (lowValue > node.intValue ? 1 : 0),
+                             highValue < node.intValue ? -1 : (highValue > node.intValue ? 1 : 0));
+    }
+    case Node::CMP_CHAR:
+        return rangeMayMatch(node.op, fieldText(low, node.offset, node.width).compare(node.charValue),
+                             fieldText(high, node.offset, node.width).compare(node.charValue));
+    case Node::COL_INT:
+    case Node::COL_CHAR:
+        return true;
+    }
+    return true;
+}
+
+// ֵ
+// бȽϣѹΪѡȫѡʱѭɱԶ
+template <typename Compare>
+static uint32_t filterInts(const int32_t* values, int32_t constant, Compare compare,
+                    const uint32_t* sel, uint32_t count, bool dense, uint32_t* out) {
+    uint32_t n = 0;
+    if (dense) {
+        uint8_t mask[BATCH_SIZE];
+        for (uint32_t i = 0; i < count; ++i) {
+            mask[i] = compare(values[i], constant) ? 1 : 0;
+        }
+        for (uint32_t i = 0; i < count; ++i) {
+            out[n] = i;
+            n += mask[i];
+        }
+    } else {
+        for (uint32_t k = 0; k < count; ++k) {
+            uint32_t i = sel[k];
+            out[n] = i;
+            n += compare(values[i], constant) ? 1 : 0;
+        }
+    }
+    return n;
+}
+
+struct IntEq { bool operator()(int32_t a, int32_t b) const { return a == b; } };
+struct IntNe { bool operator()(int32_t a, int32_t b) const { return a != b; } };
+struct IntLt { bool operator()(int32_t a, int32_t b) const { return a < b; } };
+struct IntGt { bool operator()(int32_t a, int32_t b) const { return a > b; } };
+
+uint32_t Predicate::filter(const ColumnBatch& batch, const uint32_t* sel, uint32_t count, uint32_t* out) const {
+    if (nodes.empty()) {
+        for (uint32_t i = 0; i < count; ++i) out[i] = sel[i];
+        return count;
+    }
+    return filterNode(root, batch, sel, count, out);
+}
+
+uint32_t Predicate::filterNode(int index, const ColumnBatch& batch,
+                               const uint32_t* sel, uint32_t count, uint32_t* out) const {
+    const Node& node = nodes[index];
+    // ѡҲظģȵСʱΪȫѡ
+    bool dense = (count == batch.size());
+
+    switch (node.kind) {
+    case Node::AND: {
+        uint32_t temp[BATCH_SIZE];
+        uint32_t n = filterNode(node.left, batch, sel, count, temp);
+        return filterNode(node.right, batch, temp, n, out);
+    }
+    case Node::OR: {
+        // ҲֻδеֵٰкŹ鲢
+        uint32_t left[BATCH_SIZE];
+        uint32_t rest[BATCH_SIZE];
+        uint32_t right[BATCH_SIZE];
+        uint32_t nl = filterNode(node.left, batch, sel, count, left);
+        uint32_t nrest = 0;
+        for (uint32_t k = 0, j = 0; k < count; ++k) {
+            if (j < nl && left[j] == sel[k]) {
+                ++j;
+            } else {
+                rest[nrest++] = sel[k];
+            }
+        }
+        uint32_t nr = filterNode(node.right, batch, rest, nrest, right);
+        uint32_t n = 0, i = 0, j = 0;
+        while (i < nl || j < nr) {
+            if (j >= nr || (i < nl && left[i] < right[j])) {
+                out[n++] = left[i++];
+            } else {
+                out[n++] = right[j++];
+            }
+        }
+        return n;
+    }
+    case Node::CMP_INT: {
+        const int32_t* values = batch.column(node.column).ints.data();
+        switch (node.op) {
+        case CompareOp::EQ: return filterInts(values, node.intValue, IntEq(), sel, count, dense, out);
+        case CompareOp::NE: return filterInts(values, node.intValue, IntNe(), sel, count, dense, out);
+        case CompareOp::LT: return filterInts(values, node.intValue, IntLt(), sel, count, dense, out);
+        case CompareOp::GT: return filterInts(values, node.intValue, IntGt(), sel, count, dense, out);
+        }
+        return 0;
+    }
+    case Node::CMP_CHAR: {
+        const ColumnVector& vec = batch.column(node.column);
+        std::string_view constant(node.charValue);
+        uint32_t n = 0;
+        for (uint32_t k = 0; k < count; ++k) {
+            uint32_t i = sel[k];
+            int cmp = vec.getChar(i).compare(constant);
+            bool match = false;
+            switch (node.op) {
+            case CompareOp::EQ: match = (cmp == 0); break;
+            case CompareOp::NE: match = (cmp != 0); break;
+            case CompareOp::LT: match = (cmp < 0); break;
+            case CompareOp::GT: match = (cmp > 0); break;
+            }
+            out[n] = i;
+            n += match ? 1 : 0;
+        }
+        return n;
+    }
+    case Node::COL_INT: {
+        const int32_t* values = batch.column(node.column).ints.data();
+        const int32_t* others = batch.column(node.otherColumn).ints.data();
+        uint32_t n = 0;
+        for (uint32_t k = 0; k < count; ++k) {
+            uint32_t i = sel[k];
+            out[n] = i;
+            n += compareResult(node.op, values[i] < others[i] ? -1 : (values[i] > others[i] ? 1 : 0)) ? 1 : 0;
+        }
+        return n;
+    }
+    case Node::COL_CHAR: {
+        const ColumnVector& vec = batch.column(node.column);
+        const ColumnVector& other = batch.column(node.otherColumn);
+        uint32_t n = 0;
+        for (uint32_t k = 0; k < count; ++k) {
+            uint32_t i = sel[k];
+            out[n] = i;
+            n += compareResult(node.op, vec.getChar(i).compare(other.getChar(i))) ? 1 : 0;
+        }
+        return n;
+    }
+    }
+    return 0;
+}
+
+void Predicate::referencedColumns(std::vector<bool>& used) const {
+    for (const auto& node : nodes) {
+        if (node.kind == Node::AND || node.kind == Node::OR) continue;
+        used[node.column] = true;
+        if (node.kind == Node::COL_INT || node.kind == Node::COL_CHAR) used[node.otherColumn] = true;
+    }
+}
+
+void Predicate::conjuncts(std::vector<const Node*>& result) const {
+    if (root >= 0) collectConjuncts(root, result);
+}
+
+void Predicate::collectConjuncts(int index, std::vector<const Node*>& result) const {
+    const Node& node = nodes[index];
+    if (node.kind == Node::AND) {
+        collectConjuncts(node.left, result);
+        collectConjuncts(node.right, result);
+    } else if (node.kind == Node::CMP_INT || node.kind == Node::CMP_CHAR) {
+        result.push_back(&node);
+    }
+}
+
+double Predicate::selectivityNode(int index, const std::function<double(const Node&)>& leaf) const {
+    const Node& node = nodes[index];
+    if (node.kind == Node::OR) {
+        double a = selectivityNode(node.left, leaf);
+        double b = selectivityNode(node.right, leaf);
+        return a + b - a * b;
+    }
+    if (node.kind != Node::AND) return std::min(std::max(leaf(node), 0.0), 1.0);
+
+    // չ AND ͬеķΧȽϸȡϸϽ½
+    std::vector<int> terms, pending = {index};
+    while (!pending.empty()) {
+        int i = pending.back();
+        pending.pop_back();
+        if (nodes[i].kind == Node::AND) {
+            pending.push_back(nodes[i].right);
+            pending.push_back(nodes[i].left);
+        } else {
+            terms.push_back(i);
+        }
+    }
+    double result = 1.0;
+    std::map<size_t, std::pair<double, double>> ranges;  // к -> (<, >) ѡʣûʱΪ -1
+    for (int i : terms) {
+        const Node& term = nodes[i];
+        bool range = (term.kind == Node::CMP_INT || term.kind == Node::CMP_CHAR) &&
+                     (term.op == CompareOp::LT || term.op == CompareOp::GT);
+        if (!range) {
+            result *= selectivityNode(i, leaf);
+            continue;
+        }
+        auto& bounds = ranges.emplace(term.column, std::make_pair(-1.0, -1.0)).first->second;
+        double& bound = (term.op == CompareOp::LT) ? bounds.first : bounds.second;
+        double s = selectivityNode(i, leaf);
+        bound = bound < 0 ? s : std::min(bound, s);
+    }
+    for (const auto& entry : ranges) {
+        double below = entry.second.first, above = entry.second.second;
+        if (below >= 0 && above >= 0) {
+            result *= std::max(below + above - 1.0, 0.0);
+        } else {
+            result *= below >= 0 ? below : above;
+        }
+    }
+    return result;
+}
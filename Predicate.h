@@ -0,0 +1,121 @@
+#ifndef PREDICATE_H
+#define PREDICATE_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Schema.h"
+#include "Storage.h"
+#include "ColumnBatch.h"
+
+// Ƚ
+enum class CompareOp {
+    EQ,
+    NE,
+    LT,
+    GT
+};
+
+// ﷨׶ɵ WHERE 
+struct Condition {
+    enum Kind { COMPARE, AND, OR };
+
+    Kind kind = COMPARE;
+    CompareOp op = CompareOp::EQ;
+    std::string column;
+    std::string value;      // ıȥţбȽʱΪҲ
+    bool isString = false;  // ǷΪŵַ
+    bool isColumn = false;  // ҲǷΪ
+    int param = -1;         // ԤҲΪʱĲţִֵʱ
+    std::unique_ptr<Condition> left;
+    std::unique_ptr<Condition> right;
+
+    static Condition* makeCompare(const std::string& column, CompareOp op, const std::string& value);
+    static Condition* makeColumnCompare(const std::string& column, CompareOp op, const std::string& other);
+    static Condition* makeLogical(Kind kind, Condition* left, Condition* right);
+    // params Ϊ SQL ı
+    Condition* bind(const std::vector<std::string>& params) const;
+
+    // Ѷ AND ɺȡ
+    void conjuncts(std::vector<const Condition*>& result) const;
+    // ռõ
+    void columnNames(std::vector<std::string>& result) const;
+};
+
+// ƲУ֧޶ t.colδ޶Ҳƥ t.col У
+// ΨһҲʱ false  error
+bool resolveColumn(const Table& table, const std::string& name, size_t& col, std::string& error);
+
+// ԾνʣƫѽתΪӦ
+class Predicate {
+public:
+    struct Node {
+        enum Kind { CMP_INT, CMP_CHAR, COL_INT, COL_CHAR, AND, OR };
+
+        Kind kind;
+        CompareOp op;
+        size_t column;
+        uint32_t offset;
+        uint32_t width;
+        int32_t intValue;
+        std::string charValue;
+        // бȽʱҲ
+        size_t otherColumn;
+        uint32_t otherOffset;
+        uint32_t otherWidth;
+        int left;
+        int right;
+        int param;  // ȽʱĲţΪ -1
+    };
+
+    // condition Ϊձʾƥ
+    bool compile(const Condition* condition, const Table& table,
+                 const TableLayout& layout, std::string& error);
+    // ɺȡбΪձʾƥ
+    bool compile(const std::vector<const Condition*>& conjuncts, const Table& table,
+                 const TableLayout& layout, std::string& error);
+    // ֵԸƺ԰
+    bool bind(const std::vector<std::string>& params, std::string& error);
+
+    bool empty() const { return nodes.empty(); }
+    bool evaluate(const char* row) const { return nodes.empty() || evaluateNode(root, row); }
+    bool evaluate(const RowView& row) const { return evaluate(row.raw()); }
+    // һÿеСֵΪ lowֵΪ high(иʽ)ʱǷ
+    bool mayMatch(const char* low, const char* high) const { return nodes.empty() || mayMatchNode(root, low, high); }
+
+    // ֵsel Ϊѡ(к)ƥкд outƥ
+    uint32_t filter(const ColumnBatch& batch, const uint32_t* sel, uint32_t count, uint32_t* out) const;
+    // νõ
+    void referencedColumns(std::vector<bool>& used) const;
+
+    // ıȡ table "(age > 30 AND name = 'x')"
+    std::string describe(const Table& table) const;
+
+    //  AND 볣Ƚϵνʣѡʹ
+    void conjuncts(std::vector<const Node*>& result) const;
+    // еıleaf ƵȽϣAND ĸΪˣOR Ϊ a + b - ab
+    // ͬһ AND ͬһе <  > 䣬 a + b - 1 ϲ
+    double selectivity(const std::function<double(const Node&)>& leaf) const {
+        return nodes.empty() ? 1.0 : selectivityNode(root, leaf);
+    }
+
+private:
+    int compileNode(const Condition* condition, const Table& table,
+                    const TableLayout& layout, std::string& error);
+    // ѳıתΪڵıȽֵЧʱ false
+    static bool setConstant(Node& node, const std::string& value);
+    bool evaluateNode(int index, const char* row) const;
+    bool mayMatchNode(int index, const char* low, const char* high) const;
+    uint32_t filterNode(int index, const ColumnBatch& batch,
+                        const uint32_t* sel, uint32_t count, uint32_t* out) const;
+    void collectConjuncts(int index, std::vector<const Node*>& result) const;
+    double selectivityNode(int index, const std::function<double(const Node&)>& leaf) const;
+    std::string describeNode(int index, const Table& table) const;
+
+    std::vector<Node> nodes;
+    int root = -1;
+};
+
+#endif // PREDICATE_H
\ No newline at end of file
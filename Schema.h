@@ -0,0 +1,36 @@
+#ifndef SCHEMA_H
+#define SCHEMA_H
+
+#include <string>
+#include <vector>
+
+// е
+enum class ColumnType {
+    INT,
+    CHAR,
+    // ֻھۺϽУڽ
+    BIGINT,
+    DOUBLE
+};
+
+// еĽṹ
+struct Column {
+    std::string name;
+    ColumnType type;
+    int size;  //  CHAR ʹ
+};
+
+// Ľṹ
+struct IndexInfo {
+    std::string name;
+    std::string column;
+};
+
+// Ľṹ
+struct Table {
+    std::string name;
+    std::vector<Column> columns;
+    std::vector<IndexInfo> indexes;
+};
+
+#endif // SCHEMA_H
\ No newline at end of file
@@ -0,0 +1,229 @@
+#include "Server.h"
+#include "SqlParser.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <streambuf>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#define closeSocket(s) closesocket(static_cast<SOCKET>(s))
+#define SHUT_RDWR SD_BOTH
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define closeSocket(s) close(static_cast<int>(s))
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+static bool sendAll(Server::Socket socket, const char* data, size_t size) {
+    while (size > 0) {
+        int chunk = static_cast<int>(std::min<size_t>(size, 1 << 20));
+        int sent = static_cast<int>(send(socket, data, chunk, MSG_NOSIGNAL));
+        if (sent <= 0) return false;
+        data += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+// Ự壬д flush ʱ͸ͻˣӶϿ
+class SocketBuffer : public std::streambuf {
+public:
+    explicit SocketBuffer(Server::Socket socket) : socket(socket), buffer(64 * 1024) {
+        setp(buffer.data(), buffer.data() + buffer.size());
+    }
+    bool isOpen() const { return open; }
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (sync() != 0) return traits_type::eof();
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    int sync() override {
+        size_t size = pptr() - pbase();
+        if (open && size > 0 && !sendAll(socket, pbase(), size)) open = false;
+        setp(buffer.data(), buffer.data() + buffer.size());
+        return 0;
+    }
+
+private:
+    Server::Socket socket;
+    std::vector<char> buffer;
+    bool open = true;
+};
+
+Server::Server(DBMS& dbms, size_t threadCount)
+    : dbms(dbms), threadCount(threadCount > 0 ? threadCount : 1) {
+}
+
+Server::~Server() {
+    stop();
+    if (listener != -1) closeSocket(listener);
+    if (!socketPath.empty()) std::remove(socketPath.c_str());
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+bool Server::listen(const std::string& address) {
+#ifdef _WIN32
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        std::cout << "Error: Failed to initialize Winsock." << std::endl;
+        return false;
+    }
+#endif
+    bool isPort = !address.empty() && address.find_first_not_of("0123456789") == std::string::npos;
+    if (isPort) {
+        // ֻػַ
+        listener = socket(AF_INET, SOCK_STREAM, 0);
+        if (listener == -1) {
+            std::cout << "Error: Failed to create socket." << std::endl;
+            return false;
+        }
+        int reuse = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+        sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(std::stoi(address)));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            std::cout << "Error: Cannot bind to port " << address << "." << std::endl;
+            return false;
+        }
+    } else {
+#ifdef _WIN32
+        std::cout << "Error: Unix domain sockets are not supported on this platform." << std::endl;
+        return false;
+#else
+        sockaddr_un addr;
+        std::memset(&addr, 0, sizeof(addr));
+        if (address.size() >= sizeof(addr.sun_path)) {
+            std::cout << "Error: Socket path too long." << std::endl;
+            return false;
+        }
+        listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listener == -1) {
+            std::cout << "Error: Failed to create socket." << std::endl;
+            return false;
+        }
+        addr.sun_family = AF_UNIX;
+        std::strcpy(addr.sun_path, address.c_str());
+        unlink(address.c_str());
+        if (bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            std::cout << "Error: Cannot bind to '" << address << "'." << std::endl;
+            return false;
+        }
+        socketPath = address;
+#endif
+    }
+    if (::listen(listener, SOMAXCONN) != 0) {
+        std::cout << "Error: Failed to listen on '" << address << "'." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void Server::run() {
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers.emplace_back(&Server::worker, this);
+    }
+
+    while (!stopping) {
+        Socket client = accept(listener, nullptr, nullptr);
+        if (client == -1) {
+            if (stopping) break;
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(client);
+        ready.notify_one();
+    }
+
+    // رӣȴִе
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (Socket client : pending) closeSocket(client);
+        pending.clear();
+        for (Socket client : active) shutdown(client, SHUT_RDWR);
+        ready.notify_all();
+    }
+    for (auto& worker : workers) worker.join();
+    workers.clear();
+}
+
+void Server::stop() {
+    if (stopping.exchange(true)) return;
+    if (listener != -1) shutdown(listener, SHUT_RDWR);
+}
+
+void Server::worker() {
+    while (true) {
+        Socket client;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [this] { return stopping || !pending.empty(); });
+            if (pending.empty()) return;
+            client = pending.front();
+            pending.pop_front();
+            active.insert(client);
+        }
+        serve(client);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            active.erase(client);
+        }
+        closeSocket(client);
+    }
+}
+
+// жȡ䣬뽻ģʽһȱʡķֺŻԶ
+void Server::serve(Socket client) {
+    SocketBuffer buffer(client);
+    std::ostream out(&buffer);
+    Session session(out);
+
+    std::string input;
+    std::vector<char> chunk(4096);
+    size_t scanned = 0;
+    out << "SQL> " << std::flush;
+    while (buffer.isOpen()) {
+        size_t newline = input.find('\n', scanned);
+        if (newline == std::string::npos) {
+            scanned = input.size();
+            int received = static_cast<int>(recv(client, chunk.data(), static_cast<int>(chunk.size()), 0));
+            if (received <= 0) break;
+            input.append(chunk.data(), received);
+            continue;
+        }
+
+        std::string line = input.substr(0, newline);
+        input.erase(0, newline + 1);
+        scanned = 0;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line == "EXIT" || line == "exit") break;
+        if (!line.empty()) {
+            if (line.back() != ';') line += ";";
+            executeSql(dbms, session, line);
+        }
+        out << "SQL> " << std::flush;
+    }
+    // ӶϿʱعδύ
+    dbms.closeSession(session);
+    out.flush();
+}
@@ -0,0 +1,49 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "DBMS.h"
+
+// Ự SQL 
+// ÿһỰͻÿηһ䣬ִнʾ "SQL> "
+// Ŷӽ̶Ĺ̴߳ͬỰ SELECT Բִ
+class Server {
+public:
+    typedef std::intptr_t Socket;
+
+    Server(DBMS& dbms, size_t threadCount);
+    ~Server();
+
+    // address Ϊ˿ںʱ 127.0.0.1 ϵ TCP ˿ڣΪ Unix ׽·
+    bool listen(const std::string& address);
+    // ֱ stop ãǰȴлỰ
+    void run();
+    // ֻرռ׽֣źŴе
+    void stop();
+
+private:
+    void worker();
+    void serve(Socket client);
+
+    DBMS& dbms;
+    size_t threadCount;
+    Socket listener = -1;
+    std::string socketPath;
+    std::atomic<bool> stopping{false};
+
+    std::vector<std::thread> workers;
+    std::deque<Socket> pending;   // ѽܡȴ̴߳
+    std::set<Socket> active;      // ڴӣֹͣʱһر
+    std::mutex mutex;
+    std::condition_variable ready;
+};
+
+#endif // SERVER_H
@@ -0,0 +1,228 @@
+#include "Sort.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <string_view>
+
+static size_t charLength(const char* p, uint32_t width) {
+    size_t len = 0;
+    while (len < width && p[len] != '\0') ++len;
+    return len;
+}
+
+template <typename T>
+static int compareAs(const char* a, const char* b) {
+    T x, y;
+    std::memcpy(&x, a, sizeof(T));
+    std::memcpy(&y, b, sizeof(T));
+    return (x < y) ? -1 : (x > y ? 1 : 0);
+}
+
+// ι鲢
+RunMerger::RunMerger(std::vector<std::unique_ptr<SpillFile>> runs, const Less& less)
+    : runs(std::move(runs)), less(less) {
+    heads.resize(this->runs.size());
+    for (size_t i = 0; i < this->runs.size(); ++i) {
+        heads[i] = this->runs[i]->read();
+        if (heads[i]) heap.push_back(i);
+    }
+    std::make_heap(heap.begin(), heap.end(), [this](size_t a, size_t b) { return after(a, b); });
+}
+
+//  a ĵǰǷڶ b ĵǰ֮ʱκŴں
+bool RunMerger::after(size_t a, size_t b) const {
+    if (less(heads[b], heads[a])) return true;
+    if (less(heads[a], heads[b])) return false;
+    return a > b;
+}
+
+const char* RunMerger::next() {
+    auto cmp = [this](size_t a, size_t b) { return after(a, b); };
+    if (popped) {
+        popped = false;
+        size_t run = heap.back();
+        heads[run] = runs[run]->read();
+        if (heads[run]) {
+            std::push_heap(heap.begin(), heap.end(), cmp);
+        } else {
+            heap.pop_back();
+        }
+    }
+    if (heap.empty()) return nullptr;
+    std::pop_heap(heap.begin(), heap.end(), cmp);
+    popped = true;
+    return heads[heap.back()];
+}
+
+// 
+SortOperator::SortOperator(std::unique_ptr<Operator> input, const std::vector<SortKey>& keys, uint64_t limit,
+                           const std::string& spillDir, size_t memoryLimit)
+    : input(std::move(input)), sortKeys(keys), limit(limit), spillDir(spillDir), memoryLimit(memoryLimit) {
+    setSchema(this->input->schema());
+    rowSize = outLayout.rowSize;
+    for (const auto& key : keys) {
+        this->keys.push_back({outLayout.offsets[key.column], outLayout.widths[key.column],
+                              outLayout.types[key.column], key.descending});
+    }
+}
+
+uint64_t SortOperator::estimatedRows() const {
+    uint64_t rows = input->estimatedRows();
+    return limit > 0 ? std::min(limit, rows) : rows;
+}
+
+std::string SortOperator::describe() const {
+    std::string text = bounded() ? "Top-N Sort (" : "Sort (";
+    for (size_t i = 0; i < sortKeys.size(); ++i) {
+        if (i > 0) text += ", ";
+        text += outSchema.columns[sortKeys[i].column].name + (sortKeys[i].descending ? " DESC" : "");
+    }
+    text += ")";
+    if (limit > 0) text += " limit: " + std::to_string(limit);
+    return text;
+}
+
+// Ҫŵýڴʱֻǰ limit 
+bool SortOperator::bounded() const {
+    return limit > 0 && limit <= memoryLimit / (rowSize + sizeof(uint32_t));
+}
+
+// CHAR аȥݱȽ
+bool SortOperator::less(const char* a, const char* b) const {
+    for (const auto& key : keys) {
+        const char* x = a + key.offset;
+        const char* y = b + key.offset;
+        int cmp;
+        switch (key.type) {
+        case ColumnType::INT: cmp = compareAs<int32_t>(x, y); break;
+        case ColumnType::BIGINT: cmp = compareAs<int64_t>(x, y); break;
+        case ColumnType::DOUBLE: cmp = compareAs<double>(x, y); break;
+        default:
+            cmp = std::string_view(x, charLength(x, key.width)).compare(std::string_view(y, charLength(y, key.width)));
+            break;
+        }
+        if (cmp != 0) return key.descending ? cmp > 0 : cmp < 0;
+    }
+    return false;
+}
+
+void SortOperator::appendRow(const char* row) {
+    rows.insert(rows.end(), row, row + rowSize);
+    rowCount++;
+}
+
+// ѶΪѱһУ֮ǰʱ滻
+bool SortOperator::topN() {
+    auto cmp = [this](uint32_t a, uint32_t b) { return less(rowAt(a), rowAt(b)); };
+    while (const char* row = input->next()) {
+        if (rowCount < limit) {
+            order.push_back(rowCount);
+            appendRow(row);
+            std::push_heap(order.begin(), order.end(), cmp);
+        } else if (less(row, rowAt(order.front()))) {
+            std::pop_heap(order.begin(), order.end(), cmp);
+            std::memcpy(rows.data() + static_cast<size_t>(order.back()) * rowSize, row, rowSize);
+            std::push_heap(order.begin(), order.end(), cmp);
+        }
+    }
+    std::sort_heap(order.begin(), order.end(), cmp);
+    return input->error().empty();
+}
+
+bool SortOperator::sortAll() {
+    size_t perRow = rowSize + sizeof(uint32_t);
+    while (const char* row = input->next()) {
+        if (rowCount > 0 && static_cast<size_t>(rowCount + 1) * perRow > memoryLimit && !writeRun()) return false;
+        appendRow(row);
+    }
+    if (!input->error().empty()) return false;
+
+    order.resize(rowCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return less(rowAt(a), rowAt(b)); });
+    if (runs.empty()) return true;
+    return (rowCount == 0 || writeRun()) && mergeRuns();
+}
+
+// ڴźдһ
+bool SortOperator::writeRun() {
+    if (order.size() != rowCount) {
+        order.resize(rowCount);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return less(rowAt(a), rowAt(b)); });
+    }
+    std::unique_ptr<SpillFile> run(new SpillFile(spillDir, rowSize));
+    stats.spillFiles++;
+    bool ok = run->isOpen();
+    for (uint32_t i = 0; ok && i < rowCount; ++i) ok = run->write(rowAt(order[i]));
+    if (!ok || !run->rewind()) {
+        errorMessage = "Failed to write temporary file in '" + spillDir + "'";
+        return false;
+    }
+    runs.push_back(std::move(run));
+    rows.clear();
+    order.clear();
+    rowCount = 0;
+    return true;
+}
+
+// 鲢·ʱ鲢ÿһڵÿ MERGE_WAYS ι鲢һΣֶεȺ˳
+// ֱʣ² MERGE_WAYS Σÿÿһֻдһ
+bool SortOperator::mergeRuns() {
+    RunMerger::Less lessRow = [this](const char* a, const char* b) { return less(a, b); };
+    while (runs.size() > MERGE_WAYS) {
+        std::vector<std::unique_ptr<SpillFile>> level;
+        for (size_t start = 0; start < runs.size(); start += MERGE_WAYS) {
+            size_t end = std::min(start + MERGE_WAYS, runs.size());
+            if (end - start == 1) {
+                level.push_back(std::move(runs[start]));
+                continue;
+            }
+            std::vector<std::unique_ptr<SpillFile>> group;
+            for (size_t i = start; i < end; ++i) group.push_back(std::move(runs[i]));
+
+            std::unique_ptr<SpillFile> merged(new SpillFile(spillDir, rowSize));
+            stats.spillFiles++;
+            bool ok = merged->isOpen();
+            RunMerger groupMerger(std::move(group), lessRow);
+            while (ok) {
+                const char* row = groupMerger.next();
+                if (!row) break;
+                ok = merged->write(row);
+            }
+            if (!ok || !merged->rewind()) {
+                errorMessage = "Failed to write temporary file in '" + spillDir + "'";
+                return false;
+            }
+            level.push_back(std::move(merged));
+        }
+        runs = std::move(level);
+    }
+    merger.reset(new RunMerger(std::move(runs), lessRow));
+    runs.clear();
+    return true;
+}
+
+const char* SortOperator::produce() {
+    if (done) return nullptr;
+    if (!started) {
+        started = true;
+        if (!(bounded() ? topN() : sortAll())) done = true;
+    }
+
+    if (!done) {
+        if (merger) {
+            if (const char* row = merger->next()) return row;
+        } else if (emitPos < order.size()) {
+            return rowAt(order[emitPos++]);
+        }
+    }
+
+    done = true;
+    rows.clear();
+    order.clear();
+    runs.clear();
+    merger.reset();
+    if (errorMessage.empty()) errorMessage = input->error();
+    return nullptr;
+}
@@ -0,0 +1,90 @@
+#ifndef SORT_H
+#define SORT_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Operator.h"
+
+// екźͷ
+struct SortKey {
+    size_t column;
+    bool descending;
+};
+
+// ·鲢ļȵаε˳
+class RunMerger {
+public:
+    typedef std::function<bool(const char*, const char*)> Less;
+
+    RunMerger(std::vector<std::unique_ptr<SpillFile>> runs, const Less& less);
+
+    // ȡһУصһεǰЧ
+    const char* next();
+
+private:
+    bool after(size_t a, size_t b) const;
+
+    std::vector<std::unique_ptr<SpillFile>> runs;
+    Less less;
+    std::vector<const char*> heads;  // εǰ
+    std::vector<size_t> heap;        // κţѶΪǰС
+    bool popped = false;             // ϴǶѶεУ´ȶöεһ
+};
+
+// ڴԤֱ򣻳ʱÿһźдһļ
+// ·鲢鲢·ʱȷ鲢ɸĶ
+// limit ʾֻҪǰ limit Уǰ limit зŵýڴʱôСΪ limit Ķɸѡ
+class SortOperator : public Operator {
+public:
+    SortOperator(std::unique_ptr<Operator> input, const std::vector<SortKey>& keys, uint64_t limit,
+                 const std::string& spillDir, size_t memoryLimit);
+
+    uint64_t estimatedRows() const override;
+    std::string describe() const override;
+    std::vector<Operator*> inputs() const override { return {input.get()}; }
+
+protected:
+    const char* produce() override;
+
+private:
+    static const size_t MERGE_WAYS = 64;
+
+    struct KeyField {
+        uint32_t offset;
+        uint32_t width;
+        ColumnType type;
+        bool descending;
+    };
+
+    bool bounded() const;
+    // a Ƿ b ֮ǰ
+    bool less(const char* a, const char* b) const;
+    const char* rowAt(uint32_t index) const { return rows.data() + static_cast<size_t>(index) * rowSize; }
+    void appendRow(const char* row);
+    bool topN();
+    bool sortAll();
+    bool writeRun();
+    bool mergeRuns();
+
+    std::unique_ptr<Operator> input;
+    std::vector<SortKey> sortKeys;
+    std::vector<KeyField> keys;
+    uint64_t limit;
+    std::string spillDir;
+    size_t memoryLimit;
+    uint32_t rowSize;
+
+    std::vector<char> rows;
+    std::vector<uint32_t> order;  // źк
+    uint32_t rowCount = 0;
+    std::vector<std::unique_ptr<SpillFile>> runs;
+    std::unique_ptr<RunMerger> merger;
+    uint32_t emitPos = 0;
+    bool started = false;
+    bool done = false;
+};
+
+#endif // SORT_H
@@ -0,0 +1,120 @@
+#include "SqlParser.h"
+#include <charconv>
+#include <fstream>
+#include <iterator>
+#include "parser.tab.h"
+
+// flex ɨĽӿڣ lex.yy.c 
+typedef struct yy_buffer_state* YY_BUFFER_STATE;
+int yylex_init_extra(Arena* extra, yyscan_t* scanner);
+int yylex_destroy(yyscan_t scanner);
+YY_BUFFER_STATE yy_scan_buffer(char* base, size_t size, yyscan_t scanner);
+void yy_delete_buffer(YY_BUFFER_STATE buffer, yyscan_t scanner);
+
+// ɨֱӶȡڴеıtext ĩβ 0 ֽ
+// ﷨ı arena Уÿʱջأǰȫջ
+static bool parseBuffer(DBMS& dbms, Session& session, std::string& text, Arena& arena,
+                        ParsedStatement* prepared = nullptr) {
+    yyscan_t scanner;
+    if (yylex_init_extra(&arena, &scanner) != 0) {
+        session.out << "Error: Failed to initialize scanner" << std::endl;
+        return false;
+    }
+    YY_BUFFER_STATE buffer = yy_scan_buffer(&text[0], text.size(), scanner);
+    int result = buffer ? yyparse(scanner, &dbms, &session, prepared, &arena) : 1;
+    if (buffer) yy_delete_buffer(buffer, scanner);
+    yylex_destroy(scanner);
+    arena.reset();
+    return result == 0;
+}
+
+bool executeSql(DBMS& dbms, Session& session, const std::string& sql) {
+    std::string text;
+    text.reserve(sql.size() + 2);
+    text.append(sql).append(2, '\0');
+    return parseBuffer(dbms, session, text, session.arena);
+}
+
+bool parseStatement(DBMS& dbms, Session& session, const std::string& sql, ParsedStatement& statement) {
+    std::string text;
+    text.reserve(sql.size() + 2);
+    text.append(sql).append(2, '\0');
+    // ִ PREPAREEXECUTE ﷨еãջػỰ arena ı
+    Arena arena(1024);
+    return parseBuffer(dbms, session, text, arena, &statement) && statement.kind != ParsedStatement::NONE;
+}
+
+bool executeScript(DBMS& dbms, Session& session, const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        session.out << "Error: Cannot open file '" << path << "'." << std::endl;
+        return false;
+    }
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    text.append(2, '\0');
+    return parseBuffer(dbms, session, text, session.arena);
+}
+
+// һ롢Ϊ 15 ĵԪ
+static void appendCell(std::string& out, std::string_view text) {
+    out.append(text.data(), text.size());
+    if (text.size() < 15) out.append(15 - text.size(), ' ');
+}
+
+// д뻺
+void printResult(Cursor& cursor, std::ostream& stream) {
+    const size_t flushBytes = 64 * 1024;
+    std::string out;
+    out.reserve(flushBytes + 4096);
+
+    for (size_t i = 0; i < cursor.columnCount(); ++i) {
+        appendCell(out, cursor.columnName(i));
+    }
+    out += '\n';
+    for (size_t i = 0; i < cursor.columnCount(); ++i) {
+        out += "---------------";
+    }
+    out += '\n';
+
+    std::vector<ColumnType> types(cursor.columnCount());
+    for (size_t i = 0; i < cursor.columnCount(); ++i) {
+        types[i] = cursor.columnType(i);
+    }
+
+    size_t rowCount = 0;
+    ResultRow row;
+    char number[352];  // ɶʽ double
+    while (cursor.next(row)) {
+        for (size_t i = 0; i < types.size(); ++i) {
+            char* end = number;
+            switch (types[i]) {
+            case ColumnType::INT:
+                end = std::to_chars(number, number + sizeof(number), row.getInt(i)).ptr;
+                break;
+            case ColumnType::BIGINT:
+                end = std::to_chars(number, number + sizeof(number), row.getBigint(i)).ptr;
+                break;
+            case ColumnType::DOUBLE:
+                end = std::to_chars(number, number + sizeof(number), row.getDouble(i),
+                                    std::chars_format::fixed, 4).ptr;
+                break;
+            case ColumnType::CHAR:
+                appendCell(out, row.getChar(i));
+                continue;
+            }
+            appendCell(out, std::string_view(number, end - number));
+        }
+        out += '\n';
+        rowCount++;
+        if (out.size() >= flushBytes) {
+            stream.write(out.data(), out.size());
+            out.clear();
+        }
+    }
+    stream.write(out.data(), out.size());
+    if (!cursor.error().empty()) {
+        stream << "Error: " << cursor.error() << std::endl;
+        return;
+    }
+    stream << rowCount << " row(s) in set" << std::endl;
+}
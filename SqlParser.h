@@ -0,0 +1,19 @@
+#ifndef SQL_PARSER_H
+#define SQL_PARSER_H
+
+#include <ostream>
+#include <string>
+#include "DBMS.h"
+
+// ִһ SQL ı԰䣬ʹϢд session.out
+// ÿεʹöɨͬ߳̿ͬʱ
+bool executeSql(DBMS& dbms, Session& session, const std::string& sql);
+// űļִе䣬Կ
+bool executeScript(DBMS& dbms, Session& session, const std::string& path);
+// ֻһɾĲ䣬 statementִУʱϢ false
+bool parseStatement(DBMS& dbms, Session& session, const std::string& sql, ParsedStatement& statement);
+
+//  SELECT α겢
+void printResult(Cursor& cursor, std::ostream& out);
+
+#endif // SQL_PARSER_H
@@ -0,0 +1,277 @@
+#include "Statistics.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include "Hash.h"
+
+static const char STATS_MAGIC[4] = {'S', 'T', 'A', 'T'};
+
+template <typename T>
+static void put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+static bool get(const char*& p, const char* end, T& value) {
+    if (static_cast<size_t>(end - p) < sizeof(T)) return false;
+    std::memcpy(&value, p, sizeof(T));
+    p += sizeof(T);
+    return true;
+}
+
+// źĳֵͳƲֵͬȡֱͼı߽
+// ֻ˲ʱֻһεֵĸܵĲֵͬ(Haas-Stokes  Duj1 )
+template <typename T>
+static void summarize(std::vector<T>& values, uint64_t total, double& distinct, std::vector<T>& bounds) {
+    std::sort(values.begin(), values.end());
+    size_t n = values.size();
+    double seen = 0, once = 0;
+    for (size_t i = 0; i < n;) {
+        size_t j = i + 1;
+        while (j < n && values[j] == values[i]) ++j;
+        seen++;
+        if (j - i == 1) once++;
+        i = j;
+    }
+    if (n >= total || once == 0) {
+        distinct = seen;
+    } else {
+        distinct = n * seen / (n - once + once * n / static_cast<double>(total));
+        distinct = std::min(std::max(distinct, seen), static_cast<double>(total));
+    }
+    bounds.clear();
+    if (n == 0) return;
+    size_t buckets = std::min<size_t>(HISTOGRAM_BUCKETS, n - 1);
+    for (size_t i = 0; i <= buckets; ++i) {
+        bounds.push_back(values[buckets == 0 ? 0 : i * (n - 1) / buckets]);
+    }
+}
+
+TableStatistics TableStatistics::build(const TableLayout& layout, const std::vector<char>& sample,
+                                       uint64_t total, uint32_t pageCount) {
+    TableStatistics result;
+    result.rows = total;
+    result.pages = pageCount;
+    result.columns.resize(layout.types.size());
+    size_t n = sample.size() / layout.rowSize;
+    for (size_t col = 0; col < layout.types.size(); ++col) {
+        ColumnStatistics& column = result.columns[col];
+        if (layout.types[col] == ColumnType::INT) {
+            std::vector<int32_t> values(n);
+            for (size_t i = 0; i < n; ++i) values[i] = RowView(&sample[i * layout.rowSize], layout).getInt(col);
+            summarize(values, total, column.distinct, column.ints);
+        } else {
+            std::vector<std::string> values(n);
+            for (size_t i = 0; i < n; ++i) {
+                values[i] = std::string(RowView(&sample[i * layout.rowSize], layout).getChar(col));
+            }
+            summarize(values, total, column.distinct, column.chars);
+        }
+    }
+    return result;
+}
+
+// ļݣʶеͺͿȡҳÿеĲֱֵͬͼ߽磬У
+bool TableStatistics::save(const std::string& path, const TableLayout& layout) const {
+    std::string data(STATS_MAGIC, sizeof(STATS_MAGIC));
+    put<uint32_t>(data, static_cast<uint32_t>(layout.types.size()));
+    for (size_t i = 0; i < layout.types.size(); ++i) {
+        put<uint8_t>(data, static_cast<uint8_t>(layout.types[i]));
+        put<uint32_t>(data, layout.widths[i]);
+    }
+    put<uint64_t>(data, rows);
+    put<uint32_t>(data, pages);
+    for (size_t i = 0; i < columns.size(); ++i) {
+        const ColumnStatistics& column = columns[i];
+        put<double>(data, column.distinct);
+        if (layout.types[i] == ColumnType::INT) {
+            put<uint32_t>(data, static_cast<uint32_t>(column.ints.size()));
+            for (int32_t value : column.ints) put<int32_t>(data, value);
+        } else {
+            put<uint32_t>(data, static_cast<uint32_t>(column.chars.size()));
+            for (const auto& value : column.chars) {
+                put<uint32_t>(data, static_cast<uint32_t>(value.size()));
+                data += value;
+            }
+        }
+    }
+    put<uint64_t>(data, hashBytes(data.data(), data.size()));
+
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.write(data.data(), data.size()) || !file.flush()) return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    return !ec;
+}
+
+bool TableStatistics::load(const std::string& path, const TableLayout& layout) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    uint64_t checksum;
+    if (data.size() < sizeof(STATS_MAGIC) + sizeof(checksum)) return false;
+    size_t size = data.size() - sizeof(checksum);
+    std::memcpy(&checksum, data.data() + size, sizeof(checksum));
+    if (checksum != hashBytes(data.data(), size) || std::memcmp(data.data(), STATS_MAGIC, sizeof(STATS_MAGIC)) != 0) {
+        return false;
+    }
+
+    const char* p = data.data() + sizeof(STATS_MAGIC);
+    const char* end = data.data() + size;
+    uint32_t columnCount;
+    if (!get(p, end, columnCount) || columnCount != layout.types.size()) return false;
+    for (size_t i = 0; i < columnCount; ++i) {
+        uint8_t type;
+        uint32_t width;
+        if (!get(p, end, type) || !get(p, end, width)) return false;
+        if (type != static_cast<uint8_t>(layout.types[i]) || width != layout.widths[i]) return false;
+    }
+    if (!get(p, end, rows) || !get(p, end, pages)) return false;
+    columns.assign(columnCount, ColumnStatistics());
+    for (size_t i = 0; i < columnCount; ++i) {
+        ColumnStatistics& column = columns[i];
+        uint32_t count;
+        if (!get(p, end, column.distinct) || !get(p, end, count)) return false;
+        for (uint32_t k = 0; k < count; ++k) {
+            if (layout.types[i] == ColumnType::INT) {
+                int32_t value;
+                if (!get(p, end, value)) return false;
+                column.ints.push_back(value);
+            } else {
+                uint32_t length;
+                if (!get(p, end, length) || static_cast<size_t>(end - p) < length) return false;
+                column.chars.emplace_back(p, length);
+                p += length;
+            }
+        }
+    }
+    return p == end;
+}
+
+double TableStatistics::estimatedRows(uint32_t pageCount) const {
+    if (pages == 0) return static_cast<double>(rows);
+    return static_cast<double>(rows) * pageCount / pages;
+}
+
+double TableStatistics::selectivity(const Predicate& predicate) const {
+    return predicate.selectivity([this](const Predicate::Node& node) { return compareSelectivity(node); });
+}
+
+double TableStatistics::distinctValues(size_t col, double rowCount) const {
+    return std::max(std::min(columns[col].distinct, rowCount), 1.0);
+}
+
+// ֵ [low, high] еλ(0~1)low < value <= high
+static double interpolate(int32_t low, int32_t high, int32_t value) {
+    return (static_cast<double>(value) - low) / (static_cast<double>(high) - low);
+}
+
+// ַȥ low  high Ĺǰ׺󣬰ļֽڿ 256 Сٲֵ
+static double interpolate(const std::string& low, const std::string& high, const std::string& value) {
+    size_t prefix = 0;
+    while (prefix < low.size() && prefix < high.size() && low[prefix] == high[prefix]) ++prefix;
+    auto scalar = [prefix](const std::string& text) {
+        double result = 0, scale = 1;
+        for (size_t i = prefix; i < text.size() && i < prefix + 6; ++i) {
+            scale /= 256;
+            result += static_cast<unsigned char>(text[i]) * scale;
+        }
+        return result;
+    };
+    double range = scalar(high) - scalar(low);
+    if (range <= 0) return 0.5;
+    return std::min(std::max((scalar(value) - scalar(low)) / range, 0.0), 1.0);
+}
+
+// С value еı
+template <typename T>
+static double fractionBelow(const std::vector<T>& bounds, const T& value) {
+    size_t k = std::lower_bound(bounds.begin(), bounds.end(), value) - bounds.begin();
+    if (k == 0) return 0;
+    if (k == bounds.size()) return 1;
+    return (k - 1 + interpolate(bounds[k - 1], bounds[k], value)) / static_cast<double>(bounds.size() - 1);
+}
+
+//  value еıСֵֵ֮Ϊ 0ֱͼռ˶߽ĸƵֵռͰ
+template <typename T>
+static double fractionEqual(const std::vector<T>& bounds, const T& value, double distinct) {
+    if (bounds.empty() || value < bounds.front() || bounds.back() < value) return 0;
+    auto range = std::equal_range(bounds.begin(), bounds.end(), value);
+    double frequent = 0;
+    if (range.second - range.first > 1) {
+        frequent = static_cast<double>(range.second - range.first - 1) / (bounds.size() - 1);
+    }
+    return std::max(frequent, 1.0 / std::max(distinct, 1.0));
+}
+
+double TableStatistics::compareSelectivity(const Predicate::Node& node) const {
+    if (node.kind == Predicate::Node::COL_INT || node.kind == Predicate::Node::COL_CHAR) {
+        if (node.op != CompareOp::EQ && node.op != CompareOp::NE) return DEFAULT_RANGE_SELECTIVITY;
+        double distinct = std::max(columns[node.column].distinct, columns[node.otherColumn].distinct);
+        double equal = 1.0 / std::max(distinct, 1.0);
+        return node.op == CompareOp::EQ ? equal : 1 - equal;
+    }
+    if (rows == 0) return 0;
+    const ColumnStatistics& column = columns[node.column];
+    double equal, below;
+    if (node.kind == Predicate::Node::CMP_INT) {
+        equal = fractionEqual(column.ints, node.intValue, column.distinct);
+        below = fractionBelow(column.ints, node.intValue);
+    } else {
+        equal = fractionEqual(column.chars, node.charValue, column.distinct);
+        below = fractionBelow(column.chars, node.charValue);
+    }
+    switch (node.op) {
+    case CompareOp::EQ: return equal;
+    case CompareOp::NE: return 1 - equal;
+    case CompareOp::LT: return below;
+    case CompareOp::GT: return std::max(1 - below - equal, 0.0);
+    }
+    return 1;
+}
+
+double seqScanCost(uint32_t pageCount, double rows) {
+    return pageCount * SEQ_PAGE_COST + rows * CPU_OPERATOR_COST;
+}
+
+// ȡصҳڸҳоȷֲƣкҪ
+double indexScanCost(uint32_t pageCount, double matched) {
+    double pages = pageCount == 0 ? 0 : pageCount * (1 - std::pow(1 - 1.0 / pageCount, matched));
+    double pageCost = pageCount == 0 ? RANDOM_PAGE_COST :
+                      RANDOM_PAGE_COST - (RANDOM_PAGE_COST - SEQ_PAGE_COST) * std::sqrt(pages / pageCount);
+    double sort = matched > 1 ? matched * std::log2(matched) * CPU_OPERATOR_COST : 0;
+    return RANDOM_PAGE_COST + matched * (CPU_INDEX_COST + CPU_ROW_COST) + sort + pages * pageCost;
+}
+
+// ఴҳСֽдʱļٶظһ
+static double spillCost(double rows, uint32_t rowSize) {
+    return 2 * rows * rowSize / PAGE_SIZE * SEQ_PAGE_COST;
+}
+
+// Ųʱ඼дʱļ
+double hashJoinCost(double left, double right, uint32_t leftRowSize, uint32_t rightRowSize, size_t memoryLimit) {
+    double cost = (left + right) * HASH_ROW_COST;
+    bool buildLeft = left <= right;
+    if ((buildLeft ? left * leftRowSize : right * rightRowSize) > memoryLimit) {
+        cost += spillCost(left, leftRowSize) + spillCost(right, rightRowSize);
+    }
+    return cost;
+}
+
+// Сһֿ룬ÿ鶼Ҫ¶һһֶ࣬ʱһдʱļ
+double nestedLoopCost(double left, double right, uint32_t leftRowSize, uint32_t rightRowSize, size_t memoryLimit) {
+    bool blockLeft = left <= right;
+    double blockBytes = blockLeft ? left * leftRowSize : right * rightRowSize;
+    double blocks = std::max(std::ceil(blockBytes / std::max<size_t>(memoryLimit, 1)), 1.0);
+    double cost = left * right * CPU_OPERATOR_COST;
+    if (blocks > 1) {
+        cost += blockLeft ? spillCost(right, rightRowSize) * blocks / 2 : spillCost(left, leftRowSize) * blocks / 2;
+    }
+    return cost;
+}
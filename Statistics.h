@@ -0,0 +1,66 @@
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Storage.h"
+#include "Predicate.h"
+
+// ANALYZE ÿֱͼͰ
+const uint32_t ANALYZE_SAMPLE_ROWS = 30000;
+const uint32_t HISTOGRAM_BUCKETS = 100;
+
+// ģͣ˳һҳΪλ
+const double SEQ_PAGE_COST = 1.0;
+const double RANDOM_PAGE_COST = 4.0;
+const double CPU_ROW_COST = 0.01;         // ȡһ
+const double CPU_INDEX_COST = 0.005;      // ȡһ
+const double CPU_OPERATOR_COST = 0.0025;  // һαȽϣҲȫɨаһеĴ
+const double HASH_ROW_COST = 0.01;        // ϣв̽һ
+// ûʱΧȽϵѡ
+const double DEFAULT_RANGE_SELECTIVITY = 1.0 / 3;
+
+// һеͳƣֵͬ͵ֱͼ
+// ֱͼı߽ѳֵȷΪͰһΪСֵһΪֵ߽֮ͬ
+// INT еı߽ ints УCHAR  chars 
+struct ColumnStatistics {
+    double distinct = 0;
+    std::vector<int32_t> ints;
+    std::vector<std::string> chars;
+};
+
+// ANALYZE ռıͳƣڱļԵ .stats ļУ޸ıԶ£ ANALYZE ʱ滻
+class TableStatistics {
+public:
+    uint64_t rows = 0;   // ռʱɼ
+    uint32_t pages = 0;  // ռʱҳ
+    std::vector<ColumnStatistics> columns;
+
+    // ɳ( layout Ķиʽδ)ͳƣtotal Ϊɼ
+    static TableStatistics build(const TableLayout& layout, const std::vector<char>& sample,
+                                 uint64_t total, uint32_t pageCount);
+    bool save(const std::string& path, const TableLayout& layout) const;
+    // ļڡ𻵻ṹʱ false
+    bool load(const std::string& path, const TableLayout& layout);
+    static std::string filePath(const std::string& tablePath) { return tablePath + ".stats"; }
+
+    //  pageCount ҳʱƵռʱÿҳ
+    double estimatedRows(uint32_t pageCount) const;
+    // νʵеı
+    double selectivity(const Predicate& predicate) const;
+    // Ƚϵѡ
+    double compareSelectivity(const Predicate::Node& node) const;
+    //  rowCount ĳеĲֵͬ
+    double distinctValues(size_t col, double rowCount) const;
+};
+
+// ִзʽĹƴ
+double seqScanCost(uint32_t pageCount, double rows);
+// ҳ matched кҳ˳ȡأֻȡҳʱӽȡش󲿷ҳʱӽ˳
+double indexScanCost(uint32_t pageCount, double matched);
+// пmemoryLimit Ϊڴ
+double hashJoinCost(double left, double right, uint32_t leftRowSize, uint32_t rightRowSize, size_t memoryLimit);
+double nestedLoopCost(double left, double right, uint32_t leftRowSize, uint32_t rightRowSize, size_t memoryLimit);
+
+#endif // STATISTICS_H
@@ -0,0 +1,567 @@
+#include "Storage.h"
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include <charconv>
+#include <cstddef>
+#include <filesystem>
+#include "Compression.h"
+
+// 㶨в
+TableLayout::TableLayout(const Table& table) {
+    for (const auto& column : table.columns) {
+        uint32_t width = static_cast<uint32_t>(column.size);
+        if (column.type == ColumnType::INT) width = sizeof(int32_t);
+        if (column.type == ColumnType::BIGINT || column.type == ColumnType::DOUBLE) width = 8;
+        types.push_back(column.type);
+        offsets.push_back(rowSize);
+        widths.push_back(width);
+        rowSize += width;
+    }
+    if (rowSize == 0) return;
+
+    // ÿλռ rowSize ֽڡһ汾Ϣ 1 λλͼ
+    uint32_t slotSize = rowSize + sizeof(RowVersion);
+    bitmapOffset = sizeof(PageHeader);
+    uint32_t n = (PAGE_SIZE - bitmapOffset) * 8 / (slotSize * 8 + 1);
+    while (n > 0) {
+        uint32_t start = (bitmapOffset + (n + 7) / 8 + 7) & ~7u;
+        if (start + n * slotSize <= PAGE_SIZE) {
+            versionsOffset = start;
+            slotsOffset = start + n * sizeof(RowVersion);
+            break;
+        }
+        --n;
+    }
+    slotsPerPage = n;
+}
+
+// ҳ
+void PageRef::init() {
+    std::memset(data, 0, PAGE_SIZE);
+    header()->magic = PAGE_MAGIC;
+    header()->slotCount = static_cast<uint16_t>(layout->slotsPerPage);
+    header()->usedCount = 0;
+}
+
+bool PageRef::isValid() const {
+    return header()->magic == PAGE_MAGIC && header()->slotCount == layout->slotsPerPage;
+}
+
+void PageRef::setUsed(uint32_t slot, bool used) {
+    char& byte = data[layout->bitmapOffset + slot / 8];
+    bool wasUsed = (byte >> (slot % 8)) & 1;
+    if (used == wasUsed) return;
+    if (used) {
+        byte = static_cast<char>(byte | (1 << (slot % 8)));
+        header()->usedCount++;
+    } else {
+        byte = static_cast<char>(byte & ~(1 << (slot % 8)));
+        header()->usedCount--;
+    }
+}
+
+int PageRef::findFreeSlot() const {
+    if (header()->usedCount >= header()->slotCount) return -1;
+    for (uint32_t i = 0; i < header()->slotCount; ++i) {
+        if (!isUsed(i)) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+// ļ
+// ѹʽļͷҳĿ¼ΪеͺͿȡҳÿҳλ
+struct CompressedHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t directoryOffset;
+    uint32_t directoryLength;
+    uint32_t directoryChecksum;
+    uint32_t headerChecksum;  // ϸֶεУ
+    uint32_t reserved;
+};
+
+const uint32_t COMPRESSED_FILE_VERSION = 1;
+// õĿռ䳬ЧҲڸֵʱдļ
+const uint64_t REWRITE_GARBAGE_BYTES = 1024 * 1024;
+
+static uint32_t checksum(const char* data, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static bool fileEnd(FILE* file, uint64_t& size) {
+    if (std::fseek(file, 0, SEEK_END) != 0) return false;
+#ifdef _WIN32
+    size = static_cast<uint64_t>(_ftelli64(file));
+#else
+    size = static_cast<uint64_t>(ftello(file));
+#endif
+    return true;
+}
+
+template <typename T>
+static void put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+static bool get(const char*& p, const char* end, T& value) {
+    if (static_cast<size_t>(end - p) < sizeof(value)) return false;
+    std::memcpy(&value, p, sizeof(value));
+    p += sizeof(value);
+    return true;
+}
+
+//  offset дҳĿ¼̺дļͷ
+static bool commitDirectory(FILE* file, uint64_t offset, const std::string& directory) {
+    if (!seekFile(file, offset) || std::fwrite(directory.data(), 1, directory.size(), file) != directory.size() ||
+        !syncFile(file)) {
+        return false;
+    }
+    CompressedHeader header = {COMPRESSED_FILE_MAGIC, COMPRESSED_FILE_VERSION, offset,
+                               static_cast<uint32_t>(directory.size()), checksum(directory.data(), directory.size()),
+                               0, 0};
+    header.headerChecksum = checksum(reinterpret_cast<const char*>(&header), offsetof(CompressedHeader, headerChecksum));
+    return seekFile(file, 0) && std::fwrite(&header, 1, sizeof(header), file) == sizeof(header) && syncFile(file);
+}
+
+TableFile::TableFile(const std::string& path) : path(path) {
+    file = std::fopen(path.c_str(), "r+b");
+    if (!file) return;
+    uint32_t magic = 0;
+    if (std::fread(&magic, 1, sizeof(magic), file) == sizeof(magic) && magic == COMPRESSED_FILE_MAGIC) {
+        compressed = true;
+        if (!readDirectory()) {
+            std::fclose(file);
+            file = nullptr;
+        }
+        return;
+    }
+    uint64_t size;
+    if (fileEnd(file, size)) pages = static_cast<uint32_t>(size / PAGE_SIZE);
+}
+
+TableFile::~TableFile() {
+    if (file && directoryChanged) sync();
+    for (const auto& mapping : mappings) {
+#ifdef _WIN32
+        UnmapViewOfFile(mapping.data);
+        CloseHandle(mapping.handle);
+#else
+        munmap(mapping.data, mapping.size);
+#endif
+    }
+    if (file) std::fclose(file);
+}
+
+bool TableFile::readPage(uint32_t pageNo, char* buffer) {
+    if (!file || pageNo >= pages) return false;
+    if (compressed) {
+        const Extent& extent = directory[pageNo];
+        if (extent.length == 0) {
+            std::memset(buffer, 0, PAGE_SIZE);
+            return true;
+        }
+        scratch.resize(extent.length);
+        return seekFile(file, extent.offset) && std::fread(&scratch[0], 1, extent.length, file) == extent.length &&
+               decompressPage(layout, scratch.data(), scratch.size(), buffer);
+    }
+    if (!seekFile(file, static_cast<uint64_t>(pageNo) * PAGE_SIZE)) return false;
+    return std::fread(buffer, 1, PAGE_SIZE, file) == PAGE_SIZE;
+}
+
+bool TableFile::writePage(uint32_t pageNo, const char* buffer) {
+    if (!file) return false;
+    if (compressed) {
+        // ȫ 0 ҳռռ䣻дļĩβ̵ҳĿ¼õ
+        Extent extent = {0, 0};
+        bool zero = buffer[0] == '\0' && std::memcmp(buffer, buffer + 1, PAGE_SIZE - 1) == 0;
+        if (!zero) {
+            compressPage(layout, buffer, scratch);
+            if (!seekFile(file, dataEnd) || std::fwrite(scratch.data(), 1, scratch.size(), file) != scratch.size()) {
+                return false;
+            }
+            extent = Extent{dataEnd, static_cast<uint32_t>(scratch.size())};
+            dataEnd += scratch.size();
+        }
+        if (pageNo >= directory.size()) directory.resize(pageNo + 1, Extent{0, 0});
+        liveBytes = liveBytes - directory[pageNo].length + extent.length;
+        directory[pageNo] = extent;
+        pages = static_cast<uint32_t>(directory.size());
+        directoryChanged = true;
+        return true;
+    }
+    if (!seekFile(file, static_cast<uint64_t>(pageNo) * PAGE_SIZE)) return false;
+    unflushed = true;
+    if (std::fwrite(buffer, 1, PAGE_SIZE, file) != PAGE_SIZE) return false;
+    if (pageNo >= pages) pages = pageNo + 1;
+    return true;
+}
+
+bool TableFile::writePages(uint32_t pageNo, const char* buffer, uint32_t count) {
+    if (!file) return false;
+    if (compressed) {
+        for (uint32_t i = 0; i < count; ++i) {
+            if (!writePage(pageNo + i, buffer + static_cast<size_t>(i) * PAGE_SIZE)) return false;
+        }
+        return true;
+    }
+    if (!seekFile(file, static_cast<uint64_t>(pageNo) * PAGE_SIZE)) return false;
+    size_t bytes = static_cast<size_t>(count) * PAGE_SIZE;
+    unflushed = true;
+    if (std::fwrite(buffer, 1, bytes, file) != bytes) return false;
+    if (pageNo + count > pages) pages = pageNo + count;
+    return true;
+}
+
+bool TableFile::flush() {
+    if (!file || std::fflush(file) != 0) return false;
+    unflushed = false;
+    return true;
+}
+
+bool TableFile::sync() {
+    if (!file) return false;
+    if (compressed && directoryChanged) {
+        uint64_t garbage = dataEnd - sizeof(CompressedHeader) - liveBytes;
+        if (garbage > liveBytes && garbage >= REWRITE_GARBAGE_BYTES && rewrite()) return true;
+        return file && writeDirectory();
+    }
+    if (!syncFile(file)) return false;
+    unflushed = false;
+    return true;
+}
+
+bool TableFile::truncate(uint32_t count) {
+    if (!file) return false;
+    if (count >= pages) return sync();
+    if (compressed) {
+        for (uint32_t p = count; p < pages; ++p) liveBytes -= directory[p].length;
+        directory.resize(count);
+        pages = count;
+        directoryChanged = true;
+        return sync();
+    }
+    if (!flush()) return false;
+    std::error_code ec;
+    std::filesystem::resize_file(path, static_cast<uintmax_t>(count) * PAGE_SIZE, ec);
+    if (ec) return false;
+    pages = count;
+    return sync();
+}
+
+bool TableFile::readDirectory() {
+    CompressedHeader header;
+    if (!seekFile(file, 0) || std::fread(&header, 1, sizeof(header), file) != sizeof(header) ||
+        header.version != COMPRESSED_FILE_VERSION ||
+        header.headerChecksum !=
+            checksum(reinterpret_cast<const char*>(&header), offsetof(CompressedHeader, headerChecksum))) {
+        return false;
+    }
+    std::string data(header.directoryLength, '\0');
+    if (!seekFile(file, header.directoryOffset) ||
+        std::fread(&data[0], 1, data.size(), file) != data.size() ||
+        checksum(data.data(), data.size()) != header.directoryChecksum) {
+        return false;
+    }
+
+    const char* p = data.data();
+    const char* end = p + data.size();
+    uint16_t columnCount;
+    if (!get(p, end, columnCount)) return false;
+    Table table;
+    for (uint16_t i = 0; i < columnCount; ++i) {
+        uint8_t type;
+        uint32_t size;
+        if (!get(p, end, type) || !get(p, end, size)) return false;
+        table.columns.push_back({"", static_cast<ColumnType>(type), static_cast<int>(size)});
+    }
+    uint32_t count;
+    if (!get(p, end, count) || static_cast<size_t>(end - p) < static_cast<size_t>(count) * 12) return false;
+    directory.resize(count);
+    for (auto& extent : directory) {
+        get(p, end, extent.offset);
+        get(p, end, extent.length);
+        liveBytes += extent.length;
+    }
+    columns = table.columns;
+    layout = TableLayout(table);
+    pages = count;
+    return fileEnd(file, dataEnd);
+}
+
+bool TableFile::writeDirectory() {
+    std::string data;
+    put(data, static_cast<uint16_t>(columns.size()));
+    for (const auto& column : columns) {
+        put(data, static_cast<uint8_t>(column.type));
+        put(data, static_cast<uint32_t>(column.size));
+    }
+    put(data, static_cast<uint32_t>(directory.size()));
+    for (const auto& extent : directory) {
+        put(data, extent.offset);
+        put(data, extent.length);
+    }
+    if (!commitDirectory(file, dataEnd, data)) return false;
+    dataEnd += data.size();
+    directoryChanged = false;
+    return true;
+}
+
+bool TableFile::rewrite() {
+    std::string tempPath = path + ".tmp";
+    FILE* out = std::fopen(tempPath.c_str(), "w+b");
+    if (!out) return false;
+    std::vector<Extent> packed(directory.size(), Extent{0, 0});
+    uint64_t offset = sizeof(CompressedHeader);
+    bool ok = std::fflush(file) == 0 && seekFile(out, offset);
+    for (size_t p = 0; ok && p < directory.size(); ++p) {
+        if (directory[p].length == 0) continue;
+        scratch.resize(directory[p].length);
+        ok = seekFile(file, directory[p].offset) &&
+             std::fread(&scratch[0], 1, scratch.size(), file) == scratch.size() &&
+             std::fwrite(scratch.data(), 1, scratch.size(), out) == scratch.size();
+        packed[p] = {offset, directory[p].length};
+        offset += directory[p].length;
+    }
+
+    FILE* old = file;
+    uint64_t oldEnd = dataEnd;
+    file = out;
+    directory.swap(packed);
+    dataEnd = offset;
+    if (ok) ok = writeDirectory();
+    std::fclose(out);
+    std::error_code ec;
+    if (ok) {
+        std::fclose(old);
+        std::filesystem::rename(tempPath, path, ec);
+        if (!ec) {
+            file = std::fopen(path.c_str(), "r+b");
+            return file != nullptr;
+        }
+        // ʧʱԭļȻʹԭļ
+        old = std::fopen(path.c_str(), "r+b");
+    }
+    file = old;
+    directory.swap(packed);
+    dataEnd = oldEnd;
+    directoryChanged = true;
+    std::filesystem::remove(tempPath, ec);
+    return false;
+}
+
+bool TableFile::createCompressed(const std::string& path, const Table& table) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    std::string data;
+    put(data, static_cast<uint16_t>(table.columns.size()));
+    for (const auto& column : table.columns) {
+        put(data, static_cast<uint8_t>(column.type));
+        put(data, static_cast<uint32_t>(column.size));
+    }
+    put(data, static_cast<uint32_t>(0));
+    bool ok = commitDirectory(file, sizeof(CompressedHeader), data);
+    return std::fclose(file) == 0 && ok;
+}
+
+const char* TableFile::mapPage(uint32_t pageNo) {
+    if (!file || compressed || pageNo >= pages) return nullptr;
+    if (unflushed && !flush()) return nullptr;
+    size_t offset = static_cast<size_t>(pageNo) * PAGE_SIZE;
+    if (mappings.empty() || mappings.back().size < offset + PAGE_SIZE) {
+        Mapping mapping;
+        mapping.size = static_cast<size_t>(pages) * PAGE_SIZE;
+#ifdef _WIN32
+        HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file)));
+        mapping.handle = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping.handle) return nullptr;
+        mapping.data = static_cast<char*>(MapViewOfFile(mapping.handle, FILE_MAP_READ, 0, 0, mapping.size));
+        if (!mapping.data) {
+            CloseHandle(mapping.handle);
+            return nullptr;
+        }
+#else
+        void* data = mmap(nullptr, mapping.size, PROT_READ, MAP_SHARED, fileno(file), 0);
+        if (data == MAP_FAILED) return nullptr;
+        mapping.data = static_cast<char*>(data);
+#endif
+        mappings.push_back(mapping);
+    }
+    return mappings.back().data + offset;
+}
+
+bool seekFile(FILE* file, uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+bool syncFile(FILE* file) {
+    if (std::fflush(file) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+// ֶα
+std::string quoteLiteral(std::string_view text) {
+    std::string result = "'";
+    for (char c : text) {
+        if (c == '\'') result += '\'';
+        result += c;
+    }
+    return result + "'";
+}
+
+bool unquoteLiteral(std::string_view text, std::string_view& value, std::string& buffer) {
+    if (text.size() < 2 || text.front() != '\'' || text.back() != '\'') {
+        value = text;
+        return false;
+    }
+    value = text.substr(1, text.size() - 2);
+    if (value.find('\'') == std::string_view::npos) return true;
+    buffer.clear();
+    for (size_t i = 0; i < value.size(); ++i) {
+        buffer += value[i];
+        if (value[i] == '\'' && i + 1 < value.size() && value[i + 1] == '\'') ++i;
+    }
+    value = buffer;
+    return true;
+}
+
+bool encodeField(const TableLayout& layout, size_t col, std::string_view text,
+                 char* row, std::string& error) {
+    std::string_view value;
+    std::string buffer;
+    unquoteLiteral(trimBlank(text), value, buffer);
+    return encodeValue(layout, col, value, row, error);
+}
+
+bool encodeValue(const TableLayout& layout, size_t col, std::string_view value,
+                 char* row, std::string& error) {
+    char* dst = row + layout.offsets[col];
+    if (layout.types[col] == ColumnType::INT) {
+        int32_t v = 0;
+        auto result = std::from_chars(value.data(), value.data() + value.size(), v);
+        if (value.empty() || result.ec != std::errc() || result.ptr != value.data() + value.size()) {
+            error = "Invalid integer value '" + std::string(value) + "'";
+            return false;
+        }
+        std::memcpy(dst, &v, sizeof(v));
+    } else {
+        if (value.size() > layout.widths[col]) {
+            error = "Value '" + std::string(value) + "' is too long";
+            return false;
+        }
+        std::memset(dst, 0, layout.widths[col]);
+        std::memcpy(dst, value.data(), value.size());
+    }
+    return true;
+}
+
+static uint32_t readMagic(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    uint32_t magic = 0;
+    if (!file.read(reinterpret_cast<char*>(&magic), sizeof(magic))) return 0;
+    return magic;
+}
+
+bool isPageFile(const std::string& path) {
+    uint32_t magic = readMagic(path);
+    return magic == PAGE_MAGIC || magic == LEGACY_PAGE_MAGIC || magic == COMPRESSED_FILE_MAGIC;
+}
+
+bool isCompressedFile(const std::string& path) {
+    return readMagic(path) == COMPRESSED_FILE_MAGIC;
+}
+
+bool isLegacyPageFile(const std::string& path) {
+    return readMagic(path) == LEGACY_PAGE_MAGIC;
+}
+
+bool upgradePageFile(const std::string& path, const TableLayout& layout) {
+    if (layout.slotsPerPage == 0) return false;
+    // ɰ沼֣ҳͷλͼ֮ 4 ֽڶĶλ
+    uint32_t oldOffset = 0;
+    uint32_t oldSlots = (PAGE_SIZE - sizeof(PageHeader)) * 8 / (layout.rowSize * 8 + 1);
+    while (oldSlots > 0) {
+        oldOffset = (sizeof(PageHeader) + (oldSlots + 7) / 8 + 3) & ~3u;
+        if (oldOffset + oldSlots * layout.rowSize <= PAGE_SIZE) break;
+        --oldSlots;
+    }
+
+    std::string tempPath = path + ".tmp";
+    std::ifstream in(path, std::ios::binary);
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!in || !out) return false;
+
+    std::vector<char> oldPage(PAGE_SIZE);
+    std::vector<char> buffer(PAGE_SIZE);
+    PageRef page(buffer.data(), layout);
+    page.init();
+    uint32_t slot = 0;
+    while (in.read(oldPage.data(), PAGE_SIZE)) {
+        const PageHeader* header = reinterpret_cast<const PageHeader*>(oldPage.data());
+        if (header->magic != LEGACY_PAGE_MAGIC || header->slotCount != oldSlots) continue;
+        for (uint32_t s = 0; s < oldSlots; ++s) {
+            if (!((oldPage[sizeof(PageHeader) + s / 8] >> (s % 8)) & 1)) continue;
+            std::memcpy(page.slotData(slot), oldPage.data() + oldOffset + s * layout.rowSize, layout.rowSize);
+            page.setUsed(slot, true);
+            if (++slot == layout.slotsPerPage) {
+                out.write(buffer.data(), PAGE_SIZE);
+                page.init();
+                slot = 0;
+            }
+        }
+    }
+    if (slot > 0) out.write(buffer.data(), PAGE_SIZE);
+    in.close();
+    out.close();
+    if (!out) return false;
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    return !ec;
+}
+
+bool convertPageFile(const std::string& path, const Table& table, bool compressed) {
+    std::string tempPath = path + ".tmp";
+    {
+        TableFile source(path);
+        if (!source.isOpen()) return false;
+        if (source.isCompressed() == compressed) return true;
+        if (compressed) {
+            if (!TableFile::createCompressed(tempPath, table)) return false;
+        } else {
+            std::ofstream(tempPath, std::ios::binary | std::ios::trunc);
+        }
+        TableFile target(tempPath);
+        std::vector<char> page(PAGE_SIZE);
+        bool ok = target.isOpen();
+        for (uint32_t p = 0; ok && p < source.pageCount(); ++p) {
+            ok = source.readPage(p, page.data()) && target.writePage(p, page.data());
+        }
+        if (!ok || !target.sync()) {
+            std::error_code ec;
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    return !ec;
+}
@@ -0,0 +1,241 @@
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Schema.h"
+
+// ҳСҳʶ
+const uint32_t PAGE_SIZE = 4096;
+const uint32_t PAGE_MAGIC = 0x56424453;         // "SDBV"
+const uint32_t LEGACY_PAGE_MAGIC = 0x50424453;  // "SDBP"ɰв汾Ϣ
+const uint32_t COMPRESSED_FILE_MAGIC = 0x5A424453;  // "SDBZ"ҳѹıļ
+
+// ҳͷλλͼÿλİ汾ϢͶλ
+struct PageHeader {
+    uint32_t magic;
+    uint16_t slotCount;  // ҳλ
+    uint16_t usedCount;  // ռòλ
+};
+
+// ¼ڱļеλ
+struct RID {
+    uint32_t page;
+    uint16_t slot;
+};
+
+// а汾Ŀʼͽʱbegin Ϊдð汾ύʱend Ϊɾύʱ
+// end Ϊ 0 ʾδɾʽύǰдǴ TXN_FLAG 
+struct RowVersion {
+    uint64_t begin;
+    uint64_t end;
+};
+
+const uint64_t TXN_FLAG = 1ULL << 63;
+
+inline bool isTransactionId(uint64_t stamp) {
+    return (stamp & TXN_FLAG) != 0;
+}
+
+// գύʱ timestamp İ汾Լ writer Լдİ汾ɼ
+struct Snapshot {
+    uint64_t timestamp = 0;
+    uint64_t writer = 0;
+
+    bool visible(const RowVersion& version) const {
+        bool begun = version.begin == writer || (!isTransactionId(version.begin) && version.begin <= timestamp);
+        bool ended = version.end != 0 &&
+                     (version.end == writer || (!isTransactionId(version.end) && version.end <= timestamp));
+        return begun && !ended;
+    }
+};
+
+// ɱṹƵĶв
+struct TableLayout {
+    std::vector<ColumnType> types;
+    std::vector<uint32_t> offsets;  // ÿڲλеƫ
+    std::vector<uint32_t> widths;   // ÿռõֽ
+    uint32_t rowSize = 0;
+    uint32_t slotsPerPage = 0;
+    uint32_t bitmapOffset = 0;
+    uint32_t versionsOffset = 0;
+    uint32_t slotsOffset = 0;
+
+    TableLayout() = default;
+    explicit TableLayout(const Table& table);
+};
+
+// ҳڲֱҳ
+class PageRef {
+public:
+    PageRef(char* data, const TableLayout& layout) : data(data), layout(&layout) {}
+
+    void init();
+    bool isValid() const;
+    uint16_t slotCount() const { return header()->slotCount; }
+    uint16_t usedCount() const { return header()->usedCount; }
+    bool isUsed(uint32_t slot) const {
+        return (data[layout->bitmapOffset + slot / 8] >> (slot % 8)) & 1;
+    }
+    void setUsed(uint32_t slot, bool used);
+    int findFreeSlot() const;
+    char* slotData(uint32_t slot) { return data + layout->slotsOffset + slot * layout->rowSize; }
+    const char* slotData(uint32_t slot) const { return data + layout->slotsOffset + slot * layout->rowSize; }
+    RowVersion& version(uint32_t slot) {
+        return reinterpret_cast<RowVersion*>(data + layout->versionsOffset)[slot];
+    }
+    const RowVersion& version(uint32_t slot) const {
+        return reinterpret_cast<const RowVersion*>(data + layout->versionsOffset)[slot];
+    }
+
+private:
+    PageHeader* header() { return reinterpret_cast<PageHeader*>(data); }
+    const PageHeader* header() const { return reinterpret_cast<const PageHeader*>(data); }
+
+    char* data;
+    const TableLayout* layout;
+};
+
+// ҳһеֻͼֶβ
+class RowView {
+public:
+    RowView() = default;
+    RowView(const char* data, const TableLayout& layout) : data(data), layout(&layout) {}
+
+    int32_t getInt(size_t col) const {
+        int32_t value;
+        std::memcpy(&value, data + layout->offsets[col], sizeof(value));
+        return value;
+    }
+    std::string_view getChar(size_t col) const {
+        const char* p = data + layout->offsets[col];
+        size_t len = 0;
+        while (len < layout->widths[col] && p[len] != '\0') ++len;
+        return std::string_view(p, len);
+    }
+    int64_t getBigint(size_t col) const {
+        int64_t value;
+        std::memcpy(&value, data + layout->offsets[col], sizeof(value));
+        return value;
+    }
+    double getDouble(size_t col) const {
+        double value;
+        std::memcpy(&value, data + layout->offsets[col], sizeof(value));
+        return value;
+    }
+    ColumnType type(size_t col) const { return layout->types[col]; }
+    const char* raw() const { return data; }
+
+private:
+    const char* data = nullptr;
+    const TableLayout* layout = nullptr;
+};
+
+// ҳдļ
+// ѹʽļļͷʼҳѹ׷ӵļĩβҳĿ¼¼ÿҳλã
+// ʱдµҳĿ¼̺ٸдļͷָļͷָҳĿ¼
+// ϴ̺дҳԤд־õĿռ䳬Чʱʱдļ
+class TableFile {
+public:
+    explicit TableFile(const std::string& path);
+    ~TableFile();
+    TableFile(const TableFile&) = delete;
+    TableFile& operator=(const TableFile&) = delete;
+
+    bool isOpen() const { return file != nullptr; }
+    bool isCompressed() const { return compressed; }
+    uint32_t pageCount() const { return pages; }
+    // ҳδдҳȫ 0
+    bool readPage(uint32_t pageNo, char* buffer);
+    bool writePage(uint32_t pageNo, const char* buffer);
+    // д count ҳ
+    bool writePages(uint32_t pageNo, const char* buffer, uint32_t count);
+    bool flush();
+    // ˢ²ǿ
+    bool sync();
+    // ضΪǰ count ҳ
+    bool truncate(uint32_t count);
+    // ֻӳеĵ pageNo ҳӳʱ(ѹʽ) nullptr
+    // ļ䳤ӳ䣬ӳ䱣ļرգȡõָһֱЧ
+    const char* mapPage(uint32_t pageNo);
+
+    // ½κҳѹʽļѴʱ
+    static bool createCompressed(const std::string& path, const Table& table);
+
+private:
+    struct Mapping {
+        char* data;
+        size_t size;
+#ifdef _WIN32
+        void* handle;
+#endif
+    };
+    // ѹҳļеλãlength Ϊ 0 ʾҳδд
+    struct Extent {
+        uint64_t offset;
+        uint32_t length;
+    };
+
+    bool readDirectory();
+    // дҳĿ¼ļͷǰҳȫд
+    bool writeDirectory();
+    // ֻҳĿ¼õݣдʱļ滻ԭļ
+    bool rewrite();
+
+    std::string path;
+    FILE* file = nullptr;
+    uint32_t pages = 0;
+    bool unflushed = false;  // д뻹 FILE Уӳ俴
+    std::vector<Mapping> mappings;
+
+    // ѹʽ
+    bool compressed = false;
+    std::vector<Column> columns;  // ѹʹõͺͿȣ¼ҳĿ¼
+    TableLayout layout;
+    std::vector<Extent> directory;
+    uint64_t dataEnd = 0;           // һҳдλ
+    uint64_t liveBytes = 0;         // ҳĿ¼õֽ
+    bool directoryChanged = false;  // ҳĿ¼޸δ
+    std::string scratch;  // ѹҳĶд
+};
+
+// ƽ̨ 64 λλ
+bool seekFile(FILE* file, uint64_t offset);
+bool syncFile(FILE* file);
+
+// ȥǰĿոƱ
+inline std::string_view trimBlank(std::string_view text) {
+    size_t begin = text.find_first_not_of(" \t");
+    if (begin == std::string_view::npos) return std::string_view();
+    return text.substr(begin, text.find_last_not_of(" \t") + 1 - begin);
+}
+
+// SQL ַõеĵд ''
+std::string quoteLiteral(std::string_view text);
+// ŵĳȥŲ '' ԭΪ 'ָ text  buffer ָ buffer true
+// ʱ value Ϊ text false
+bool unquoteLiteral(std::string_view text, std::string_view& value, std::string& buffer);
+
+// ıֵ뵽λָУʧʱشϢ
+bool encodeField(const TableLayout& layout, size_t col, std::string_view text,
+                 char* row, std::string& error);
+// ͬϣ value ȥհ׺(ʹ)
+bool encodeValue(const TableLayout& layout, size_t col, std::string_view value,
+                 char* row, std::string& error);
+
+// жļǷΪҳʽ(ɰҳʽѹʽ)
+bool isPageFile(const std::string& path);
+bool isCompressedFile(const std::string& path);
+// жļǷΪв汾Ϣľɰҳʽ
+bool isLegacyPageFile(const std::string& path);
+// ѾɰҳʽıļתΪǰʽԭежпտɼеλûı
+bool upgradePageFile(const std::string& path, const TableLayout& layout);
+// ѱļдΪѹʽ򶨳ҳʽҳźҳݲ䣻ǰļܱش
+bool convertPageFile(const std::string& path, const Table& table, bool compressed);
+
+#endif // STORAGE_H
\ No newline at end of file
@@ -0,0 +1,172 @@
+#include "Transaction.h"
+#include <cstdio>
+
+// 
+void TableLatch::lock() {
+    std::unique_lock<std::mutex> guard(mutex);
+    waitingWriters++;
+    changed.wait(guard, [this] { return !writing && readers == 0; });
+    waitingWriters--;
+    writing = true;
+}
+
+void TableLatch::unlock() {
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        writing = false;
+    }
+    changed.notify_all();
+}
+
+void TableLatch::lock_shared() {
+    std::unique_lock<std::mutex> guard(mutex);
+    changed.wait(guard, [this] { return !writing && waitingWriters == 0; });
+    readers++;
+}
+
+void TableLatch::unlock_shared() {
+    bool last;
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        last = (--readers == 0);
+    }
+    if (last) changed.notify_all();
+}
+
+// 
+TransactionManager::TransactionManager(const std::string& dir) : path(dir + "/clock.dat") {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return;
+    uint64_t value;
+    if (std::fread(&value, sizeof(value), 1, file) == 1) clock = reserved = value;
+    std::fclose(file);
+}
+
+// ʱѳ mutex
+bool TransactionManager::tick(uint64_t& value) {
+    if (clock + 1 > reserved) {
+        uint64_t limit = clock + 1 + CLOCK_RESERVE;
+        FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file) return false;
+        bool ok = std::fwrite(&limit, sizeof(limit), 1, file) == 1 && syncFile(file);
+        std::fclose(file);
+        if (!ok) return false;
+        reserved = limit;
+    }
+    value = ++clock;
+    return true;
+}
+
+// ʱѳ mutex
+uint64_t TransactionManager::horizon() const {
+    return committing.empty() ? clock : *committing.begin() - 1;
+}
+
+std::shared_ptr<const Snapshot> TransactionManager::openSnapshot(uint64_t writer) {
+    Snapshot* snapshot = new Snapshot();
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        snapshot->timestamp = horizon();
+        snapshot->writer = writer;
+        snapshots.insert(snapshot->timestamp);
+    }
+    return std::shared_ptr<const Snapshot>(snapshot, [this](const Snapshot* snapshot) {
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            snapshots.erase(snapshots.find(snapshot->timestamp));
+        }
+        delete snapshot;
+    });
+}
+
+bool TransactionManager::beginCommit(uint64_t& timestamp) {
+    std::lock_guard<std::mutex> guard(mutex);
+    if (!tick(timestamp)) return false;
+    committing.insert(timestamp);
+    return true;
+}
+
+void TransactionManager::finishCommit(uint64_t timestamp) {
+    std::lock_guard<std::mutex> guard(mutex);
+    committing.erase(committing.find(timestamp));
+}
+
+// ʱѷ䣬ʱӲˣֻǲٵס
+void TransactionManager::abortCommit(uint64_t timestamp) {
+    std::lock_guard<std::mutex> guard(mutex);
+    committing.erase(committing.find(timestamp));
+}
+
+bool TransactionManager::beginTransaction(uint64_t& id) {
+    std::lock_guard<std::mutex> guard(mutex);
+    if (!tick(id)) return false;
+    id |= TXN_FLAG;
+    active[id];
+    return true;
+}
+
+void TransactionManager::endTransaction(uint64_t id) {
+    std::lock_guard<std::mutex> guard(mutex);
+    active.erase(id);
+}
+
+bool TransactionManager::isActive(uint64_t id) const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return active.count(id) > 0;
+}
+
+void TransactionManager::noteWrite(uint64_t id, const std::string& table) {
+    std::lock_guard<std::mutex> guard(mutex);
+    active[id].insert(table);
+}
+
+bool TransactionManager::hasPendingWrites(const std::string& table) const {
+    std::lock_guard<std::mutex> guard(mutex);
+    for (const auto& transaction : active) {
+        if (transaction.second.count(table)) return true;
+    }
+    return false;
+}
+
+bool TransactionManager::hasActiveTransactions() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return !active.empty();
+}
+
+uint64_t TransactionManager::oldestSnapshot() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    uint64_t oldest = horizon();
+    if (!snapshots.empty() && *snapshots.begin() < oldest) oldest = *snapshots.begin();
+    return oldest;
+}
+
+// ҳ
+void TransactionManager::addGarbage(const std::string& table, const std::set<uint32_t>& pages) {
+    if (pages.empty()) return;
+    std::lock_guard<std::mutex> guard(mutex);
+    std::set<uint32_t>& entry = garbage[table];
+    garbageCount -= entry.size();
+    entry.insert(pages.begin(), pages.end());
+    garbageCount += entry.size();
+}
+
+std::map<std::string, std::set<uint32_t>> TransactionManager::takeGarbage() {
+    std::lock_guard<std::mutex> guard(mutex);
+    std::map<std::string, std::set<uint32_t>> taken;
+    taken.swap(garbage);
+    garbageCount = 0;
+    return taken;
+}
+
+size_t TransactionManager::garbagePages() const {
+    std::lock_guard<std::mutex> guard(mutex);
+    return garbageCount;
+}
+
+void TransactionManager::dropTable(const std::string& table) {
+    std::lock_guard<std::mutex> guard(mutex);
+    auto it = garbage.find(table);
+    if (it == garbage.end()) return;
+    garbageCount -= it->second.size();
+    garbage.erase(it);
+}
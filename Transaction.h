@@ -0,0 +1,98 @@
+#ifndef TRANSACTION_H
+#define TRANSACTION_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include "Storage.h"
+
+// ޸ȡʱÿҳݳй
+// ޸ڵȴʱµĹУʱɨ費޸һֱȥ
+class TableLatch {
+public:
+    void lock();
+    void unlock();
+    void lock_shared();
+    void unlock_shared();
+
+private:
+    std::mutex mutex;
+    std::condition_variable changed;
+    uint32_t readers = 0;
+    uint32_t waitingWriters = 0;
+    bool writing = false;
+};
+
+// ȡһűʱʹõĿպlatch Ϊձʾ÷гиñ
+struct ReadView {
+    std::shared_ptr<const Snapshot> snapshot;
+    TableLatch* latch = nullptr;
+
+    std::shared_lock<TableLatch> lockPage() const {
+        return latch ? std::shared_lock<TableLatch>(*latch) : std::shared_lock<TableLatch>();
+    }
+};
+
+// Ự BEGIN ʼʽ
+struct Transaction {
+    std::string database;
+    uint64_t id = 0;
+    std::shared_ptr<const Snapshot> snapshot;
+    std::map<std::string, std::set<uint32_t>> writes;  //  -> дҳ
+};
+
+// һݿĶ汾״̬
+// ύʱͬһʱӣŴ TXN_FLAG
+// ȡʼʱѾдʱдύʱСһ֮ǰĶд
+class TransactionManager {
+public:
+    // ʱÿԤʱԤϽ̺ʹãϽ
+    static const uint64_t CLOCK_RESERVE = 65536;
+
+    explicit TransactionManager(const std::string& dir);
+
+    // ǼǵǰĶգصĶͷʱע
+    std::shared_ptr<const Snapshot> openSnapshot(uint64_t writer = 0);
+    // ύʱда汾 finishCommit
+    bool beginCommit(uint64_t& timestamp);
+    void finishCommit(uint64_t timestamp);
+    // дİ汾ύʱ
+    void abortCommit(uint64_t timestamp);
+
+    bool beginTransaction(uint64_t& id);
+    void endTransaction(uint64_t id);
+    bool isActive(uint64_t id) const;
+    void noteWrite(uint64_t id, const std::string& table);
+    // Ƿδдñ
+    bool hasPendingWrites(const std::string& table) const;
+    bool hasActiveTransactions() const;
+    // ʱֵİ汾ѵǼǵĿպԺĿնɼ
+    uint64_t oldestSnapshot() const;
+
+    // ѽ汾ȴҳ
+    void addGarbage(const std::string& table, const std::set<uint32_t>& pages);
+    std::map<std::string, std::set<uint32_t>> takeGarbage();
+    size_t garbagePages() const;
+    void dropTable(const std::string& table);
+
+private:
+    bool tick(uint64_t& value);
+    uint64_t horizon() const;
+
+    std::string path;
+    mutable std::mutex mutex;
+    uint64_t clock = 0;
+    uint64_t reserved = 0;
+    std::multiset<uint64_t> committing;
+    std::multiset<uint64_t> snapshots;
+    std::map<uint64_t, std::set<std::string>> active;  //  -> дı
+    std::map<std::string, std::set<uint32_t>> garbage;
+    size_t garbageCount = 0;
+};
+
+#endif // TRANSACTION_H
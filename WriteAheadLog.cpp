@@ -0,0 +1,331 @@
+#include "WriteAheadLog.h"
+#include "Storage.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+// ¼ͷ峤 + У
+static uint32_t checksum(const char* data, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+template <typename T>
+static void put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+static bool get(const char*& p, const char* end, T& value) {
+    if (static_cast<size_t>(end - p) < sizeof(value)) return false;
+    std::memcpy(&value, p, sizeof(value));
+    p += sizeof(value);
+    return true;
+}
+
+// ָʧʱϴε־Žе֮󣬲ɼ¼
+// صĩβļ¼֮׷ӵļ¼ڻָʱܶ
+WriteAheadLog::WriteAheadLog(const std::string& path) : path(path) {
+    std::ifstream in(path, std::ios::binary);
+    if (in) {
+        std::string log((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+        std::vector<Change> changes;
+        std::set<uint64_t> committed;
+        size_t complete = parse(log, changes, committed);
+        for (const auto& change : changes) nextStatement = std::max(nextStatement, change.statement + 1);
+        for (uint64_t statement : committed) nextStatement = std::max(nextStatement, statement + 1);
+        std::error_code ec;
+        if (complete < log.size()) std::filesystem::resize_file(path, complete, ec);
+    }
+    file = std::fopen(path.c_str(), "ab");
+    if (!file) return;
+    std::fseek(file, 0, SEEK_END);
+    appendedLsn = flushedLsn = static_cast<uint64_t>(std::ftell(file));
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    if (file) {
+        flush();
+        std::fclose(file);
+    }
+}
+
+uint64_t WriteAheadLog::beginStatement() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return nextStatement++;
+}
+
+void WriteAheadLog::logPageChange(uint64_t statement, const std::string& fileName, uint32_t pageNo,
+                                  const char* before, const char* after) {
+    // ҳ仯ֽڶΣܽĶκϲ
+    const uint32_t gap = 8;
+    std::vector<std::pair<uint16_t, uint16_t>> runs;
+    uint32_t i = 0;
+    while (i < PAGE_SIZE) {
+        if (before[i] == after[i]) {
+            ++i;
+            continue;
+        }
+        uint32_t start = i;
+        uint32_t last = i;
+        for (++i; i < PAGE_SIZE && i <= last + gap; ++i) {
+            if (before[i] != after[i]) last = i;
+        }
+        runs.push_back({static_cast<uint16_t>(start), static_cast<uint16_t>(last - start + 1)});
+        i = last + 1;
+    }
+    if (runs.empty()) return;
+
+    std::string body;
+    put<uint8_t>(body, PAGE_CHANGE);
+    put<uint64_t>(body, statement);
+    put<uint16_t>(body, static_cast<uint16_t>(fileName.size()));
+    body += fileName;
+    put<uint32_t>(body, pageNo);
+    put<uint16_t>(body, static_cast<uint16_t>(runs.size()));
+    for (const auto& run : runs) {
+        put<uint16_t>(body, run.first);
+        put<uint16_t>(body, run.second);
+        body.append(before + run.first, run.second);
+        body.append(after + run.first, run.second);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    appendRecord(body);
+}
+
+bool WriteAheadLog::logExtend(uint64_t statement, const std::string& fileName, uint32_t startPage) {
+    std::string body;
+    put<uint8_t>(body, EXTEND);
+    put<uint64_t>(body, statement);
+    put<uint16_t>(body, static_cast<uint16_t>(fileName.size()));
+    body += fileName;
+    put<uint32_t>(body, startPage);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    appendRecord(body);
+    return flushLocked(lock, appendedLsn);
+}
+
+bool WriteAheadLog::commit(uint64_t statement) {
+    std::string body;
+    put<uint8_t>(body, COMMIT);
+    put<uint64_t>(body, statement);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    appendRecord(body);
+    commits++;
+    return flushLocked(lock, appendedLsn);
+}
+
+bool WriteAheadLog::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    return flushLocked(lock, appendedLsn);
+}
+
+bool WriteAheadLog::truncate() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!flushLocked(lock, appendedLsn)) return false;
+    std::fclose(file);
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    std::fclose(file);
+    file = std::fopen(path.c_str(), "ab");
+    appendedLsn = flushedLsn = 0;
+    return file != nullptr;
+}
+
+bool WriteAheadLog::readStatement(uint64_t statement, std::string& log, std::vector<Change>& changes) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!flushLocked(lock, appendedLsn)) return false;
+    // ̵ֻĲ̴֣߳ʱдļ¼
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    log.resize(flushedLsn);
+    if (!in.read(&log[0], static_cast<std::streamsize>(log.size()))) return false;
+    lock.unlock();
+
+    std::vector<Change> all;
+    std::set<uint64_t> committed;
+    parse(log, all, committed);
+    for (auto& change : all) {
+        if (change.statement == statement) changes.push_back(std::move(change));
+    }
+    return true;
+}
+
+uint64_t WriteAheadLog::size() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return appendedLsn;
+}
+
+// ڲʱѳ mutex
+void WriteAheadLog::appendRecord(const std::string& body) {
+    put<uint32_t>(pending, static_cast<uint32_t>(body.size()));
+    put<uint32_t>(pending, checksum(body.data(), body.size()));
+    pending += body;
+    appendedLsn += 8 + body.size();
+}
+
+// ύһ̸߳д벢 fsync̵߳ȴ
+bool WriteAheadLog::flushLocked(std::unique_lock<std::mutex>& lock, uint64_t target) {
+    while (flushedLsn < target) {
+        if (flushing) {
+            flushed.wait(lock);
+            continue;
+        }
+        flushing = true;
+        if (groupCommitDelay.count() > 0) {
+            lock.unlock();
+            std::this_thread::sleep_for(groupCommitDelay);
+            lock.lock();
+        }
+        std::string data;
+        data.swap(pending);
+        uint64_t end = appendedLsn;
+        lock.unlock();
+
+        bool ok = file && std::fwrite(data.data(), 1, data.size(), file) == data.size() && syncFile(file);
+
+        lock.lock();
+        flushing = false;
+        if (ok) {
+            flushedLsn = end;
+            syncs++;
+        } else {
+            pending.insert(0, data);
+        }
+        flushed.notify_all();
+        if (!ok) return false;
+    }
+    return true;
+}
+
+// ָ
+size_t WriteAheadLog::parse(const std::string& log, std::vector<Change>& changes, std::set<uint64_t>& committed) {
+    const char* p = log.data();
+    const char* end = log.data() + log.size();
+    size_t complete = 0;
+    while (true) {
+        complete = p - log.data();
+        uint32_t length, sum;
+        if (!get(p, end, length) || !get(p, end, sum)) break;
+        if (static_cast<size_t>(end - p) < length || checksum(p, length) != sum) break;
+        const char* body = p;
+        const char* bodyEnd = p + length;
+        p = bodyEnd;
+
+        uint8_t type;
+        uint64_t statement;
+        if (!get(body, bodyEnd, type) || !get(body, bodyEnd, statement)) break;
+        if (type == COMMIT) {
+            committed.insert(statement);
+            continue;
+        }
+
+        Change change;
+        change.statement = statement;
+        change.extend = (type == EXTEND);
+        uint16_t nameLength, runCount;
+        if (!get(body, bodyEnd, nameLength) || bodyEnd - body < nameLength) break;
+        change.fileName.assign(body, nameLength);
+        body += nameLength;
+        if (!get(body, bodyEnd, change.pageNo)) break;
+        if (change.extend) {
+            changes.push_back(change);
+            continue;
+        }
+        if (!get(body, bodyEnd, runCount)) break;
+        for (uint16_t i = 0; i < runCount; ++i) {
+            Run run;
+            if (!get(body, bodyEnd, run.offset) || !get(body, bodyEnd, run.length)) break;
+            if (bodyEnd - body < 2 * run.length) break;
+            run.before = body;
+            run.after = body + run.length;
+            body += 2 * run.length;
+            change.runs.push_back(run);
+        }
+        changes.push_back(change);
+    }
+    return complete;
+}
+
+int WriteAheadLog::replay(const std::string& dbDir, const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return 0;
+    std::string log((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    std::vector<Change> changes;
+    std::set<uint64_t> committed;
+    parse(log, changes, committed);
+
+    // ļдѹʽļҲܰҳĹҳڴУһдأ
+    // ׷ҳʱȶڴЩҳ޸ģֱдļ
+    std::map<std::string, std::unique_ptr<TableFile>> files;
+    std::map<std::pair<std::string, uint32_t>, std::vector<char>> pages;
+    auto openFile = [&](const std::string& filePath) {
+        auto it = files.find(filePath);
+        if (it == files.end()) {
+            std::unique_ptr<TableFile> file(new TableFile(filePath));
+            if (!file->isOpen()) file.reset();  // ļѱɾ
+            it = files.emplace(filePath, std::move(file)).first;
+        }
+        return it->second.get();
+    };
+    auto page = [&](const std::string& filePath, TableFile& file, uint32_t pageNo) -> std::vector<char>& {
+        auto it = pages.find({filePath, pageNo});
+        if (it == pages.end()) {
+            it = pages.emplace(std::make_pair(filePath, pageNo), std::vector<char>(PAGE_SIZE, 0)).first;
+            if (pageNo < file.pageCount()) file.readPage(pageNo, it->second.data());
+        }
+        return it->second;
+    };
+    auto apply = [&](const Change& change, bool redo) {
+        std::string filePath = dbDir + "/" + change.fileName;
+        TableFile* file = openFile(filePath);
+        if (!file) return;
+        if (change.extend) {
+            // δύ׷ҳɨʱᱻЧҳ
+            if (redo) return;
+            auto first = pages.lower_bound({filePath, change.pageNo});
+            while (first != pages.end() && first->first.first == filePath) first = pages.erase(first);
+            std::vector<char> zeros(PAGE_SIZE, 0);
+            for (uint32_t p = change.pageNo; p < file->pageCount(); ++p) file->writePage(p, zeros.data());
+            return;
+        }
+        std::vector<char>& data = page(filePath, *file, change.pageNo);
+        for (const auto& run : change.runs) {
+            if (run.offset + run.length > PAGE_SIZE) continue;
+            std::memcpy(data.data() + run.offset, redo ? run.after : run.before, run.length);
+        }
+    };
+
+    // ־˳ύ䣬δύµ޸
+    for (const auto& change : changes) {
+        if (committed.count(change.statement)) apply(change, true);
+    }
+    for (auto it = changes.rbegin(); it != changes.rend(); ++it) {
+        if (!committed.count(it->statement)) apply(*it, false);
+    }
+
+    bool ok = true;
+    for (const auto& entry : pages) {
+        ok = files.at(entry.first.first)->writePage(entry.first.second, entry.second.data()) && ok;
+    }
+    for (auto& entry : files) {
+        if (entry.second) ok = entry.second->sync() && ok;
+    }
+    return ok ? static_cast<int>(committed.size()) : -1;
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#ifndef WRITE_AHEAD_LOG_H
+#define WRITE_AHEAD_LOG_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+// ÿݿһԤд־(<db>/wal.log)
+// ¼Ϊλҳ¼(޸ǰֽڶ)һύ¼
+class WriteAheadLog {
+public:
+    // һҳ¼׷Ӽ¼ֽڶָ־
+    struct Run {
+        uint16_t offset;
+        uint16_t length;
+        const char* before;
+        const char* after;
+    };
+    struct Change {
+        uint64_t statement;
+        std::string fileName;
+        uint32_t pageNo;
+        bool extend;  // Ϊʱ pageNo ׷ӵʼҳ
+        std::vector<Run> runs;
+    };
+
+    explicit WriteAheadLog(const std::string& path);
+    ~WriteAheadLog();
+
+    bool isOpen() const { return file != nullptr; }
+
+    uint64_t beginStatement();
+    // ¼һҳڱе޸ģֻд뷢仯ֽڶ
+    void logPageChange(uint64_t statement, const std::string& fileName, uint32_t pageNo,
+                       const char* before, const char* after);
+    // ¼佫 startPage ֱļĩβ׷ҳ(д)ǰ
+    // Щҳ¼ݣύǰɵ÷̣δύʱָ̽
+    bool logExtend(uint64_t statement, const std::string& fileName, uint32_t startPage);
+    // ׷ύ¼ȴ̣ͬʱύһ fsync
+    bool commit(uint64_t statement);
+    // еļ¼д벢
+    bool flush();
+    // رѼ¼޸ģ־˳changes ֽڶָ logʱ
+    bool readStatement(uint64_t statement, std::string& log, std::vector<Change>& changes);
+    // ɺ־
+    bool truncate();
+
+    uint64_t size();
+    void setGroupCommitDelay(std::chrono::microseconds delay) { groupCommitDelay = delay; }
+    uint64_t commitCount() const { return commits; }
+    uint64_t syncCount() const { return syncs; }
+
+    // ʱύ䡢δύ䣬ʧܷ -1
+    static int replay(const std::string& dbDir, const std::string& path);
+
+private:
+    enum RecordType : uint8_t { PAGE_CHANGE = 1, COMMIT = 2, EXTEND = 3 };
+
+    // һУʧܵļ¼Ϊֹ¼ܳ
+    static size_t parse(const std::string& log, std::vector<Change>& changes, std::set<uint64_t>& committed);
+    void appendRecord(const std::string& body);
+    bool flushLocked(std::unique_lock<std::mutex>& lock, uint64_t target);
+
+    FILE* file = nullptr;
+    std::string path;
+    std::mutex mutex;
+    std::condition_variable flushed;
+    std::string pending;         // δдļļ¼
+    uint64_t appendedLsn = 0;    // ׷Ӽ¼ĩβλ
+    uint64_t flushedLsn = 0;     // ̼¼ĩβλ
+    uint64_t nextStatement = 1;
+    bool flushing = false;
+    std::chrono::microseconds groupCommitDelay{0};
+    uint64_t commits = 0;
+    uint64_t syncs = 0;
+};
+
+#endif // WRITE_AHEAD_LOG_H
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include "ZoneMap.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include "Hash.h"
+
+static const char ZONE_MAGIC[4] = {'Z', 'O', 'N', 'E'};
+
+template <typename T>
+static void put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+static bool get(const char*& p, const char* end, T& value) {
+    if (static_cast<size_t>(end - p) < sizeof(T)) return false;
+    std::memcpy(&value, p, sizeof(T));
+    p += sizeof(T);
+    return true;
+}
+
+void ZoneMap::load(BufferPool& pool, const std::string& tablePath, const TableLayout& layout) {
+    std::lock_guard<std::mutex> lock(loadMutex);
+    if (loaded) return;
+    path = filePath(tablePath);
+    this->layout = layout;
+    versions.clear();
+    bounds.clear();
+    changed = false;
+    if (!read(pool.pageCount(tablePath))) build(pool, tablePath);
+    loaded = true;
+}
+
+// ļݣʶеͺͿȡÿа汾СֵֵУУ
+// ṹûиǱҳʱΪЧ
+bool ZoneMap::read(uint32_t pageCount) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    uint64_t checksum;
+    if (data.size() < sizeof(ZONE_MAGIC) + sizeof(checksum)) return false;
+    size_t size = data.size() - sizeof(checksum);
+    std::memcpy(&checksum, data.data() + size, sizeof(checksum));
+    if (checksum != hashBytes(data.data(), size) || std::memcmp(data.data(), ZONE_MAGIC, sizeof(ZONE_MAGIC)) != 0) {
+        return false;
+    }
+
+    const char* p = data.data() + sizeof(ZONE_MAGIC);
+    const char* end = data.data() + size;
+    uint32_t columnCount, zones;
+    if (!get(p, end, columnCount) || columnCount != layout.types.size()) return false;
+    for (size_t i = 0; i < columnCount; ++i) {
+        uint8_t type;
+        uint32_t width;
+        if (!get(p, end, type) || !get(p, end, width)) return false;
+        if (type != static_cast<uint8_t>(layout.types[i]) || width != layout.widths[i]) return false;
+    }
+    if (!get(p, end, zones) || zones < (pageCount + ZONE_PAGES - 1) / ZONE_PAGES) return false;
+    size_t zoneSize = sizeof(uint64_t) + 2 * static_cast<size_t>(layout.rowSize);
+    if (static_cast<size_t>(end - p) != zones * zoneSize) return false;
+    versions.resize(zones);
+    bounds.resize(zones * 2 * static_cast<size_t>(layout.rowSize));
+    for (uint32_t z = 0; z < zones; ++z) {
+        get(p, end, versions[z]);
+        std::memcpy(&bounds[z * 2 * static_cast<size_t>(layout.rowSize)], p, 2 * layout.rowSize);
+        p += 2 * layout.rowSize;
+    }
+    return true;
+}
+
+// ɨҳռõĲλκοնѲɼδյİ汾
+void ZoneMap::build(BufferPool& pool, const std::string& tablePath) {
+    uint32_t pageCount = pool.pageCount(tablePath);
+    for (uint32_t p = 0; p < pageCount; ++p) {
+        bool pinned;
+        const char* data = pool.viewPage(tablePath, p, pinned);
+        if (!data) break;
+        const PageRef page(const_cast<char*>(data), layout);
+        if (page.isValid()) {
+            for (uint32_t s = 0; s < page.slotCount(); ++s) {
+                if (page.isUsed(s)) add(p, page.slotData(s));
+            }
+        }
+        if (pinned) pool.unpinPage(tablePath, p, false);
+    }
+    // βûеҳҲжӦĿ飬ʱͨ
+    size_t zones = (pageCount + ZONE_PAGES - 1) / ZONE_PAGES;
+    if (versions.size() < zones) {
+        versions.resize(zones, 0);
+        bounds.resize(zones * 2 * static_cast<size_t>(layout.rowSize), 0);
+    }
+    changed = true;
+}
+
+bool ZoneMap::save() {
+    if (!loaded || !changed) return true;
+    std::string data(ZONE_MAGIC, sizeof(ZONE_MAGIC));
+    put<uint32_t>(data, static_cast<uint32_t>(layout.types.size()));
+    for (size_t i = 0; i < layout.types.size(); ++i) {
+        put<uint8_t>(data, static_cast<uint8_t>(layout.types[i]));
+        put<uint32_t>(data, layout.widths[i]);
+    }
+    put<uint32_t>(data, static_cast<uint32_t>(versions.size()));
+    for (size_t z = 0; z < versions.size(); ++z) {
+        put<uint64_t>(data, versions[z]);
+        data.append(&bounds[z * 2 * layout.rowSize], 2 * layout.rowSize);
+    }
+    put<uint64_t>(data, hashBytes(data.data(), data.size()));
+
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.write(data.data(), data.size()) || !file.flush()) return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) return false;
+    changed = false;
+    return true;
+}
+
+void ZoneMap::add(uint32_t pageNo, const char* row) {
+    size_t zone = pageNo / ZONE_PAGES;
+    size_t rowSize = layout.rowSize;
+    if (zone >= versions.size()) {
+        versions.resize(zone + 1, 0);
+        bounds.resize((zone + 1) * 2 * rowSize, 0);
+    }
+    char* low = &bounds[zone * 2 * rowSize];
+    char* high = low + rowSize;
+    changed = true;
+    if (versions[zone]++ == 0) {
+        std::memcpy(low, row, rowSize);
+        std::memcpy(high, row, rowSize);
+        return;
+    }
+    RowView value(row, layout), lowView(low, layout), highView(high, layout);
+    for (size_t col = 0; col < layout.types.size(); ++col) {
+        bool below, above;
+        if (layout.types[col] == ColumnType::INT) {
+            below = value.getInt(col) < lowView.getInt(col);
+            above = value.getInt(col) > highView.getInt(col);
+        } else {
+            below = value.getChar(col) < lowView.getChar(col);
+            above = value.getChar(col) > highView.getChar(col);
+        }
+        if (below) std::memcpy(low + layout.offsets[col], row + layout.offsets[col], layout.widths[col]);
+        if (above) std::memcpy(high + layout.offsets[col], row + layout.offsets[col], layout.widths[col]);
+    }
+}
+
+bool ZoneMap::mayMatch(uint32_t pageNo, const Predicate& predicate) const {
+    size_t zone = pageNo / ZONE_PAGES;
+    if (predicate.empty() || zone >= versions.size()) return true;
+    if (versions[zone] == 0) return false;
+    const char* low = &bounds[zone * 2 * layout.rowSize];
+    return predicate.mayMatch(low, low + layout.rowSize);
+}
@@ -0,0 +1,49 @@
+#ifndef ZONE_MAP_H
+#define ZONE_MAP_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Storage.h"
+#include "BufferPool.h"
+#include "Predicate.h"
+
+// ÿҳ벢ɨССͬ
+const uint32_t ZONE_PAGES = 16;
+
+// һűÿ ZONE_PAGES ҳΪһ飬¼да汾ÿеСֵֵ
+// ɨʱνڸ÷ΧڲܳĿ
+// дʱſڿķΧɾͻվɰ汾խΧΧǰеа汾ؽ
+// ״ʹʱļԵ .zone ļûиļʱɨʱдأ
+// ȡ޸ʱ÷иñ
+class ZoneMap {
+public:
+    bool isLoaded() const { return loaded; }
+    void load(BufferPool& pool, const std::string& tablePath, const TableLayout& layout);
+    // ޸ĹķΧû޸ʱдļ
+    bool save();
+
+    // дһʱſ pageNo ҳڿķΧ
+    void add(uint32_t pageNo, const char* row);
+    //  pageNo ҳڿǷνʵУûм¼ĿǷ true
+    bool mayMatch(uint32_t pageNo, const Predicate& predicate) const;
+    size_t zoneCount() const { return versions.size(); }
+
+    static std::string filePath(const std::string& tablePath) { return tablePath + ".zone"; }
+
+private:
+    bool read(uint32_t pageCount);
+    void build(BufferPool& pool, const std::string& tablePath);
+
+    std::mutex loadMutex;
+    std::atomic<bool> loaded{false};
+    std::string path;
+    TableLayout layout;
+    std::vector<uint64_t> versions;  // ÿда汾Ϊ 0 ʾû
+    std::vector<char> bounds;        // ÿΪСֵкֵУĶиʽ
+    bool changed = false;
+};
+
+#endif // ZONE_MAP_H
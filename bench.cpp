@@ -0,0 +1,620 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "DBMS.h"
+#include "SqlParser.h"
+
+// ׼ԣֱӵ DBMS ӿڣն
+// ÿظɴΣ¼ÿεĺʱ p50/p99 ӳٺÿ봦(JSON)
+// ɹ̶ӵαɣͬĲÿͬ
+
+struct BenchOptions {
+    uint32_t scale = 1;        // 
+    uint32_t iterations = 0;   // Ϊ 0 ʱʹøԵĬϴ
+    std::string filter;        // ֻưôĲ
+    std::string outPath;       // Ϊʱ׼
+    std::string baselinePath;  // ֮Ƚ p50 tolerance ʱط
+    double tolerance = 10.0;   // ٷֱ
+    std::string dir = "dbms_bench_data";
+};
+
+struct BenchResult {
+    std::string name;
+    uint32_t iterations = 0;
+    uint64_t rows = 0;   // е
+    double p50 = 0;      // ΢
+    double p99 = 0;
+    double mean = 0;
+    double rowsPerSecond = 0;
+};
+
+// xorshift64*ݶ
+class BenchRandom {
+public:
+    explicit BenchRandom(uint64_t seed) : state(seed * 2685821657736338717ULL + 1) {}
+
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 2685821657736338717ULL;
+    }
+    // [low, high] ڵ
+    int32_t uniform(int32_t low, int32_t high) {
+        return low + static_cast<int32_t>(next() % static_cast<uint64_t>(high - low + 1));
+    }
+
+private:
+    uint64_t state;
+};
+
+// 1992-01-01 ֮ days 죬ʽΪ yyyymmdd 
+static int32_t dateAfter(int days) {
+    static const int MONTH_DAYS[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    int year = 1992;
+    for (;;) {
+        int yearDays = (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)) ? 366 : 365;
+        if (days < yearDays) break;
+        days -= yearDays;
+        year++;
+    }
+    int month = 0;
+    for (;; ++month) {
+        int monthDays = MONTH_DAYS[month] + ((month == 1 && (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0))) ? 1 : 0);
+        if (days < monthDays) break;
+        days -= monthDays;
+    }
+    return year * 10000 + (month + 1) * 100 + days + 1;
+}
+
+class Bench {
+public:
+    explicit Bench(const BenchOptions& options) : options(options), session(sink) {}
+
+    bool run();
+    const std::vector<BenchResult>& results() const { return resultList; }
+
+private:
+    // ʱ iterations  work()work رδsetup ÿ֮ǰִУʱ
+    void measure(const std::string& name, uint32_t iterations, const std::function<uint64_t()>& work,
+                 const std::function<void()>& setup = nullptr);
+    bool selected(const std::string& name) const {
+        return options.filter.empty() || name.find(options.filter) != std::string::npos;
+    }
+    uint32_t iterationsOr(uint32_t defaultCount) const {
+        return options.iterations > 0 ? options.iterations : defaultCount;
+    }
+    // ִ׼ݵ䣬ʱϢ false
+    bool exec(const std::string& sql);
+    // ִвĽ䣬ɾܲڵı
+    void discard(const std::string& sql) { executeSql(*dbms, session, sql); sink.str(""); }
+    // ִмʱɾĻ䣬бʱϢ˳
+    uint64_t modify(const std::string& sql);
+    // ִвѯнУʱϢ˳
+    uint64_t query(const std::string& sql);
+
+    void microBenchmarks();
+    bool tableBenchmarks();
+    bool tpchBenchmarks();
+    bool writeCsv(const std::string& path, uint32_t rows, const std::function<std::string(uint32_t)>& line);
+
+    BenchOptions options;
+    std::ostringstream sink;
+    Session session;
+    std::unique_ptr<DBMS> dbms;
+    std::vector<BenchResult> resultList;
+};
+
+void Bench::measure(const std::string& name, uint32_t iterations, const std::function<uint64_t()>& work,
+                    const std::function<void()>& setup) {
+    if (!selected(name)) return;
+    std::vector<double> samples;
+    samples.reserve(iterations);
+    BenchResult result;
+    result.name = name;
+    result.iterations = iterations;
+    double total = 0;
+    for (uint32_t i = 0; i < iterations; ++i) {
+        if (setup) setup();
+        auto start = std::chrono::steady_clock::now();
+        result.rows += work();
+        double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        samples.push_back(micros);
+        total += micros;
+        sink.str("");
+    }
+    std::sort(samples.begin(), samples.end());
+    // ȷȡλ
+    auto percentile = [&samples](double p) {
+        size_t rank = static_cast<size_t>(p / 100.0 * samples.size() + 0.999999);
+        return samples[std::min(samples.size(), std::max<size_t>(rank, 1)) - 1];
+    };
+    result.p50 = percentile(50);
+    result.p99 = percentile(99);
+    result.mean = total / iterations;
+    result.rowsPerSecond = total > 0 ? result.rows / (total / 1e6) : 0;
+    std::fprintf(stderr, "%-28s %8u iter  p50 %12.2f us  p99 %12.2f us  %14.0f rows/s\n", name.c_str(),
+                 iterations, result.p50, result.p99, result.rowsPerSecond);
+    resultList.push_back(result);
+}
+
+bool Bench::exec(const std::string& sql) {
+    sink.str("");
+    executeSql(*dbms, session, sql);
+    std::string output = sink.str();
+    sink.str("");
+    if (output.find("Error") != std::string::npos) {
+        std::cerr << "Setup failed: " << sql.substr(0, 80) << std::endl << output;
+        return false;
+    }
+    return true;
+}
+
+// ɾĺ͵ͷ "12 row(s) updated."
+uint64_t Bench::modify(const std::string& sql) {
+    sink.str("");
+    executeSql(*dbms, session, sql);
+    std::string output = sink.str();
+    if (output.find("Error") != std::string::npos) {
+        std::cerr << "Statement failed: " << sql.substr(0, 80) << std::endl << output;
+        std::exit(1);
+    }
+    return std::strtoull(output.c_str(), nullptr, 10);
+}
+
+uint64_t Bench::query(const std::string& sql) {
+    ParsedStatement statement;
+    if (!parseStatement(*dbms, session, sql, statement)) {
+        std::cerr << "Query failed: " << sql.substr(0, 80) << std::endl << sink.str() << std::endl;
+        std::exit(1);
+    }
+    std::unique_ptr<Cursor> cursor = dbms->openCursor(session, statement.tables, statement.columns,
+                                                      statement.where.get(), statement.groupBy, statement.orderBy,
+                                                      statement.limit, statement.offset);
+    uint64_t rows = 0;
+    ResultRow row;
+    while (cursor && cursor->next(row)) rows++;
+    if (!cursor || !cursor->error().empty() || sink.str().find("Error") != std::string::npos) {
+        std::cerr << "Query failed: " << sql.substr(0, 80) << std::endl
+                  << sink.str() << (cursor ? cursor->error() : "") << std::endl;
+        std::exit(1);
+    }
+    return rows;
+}
+
+bool Bench::writeCsv(const std::string& path, uint32_t rows, const std::function<std::string(uint32_t)>& line) {
+    std::ofstream out(path, std::ios::binary);
+    for (uint32_t i = 0; i < rows; ++i) out << line(i) << '\n';
+    if (!out) {
+        std::cerr << "Cannot write '" << path << "'" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+//  DBMS ĵбдҳн롢νֵ﷨
+void Bench::microBenchmarks() {
+    Table table;
+    table.name = "micro";
+    table.columns = {{"id", ColumnType::INT, 4}, {"grp", ColumnType::INT, 4}, {"name", ColumnType::CHAR, 16}};
+    TableLayout layout(table);
+    const uint32_t rowCount = 100000 * options.scale;
+    const uint32_t pageCount = (rowCount + layout.slotsPerPage - 1) / layout.slotsPerPage;
+    std::vector<char> pages(static_cast<size_t>(pageCount) * PAGE_SIZE);
+    BenchRandom random(1);
+    std::vector<std::vector<std::string>> texts(rowCount);
+    for (uint32_t i = 0; i < rowCount; ++i) {
+        texts[i] = {std::to_string(i), std::to_string(random.uniform(0, 99)), "'name" + std::to_string(i) + "'"};
+    }
+
+    //  INSERT ͬ·б볣ıٷҳеĿвλ
+    measure("micro.row_encode", iterationsOr(10), [&]() -> uint64_t {
+        std::vector<char> row(layout.rowSize);
+        std::string error;
+        for (uint32_t p = 0; p < pageCount; ++p) PageRef(&pages[static_cast<size_t>(p) * PAGE_SIZE], layout).init();
+        uint32_t p = 0;
+        for (uint32_t i = 0; i < rowCount; ++i) {
+            std::fill(row.begin(), row.end(), 0);
+            for (size_t col = 0; col < texts[i].size(); ++col) encodeField(layout, col, texts[i][col], row.data(), error);
+            PageRef page(&pages[static_cast<size_t>(p) * PAGE_SIZE], layout);
+            int slot = page.findFreeSlot();
+            if (slot < 0) {
+                page = PageRef(&pages[static_cast<size_t>(++p) * PAGE_SIZE], layout);
+                slot = page.findFreeSlot();
+            }
+            std::memcpy(page.slotData(slot), row.data(), layout.rowSize);
+            page.version(slot) = {1, 0};
+            page.setUsed(slot, true);
+        }
+        return rowCount;
+    });
+
+    Snapshot snapshot;
+    snapshot.timestamp = 1;
+    std::vector<bool> needed(table.columns.size(), true);
+    ColumnBatch batch;
+    batch.init(layout, needed);
+    measure("micro.page_decode", iterationsOr(20), [&]() -> uint64_t {
+        uint64_t rows = 0;
+        for (uint32_t p = 0; p < pageCount; ++p) {
+            const PageRef page(&pages[static_cast<size_t>(p) * PAGE_SIZE], layout);
+            for (uint32_t slot = 0; slot < page.slotCount();) {
+                batch.clear();
+                slot = batch.appendPage(page, slot, p, snapshot);
+                rows += batch.size();
+            }
+        }
+        return rows;
+    });
+
+    // grp < 10 AND (name = 'name7' OR id > 50000)
+    std::unique_ptr<Condition> where(Condition::makeLogical(
+        Condition::AND, Condition::makeCompare("grp", CompareOp::LT, "10"),
+        Condition::makeLogical(Condition::OR, Condition::makeCompare("name", CompareOp::EQ, "name7"),
+                               Condition::makeCompare("id", CompareOp::GT, "50000"))));
+    where->right->left->isString = true;
+    Predicate predicate;
+    std::string error;
+    predicate.compile(where.get(), table, layout, error);
+    volatile uint64_t matched = 0;  // ֵֹŻ
+    measure("micro.predicate_evaluate", iterationsOr(20), [&]() -> uint64_t {
+        for (uint32_t p = 0; p < pageCount; ++p) {
+            const PageRef page(&pages[static_cast<size_t>(p) * PAGE_SIZE], layout);
+            for (uint32_t slot = 0; slot < page.slotCount(); ++slot) {
+                if (page.isUsed(slot)) matched += predicate.evaluate(page.slotData(slot)) ? 1 : 0;
+            }
+        }
+        return rowCount;
+    });
+    std::vector<uint32_t> all(BATCH_SIZE), out(BATCH_SIZE);
+    for (uint32_t i = 0; i < BATCH_SIZE; ++i) all[i] = i;
+    measure("micro.predicate_filter", iterationsOr(20), [&]() -> uint64_t {
+        uint64_t rows = 0;
+        for (uint32_t p = 0; p < pageCount; ++p) {
+            const PageRef page(&pages[static_cast<size_t>(p) * PAGE_SIZE], layout);
+            for (uint32_t slot = 0; slot < page.slotCount();) {
+                batch.clear();
+                slot = batch.appendPage(page, slot, p, snapshot);
+                predicate.filter(batch, all.data(), batch.size(), out.data());
+                rows += batch.size();
+            }
+        }
+        return rows;
+    });
+
+    // ﷨(ʷ WHERE Ĺ)ִ
+    const std::string selectSql = "SELECT id, name FROM micro WHERE grp < 10 AND (name = 'abc' OR id > 500) "
+                                  "ORDER BY id DESC LIMIT 10";
+    std::string insertSql = "INSERT INTO micro VALUES ";
+    for (int i = 0; i < 100; ++i) insertSql += (i > 0 ? "," : "") + std::string("(1, 2, 'name')");
+    auto parse = [&](const std::string& sql, ParsedStatement& statement) {
+        if (!parseStatement(*dbms, session, sql, statement)) {
+            std::cerr << "Parse failed: " << sql.substr(0, 80) << std::endl << sink.str() << std::endl;
+            std::exit(1);
+        }
+    };
+    measure("micro.parse_select", iterationsOr(20000), [&]() -> uint64_t {
+        ParsedStatement statement;
+        parse(selectSql, statement);
+        return 1;
+    });
+    measure("micro.parse_insert_100_rows", iterationsOr(2000), [&]() -> uint64_t {
+        ParsedStatement statement;
+        parse(insertSql, statement);
+        return statement.rows.size();
+    });
+}
+
+// أ롢顢Χɨ衢ͬѡʵĸºɾ
+bool Bench::tableBenchmarks() {
+    const uint32_t rowCount = 100000 * options.scale;
+    // bucket = id % 100 bucket ˼ɵõ 1%  50% ѡ
+    if (!writeCsv("items.csv", rowCount, [](uint32_t i) {
+            return std::to_string(i) + "," + std::to_string(i % 100) + "," + std::to_string(i * 7 % 1000) +
+                   ",item" + std::to_string(i);
+        })) {
+        return false;
+    }
+    const std::string createItems = "CREATE TABLE items (id INT, bucket INT, price INT, label CHAR(16));";
+    // ڼʱ֮ǰִУʧʱĲû
+    auto recreate = [&]() {
+        discard("DROP TABLE items;");
+        if (!exec(createItems)) std::exit(1);
+    };
+    auto reload = [&]() {
+        recreate();
+        if (!exec("LOAD DATA INFILE 'items.csv' INTO TABLE items;")) std::exit(1);
+    };
+
+    measure("load.csv", iterationsOr(3), [&]() -> uint64_t {
+        return modify("LOAD DATA INFILE 'items.csv' INTO TABLE items;");
+    }, recreate);
+
+    if (!exec("CREATE TABLE staging (id INT, bucket INT, price INT, label CHAR(16));")) return false;
+    uint32_t next = 0;
+    measure("load.insert_1000_rows", iterationsOr(20), [&]() -> uint64_t {
+        std::string sql = "INSERT INTO staging VALUES ";
+        for (uint32_t i = 0; i < 1000; ++i, ++next) {
+            sql += (i > 0 ? "," : "") + ("(" + std::to_string(next) + ", " + std::to_string(next % 100) + ", 1, 'x')");
+        }
+        return modify(sql);
+    });
+    exec("DROP TABLE staging;");
+
+    reload();
+    if (!exec("CREATE INDEX items_id ON items (id);")) return false;
+    BenchRandom random(2);
+    std::unique_ptr<PreparedStatement> lookup = dbms->prepare(session, "SELECT label FROM items WHERE id = ?");
+    if (!lookup) return false;
+    measure("select.point_lookup_prepared", iterationsOr(20000), [&]() -> uint64_t {
+        lookup->bind(0, random.uniform(0, static_cast<int32_t>(rowCount) - 1));
+        std::unique_ptr<Cursor> cursor = lookup->query(session);
+        uint64_t rows = 0;
+        ResultRow row;
+        while (cursor && cursor->next(row)) rows++;
+        if (!cursor || !cursor->error().empty()) {
+            std::cerr << "Query failed: prepared point lookup" << std::endl
+                      << sink.str() << (cursor ? cursor->error() : "") << std::endl;
+            std::exit(1);
+        }
+        return rows;
+    });
+    measure("select.point_lookup_sql", iterationsOr(20000), [&]() -> uint64_t {
+        return query("SELECT label FROM items WHERE id = " +
+                     std::to_string(random.uniform(0, static_cast<int32_t>(rowCount) - 1)));
+    });
+    measure("select.range_scan_1000", iterationsOr(200), [&]() -> uint64_t {
+        int32_t low = random.uniform(0, static_cast<int32_t>(rowCount) - 1001);
+        return query("SELECT id, price FROM items WHERE id > " + std::to_string(low) + " AND id < " +
+                     std::to_string(low + 1001));
+    });
+    measure("select.full_scan_filter", iterationsOr(20), [&]() -> uint64_t {
+        query("SELECT id FROM items WHERE price < 10");
+        return rowCount;
+    });
+    measure("select.group_by", iterationsOr(20), [&]() -> uint64_t {
+        query("SELECT bucket, COUNT(*), SUM(price) FROM items GROUP BY bucket");
+        return rowCount;
+    });
+
+    // ºɾÿζͬݿʼµ벻ʱ
+    struct Case {
+        const char* name;
+        const char* sql;
+        uint32_t iterations;
+    };
+    const Case cases[] = {
+        {"update.selectivity_1pct", "UPDATE items SET price = 1 WHERE bucket = 7;", 10},
+        {"update.selectivity_50pct", "UPDATE items SET price = 1 WHERE bucket < 50;", 5},
+        {"delete.selectivity_1pct", "DELETE FROM items WHERE bucket = 7;", 10},
+        {"delete.selectivity_50pct", "DELETE FROM items WHERE bucket < 50;", 5},
+    };
+    for (const auto& c : cases) {
+        measure(c.name, iterationsOr(c.iterations), [&]() -> uint64_t { return modify(c.sql); }, reload);
+    }
+    return true;
+}
+
+// 򻯵 TPC-Hcustomerorderslineitem űԷΪλΪ yyyymmdd 
+bool Bench::tpchBenchmarks() {
+    const uint32_t customers = 1500 * options.scale;
+    const uint32_t orders = 15000 * options.scale;
+    static const char* const SEGMENTS[] = {"AUTOMOBILE", "BUILDING", "FURNITURE", "HOUSEHOLD", "MACHINERY"};
+    BenchRandom random(3);
+
+    if (!writeCsv("customer.csv", customers, [&](uint32_t i) {
+            return std::to_string(i + 1) + ",Customer#" + std::to_string(i + 1) + "," +
+                   std::to_string(random.uniform(0, 24)) + "," + SEGMENTS[random.uniform(0, 4)] + "," +
+                   std::to_string(random.uniform(-99999, 999999));
+        })) {
+        return false;
+    }
+    // ÿ 1  7 ϸ
+    std::ofstream lineitems("lineitem.csv", std::ios::binary);
+    uint64_t lineitemCount = 0;
+    if (!writeCsv("orders.csv", orders, [&](uint32_t i) {
+            int32_t orderKey = static_cast<int32_t>(i + 1);
+            int orderDay = random.uniform(0, 2405);
+            int32_t total = 0;
+            int lines = random.uniform(1, 7);
+            for (int l = 0; l < lines; ++l) {
+                int32_t quantity = random.uniform(1, 50);
+                int32_t price = quantity * random.uniform(900, 10000);
+                int32_t shipDate = dateAfter(orderDay + random.uniform(1, 121));
+                total += price;
+                lineitems << orderKey << ',' << random.uniform(1, 20000 * static_cast<int32_t>(options.scale)) << ','
+                          << quantity << ',' << price << ',' << random.uniform(0, 10) << ',' << shipDate << ','
+                          << (shipDate <= 19950617 ? (random.uniform(0, 1) ? 'R' : 'A') : 'N') << ','
+                          << (shipDate > 19950617 ? 'O' : 'F') << '\n';
+                lineitemCount++;
+            }
+            return std::to_string(orderKey) + "," + std::to_string(random.uniform(1, static_cast<int32_t>(customers))) +
+                   "," + (orderDay < 1200 ? "F" : "O") + "," + std::to_string(total) + "," +
+                   std::to_string(dateAfter(orderDay)) + "," + std::to_string(random.uniform(1, 5));
+        })) {
+        return false;
+    }
+    lineitems.close();
+
+    uint64_t loaded = customers + orders + lineitemCount;
+    bool ok = true;
+    auto load = [&]() -> uint64_t {
+        ok = exec("CREATE TABLE customer (c_custkey INT, c_name CHAR(18), c_nationkey INT, c_mktsegment CHAR(10), "
+                  "c_acctbal INT);") &&
+             exec("CREATE TABLE orders (o_orderkey INT, o_custkey INT, o_orderstatus CHAR(1), o_totalprice INT, "
+                  "o_orderdate INT, o_priority INT);") &&
+             exec("CREATE TABLE lineitem (l_orderkey INT, l_partkey INT, l_quantity INT, l_extendedprice INT, "
+                  "l_discount INT, l_shipdate INT, l_returnflag CHAR(1), l_linestatus CHAR(1));") &&
+             exec("LOAD DATA INFILE 'customer.csv' INTO TABLE customer;") &&
+             exec("LOAD DATA INFILE 'orders.csv' INTO TABLE orders;") &&
+             exec("LOAD DATA INFILE 'lineitem.csv' INTO TABLE lineitem;") &&
+             exec("CREATE INDEX orders_key ON orders (o_orderkey);");
+        return loaded;
+    };
+    auto reset = [&]() {
+        discard("DROP DATABASE tpch;");
+        exec("CREATE DATABASE tpch;");
+        exec("USE tpch;");
+    };
+    // ѯݣûбѡʱҲҪִУֻǲʱ
+    if (selected("tpch.load")) {
+        measure("tpch.load", iterationsOr(1), load, reset);
+    } else {
+        reset();
+        load();
+    }
+    if (!ok) return false;
+
+    // ۻ(Q1)ȼ(Q3)Ԥ仯(Q6)ȼ(Q4 ȥӲѯ)
+    measure("tpch.q1_pricing_summary", iterationsOr(10), [&]() -> uint64_t {
+        query("SELECT l_returnflag, l_linestatus, SUM(l_quantity), SUM(l_extendedprice), AVG(l_discount), COUNT(*) "
+              "FROM lineitem WHERE l_shipdate < 19980902 GROUP BY l_returnflag, l_linestatus "
+              "ORDER BY l_returnflag, l_linestatus");
+        return lineitemCount;
+    });
+    measure("tpch.q3_shipping_priority", iterationsOr(10), [&]() -> uint64_t {
+        query("SELECT o_orderkey, o_orderdate, SUM(l_extendedprice) FROM customer, orders, lineitem "
+              "WHERE c_mktsegment = 'BUILDING' AND c_custkey = o_custkey AND l_orderkey = o_orderkey "
+              "AND o_orderdate < 19950315 AND l_shipdate > 19950315 GROUP BY o_orderkey, o_orderdate "
+              "ORDER BY SUM(l_extendedprice) DESC LIMIT 10");
+        return customers + orders + lineitemCount;
+    });
+    measure("tpch.q4_order_priority", iterationsOr(10), [&]() -> uint64_t {
+        query("SELECT o_priority, COUNT(*) FROM orders WHERE o_orderdate > 19930700 AND o_orderdate < 19931001 "
+              "GROUP BY o_priority ORDER BY o_priority");
+        return orders;
+    });
+    measure("tpch.q6_forecast_revenue", iterationsOr(10), [&]() -> uint64_t {
+        query("SELECT SUM(l_extendedprice) FROM lineitem WHERE l_shipdate > 19931231 AND l_shipdate < 19950101 "
+              "AND l_discount > 4 AND l_discount < 8 AND l_quantity < 24");
+        return lineitemCount;
+    });
+    measure("tpch.order_lookup", iterationsOr(10000), [&]() -> uint64_t {
+        return query("SELECT o_totalprice FROM orders WHERE o_orderkey = " +
+                     std::to_string(random.uniform(1, static_cast<int32_t>(orders))));
+    });
+    return true;
+}
+
+bool Bench::run() {
+    std::filesystem::path home = std::filesystem::current_path();
+    std::filesystem::remove_all(options.dir);
+    std::filesystem::create_directories(options.dir);
+    std::filesystem::current_path(options.dir);
+    bool ok = true;
+    {
+        // ݿڹĿ¼£DBMS ʱɨ赱ǰĿ¼
+        dbms.reset(new DBMS());
+        ok = exec("CREATE DATABASE bench;") && exec("USE bench;");
+        if (ok) microBenchmarks();
+        ok = ok && tableBenchmarks() && tpchBenchmarks();
+        dbms.reset();
+    }
+    std::filesystem::current_path(home);
+    std::filesystem::remove_all(options.dir);
+    return ok;
+}
+
+static void writeJson(std::ostream& out, const BenchOptions& options, const std::vector<BenchResult>& results) {
+    char line[512];
+    out << "{\n  \"scale\": " << options.scale << ",\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        std::snprintf(line, sizeof(line),
+                      "    {\"name\": \"%s\", \"iterations\": %u, \"rows\": %llu, \"p50_us\": %.3f, "
+                      "\"p99_us\": %.3f, \"mean_us\": %.3f, \"rows_per_sec\": %.1f}%s\n",
+                      r.name.c_str(), r.iterations, static_cast<unsigned long long>(r.rows), r.p50, r.p99, r.mean,
+                      r.rowsPerSecond, i + 1 < results.size() ? "," : "");
+        out << line;
+    }
+    out << "  ]\n}\n";
+}
+
+// ȡǰ JSON иԵ p50ÿռһ
+static std::map<std::string, double> readBaseline(const std::string& path) {
+    std::map<std::string, double> p50;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t name = line.find("\"name\": \"");
+        size_t value = line.find("\"p50_us\": ");
+        if (name == std::string::npos || value == std::string::npos) continue;
+        name += 9;
+        p50[line.substr(name, line.find('"', name) - name)] = std::atof(line.c_str() + value + 10);
+    }
+    return p50;
+}
+
+// ÷: dbms_bench [--scale N] [--iterations N] [--filter ] [--out ļ.json]
+//                  [--baseline ļ.json] [--tolerance ٷֱ] [--dir Ŀ¼]
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--scale" && i + 1 < argc) {
+            options.scale = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            options.iterations = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--filter" && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (arg == "--out" && i + 1 < argc) {
+            options.outPath = argv[++i];
+        } else if (arg == "--baseline" && i + 1 < argc) {
+            options.baselinePath = argv[++i];
+        } else if (arg == "--tolerance" && i + 1 < argc) {
+            options.tolerance = std::atof(argv[++i]);
+        } else if (arg == "--dir" && i + 1 < argc) {
+            options.dir = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--scale N] [--iterations N] [--filter name] [--out file.json]"
+                      << " [--baseline file.json] [--tolerance percent] [--dir work-dir]" << std::endl;
+            return 2;
+        }
+    }
+
+    Bench bench(options);
+    if (!bench.run()) return 1;
+
+    if (options.outPath.empty()) {
+        writeJson(std::cout, options, bench.results());
+    } else {
+        std::ofstream out(options.outPath);
+        writeJson(out, options, bench.results());
+        if (!out) {
+            std::cerr << "Cannot write '" << options.outPath << "'" << std::endl;
+            return 1;
+        }
+    }
+
+    // ߱Ƚϣp50 ݲĲΪ˻
+    if (options.baselinePath.empty()) return 0;
+    std::map<std::string, double> baseline = readBaseline(options.baselinePath);
+    if (baseline.empty()) {
+        std::cerr << "No results in baseline '" << options.baselinePath << "'" << std::endl;
+        return 1;
+    }
+    int regressions = 0;
+    for (const auto& result : bench.results()) {
+        auto it = baseline.find(result.name);
+        if (it == baseline.end() || it->second <= 0) continue;
+        double change = (result.p50 / it->second - 1) * 100;
+        if (change > options.tolerance) {
+            std::fprintf(stderr, "REGRESSION %s: p50 %.2f us -> %.2f us (+%.1f%%)\n", result.name.c_str(),
+                         it->second, result.p50, change);
+            regressions++;
+        }
+    }
+    std::fprintf(stderr, "%d regression(s) against %s (tolerance %.1f%%)\n", regressions,
+                 options.baselinePath.c_str(), options.tolerance);
+    return regressions > 0 ? 1 : 0;
+}
@@ -28,7 +28,7 @@ win_bison -d parser.y
 if errorlevel 1 goto error
 
 REM Compile with additional options
-cl /EHsc /W4 /wd4127 /wd4702 /std:c++17 /D_CRT_SECURE_NO_WARNINGS /DWIN32 /D_WINDOWS /I. main.cpp DBMS.cpp lex.yy.c parser.tab.c /Fe:sql_new.exe /TP
+cl /EHsc /W4 /wd4127 /wd4702 /std:c++17 /D_CRT_SECURE_NO_WARNINGS /DWIN32 /D_WINDOWS /I. main.cpp DBMS.cpp Storage.cpp Compression.cpp BufferPool.cpp BTree.cpp Predicate.cpp ColumnBatch.cpp Cursor.cpp Operator.cpp Join.cpp Aggregate.cpp Sort.cpp ThreadPool.cpp Catalog.cpp Transaction.cpp PlanCache.cpp BulkLoader.cpp FreeSpaceMap.cpp ZoneMap.cpp Statistics.cpp WriteAheadLog.cpp Arena.cpp SqlParser.cpp Server.cpp lex.yy.c parser.tab.c ws2_32.lib /Fe:sql_new.exe /TP
 if errorlevel 1 goto error
 
 REM Try to replace the old executable
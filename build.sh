@@ -0,0 +1,21 @@
+#!/bin/sh
+# Linux/macOS 构建脚本，需要 flex、bison 和支持 C++17 的编译器
+set -e
+
+CXX=${CXX:-g++}
+
+rm -f sql lex.yy.c parser.tab.c parser.tab.h
+
+# 生成词法和语法分析器
+flex scanner.l
+bison -d parser.y
+
+# 编译
+$CXX -std=c++17 -O2 -Wall -I. -x c++ \
+    main.cpp DBMS.cpp Storage.cpp Compression.cpp BufferPool.cpp BTree.cpp Predicate.cpp ColumnBatch.cpp \
+    Cursor.cpp Operator.cpp Join.cpp Aggregate.cpp Sort.cpp ThreadPool.cpp Catalog.cpp Transaction.cpp PlanCache.cpp BulkLoader.cpp FreeSpaceMap.cpp ZoneMap.cpp Statistics.cpp WriteAheadLog.cpp Arena.cpp SqlParser.cpp Server.cpp \
+    lex.yy.c parser.tab.c \
+    -o sql -lpthread
+
+rm -f lex.yy.c parser.tab.c parser.tab.h
+echo "Build complete!"
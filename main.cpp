@@ -1,94 +1,113 @@
 #include <iostream>
 #include <string>
+#include <cstdlib>
 #include <ctime>
-#include <windows.h>
+#include <csignal>
+#include <thread>
 #include "DBMS.h"
+#include "SqlParser.h"
+#include "Server.h"
 
-extern FILE* yyin;
-extern int yyparse();
-DBMS* g_dbms = nullptr;
+static Server* g_server = nullptr;
+
+static void stopServer(int) {
+    if (g_server) g_server->stop();
+}
 
 std::string getCurrentTime() {
     time_t now = time(0);
     struct tm timeinfo;
     char buffer[80];
+#ifdef _WIN32
     localtime_s(&timeinfo, &now);
+#else
+    localtime_r(&now, &timeinfo);
+#endif
     strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &timeinfo);
     return std::string(buffer);
 }
 
-// ȡʱļ·
-std::string getTempFilePath() {
-    char tempPath[MAX_PATH];
-    char tempFileName[MAX_PATH];
-    DWORD result;
-    
-    // ȡʱļ·
-    result = GetTempPathA(MAX_PATH, tempPath);
-    if(result == 0 || result > MAX_PATH) {
-        throw std::runtime_error("Failed to get temp path");
+// ÷: sql [--server <˿|׽·>] [--threads N] [--scan-threads N] [--work-mem MB] [--no-auto-compact] [űļ]
+int main(int argc, char* argv[]) {
+    std::string serverAddress;
+    std::string scriptPath;
+    size_t threads = std::thread::hardware_concurrency();
+    size_t scanThreads = std::thread::hardware_concurrency();
+    size_t workMemory = DEFAULT_WORK_MEMORY_BYTES;
+    bool autoCompact = true;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--server" && i + 1 < argc) {
+            serverAddress = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--scan-threads" && i + 1 < argc) {
+            scanThreads = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--work-mem" && i + 1 < argc) {
+            workMemory = std::strtoul(argv[++i], nullptr, 10) * 1024 * 1024;
+        } else if (arg == "--no-auto-compact") {
+            autoCompact = false;
+        } else if (arg.compare(0, 2, "--") != 0 && scriptPath.empty()) {
+            scriptPath = arg;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--server <port|socket-path>] [--threads N] [--scan-threads N] [--work-mem MB] [--no-auto-compact] [script.sql]" << std::endl;
+            return 1;
+        }
     }
-    
-    // Ψһʱļ
-    if(GetTempFileNameA(tempPath, "sql", 0, tempFileName) == 0) {
-        throw std::runtime_error("Failed to generate temp file name");
+
+    DBMS* dbms = new DBMS();
+    dbms->setWorkMemory(workMemory);
+    dbms->setScanThreads(scanThreads);
+    dbms->setAutoCompact(autoCompact);
+
+    // ģʽÿһỰֱյ SIGINT/SIGTERM
+    if (!serverAddress.empty()) {
+        Server server(*dbms, threads);
+        if (!server.listen(serverAddress)) {
+            delete dbms;
+            return 1;
+        }
+        g_server = &server;
+        std::signal(SIGINT, stopServer);
+        std::signal(SIGTERM, stopServer);
+        std::cout << "Listening on " << serverAddress << " with " << threads << " worker thread(s)" << std::endl;
+        server.run();
+        g_server = nullptr;
+        delete dbms;
+        return 0;
+    }
+
+    Session session;
+
+    // űģʽļһνִе
+    if (!scriptPath.empty()) {
+        bool ok = executeScript(*dbms, session, scriptPath);
+        dbms->closeSession(session);
+        delete dbms;
+        return ok ? 0 : 1;
     }
-    
-    return std::string(tempFileName);
-}
 
-int main() {
-    g_dbms = new DBMS();
     std::string input;
-    FILE* temp = nullptr;
-    std::string tempFilePath;
     std::cout << "Simple SQL Database Management System" << std::endl;
     std::cout << "Current Time: " << getCurrentTime() << std::endl;
     std::cout << "\nEnter SQL commands (type 'EXIT' to quit):" << std::endl;
 
     while(true) {
         std::cout << "\nSQL> ";
-        std::getline(std::cin, input);
+        if(!std::getline(std::cin, input)) break;
 
         if(input.empty()) continue;
         if(input == "EXIT" || input == "exit") break;
 
+        // һп԰䣬һʡԷֺ
         if(input.back() != ';') input += ";";
-
-        try {
-            // ȡʱļ·
-            tempFilePath = getTempFilePath();
-
-            // дʱļ
-            if(fopen_s(&temp, tempFilePath.c_str(), "w") != 0 || !temp) {
-                std::cerr << "Error creating temporary file: " << tempFilePath << std::endl;
-                continue;
-            }
-            fprintf(temp, "%s", input.c_str());
-            fclose(temp);
-
-            // SQL
-            if(fopen_s(&yyin, tempFilePath.c_str(), "r") != 0 || !yyin) {
-                std::cerr << "Error opening temporary file: " << tempFilePath << std::endl;
-                remove(tempFilePath.c_str());
-                continue;
-            }
-
-            if(yyparse() != 0) {
-                std::cerr << "Error parsing SQL statement" << std::endl;
-            }
-
-            fclose(yyin);
-            remove(tempFilePath.c_str());
-        }
-        catch(const std::exception& e) {
-            std::cerr << "Error: " << e.what() << std::endl;
-            if(!tempFilePath.empty()) {
-                remove(tempFilePath.c_str());
-            }
+        if(!executeSql(*dbms, session, input)) {
+            std::cerr << "Error parsing SQL statement" << std::endl;
         }
     }
 
-    delete g_dbms;
+    // ˳ʱعδύ
+    dbms->closeSession(session);
+    delete dbms;
     return 0;
-}
\ No newline at end of file
+}
@@ -2,16 +2,68 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <charconv>
 #include "DBMS.h"
-
-extern int yylex();
-void yyerror(const char *s);
-extern DBMS* g_dbms;
+#include "SqlParser.h"
 %}
 
+%code requires {
+#include <string>
+#include <vector>
+#include "Predicate.h"
+#include "Arena.h"
+
+typedef void* yyscan_t;
+class DBMS;
+struct Session;
+struct ParsedStatement;
+}
+
+%code {
+int yylex(YYSTYPE* yylval, yyscan_t scanner);
+void yyerror(yyscan_t scanner, DBMS* dbms, Session* session, ParsedStatement* prepared, Arena* arena, const char* s);
+
+// 볣ȽϣΪѶĲһ
+static Condition* compareValue(ParsedStatement* prepared, const char* column, CompareOp op, const char* value) {
+    Condition* condition = Condition::makeCompare(column, op, value);
+    if (prepared && strcmp(value, "?") == 0) condition->param = static_cast<int>(prepared->paramCount) - 1;
+    return condition;
+}
+
+// ţеĵд ''
+static const char* quoteText(Arena* arena, const char* value) {
+    size_t length = strlen(value);
+    char* text = static_cast<char*>(arena->allocate(length * 2 + 3, 1));
+    size_t n = 0;
+    text[n++] = '\'';
+    for (size_t i = 0; i < length; ++i) {
+        if (value[i] == '\'') text[n++] = '\'';
+        text[n++] = value[i];
+    }
+    text[n++] = '\'';
+    text[n] = '\0';
+    return text;
+}
+
+static const char* numberText(Arena* arena, int value) {
+    char text[16];
+    return arena->copy(std::string_view(text, std::to_chars(text, text + sizeof(text), value).ptr - text));
+}
+}
+
+/* ɨݿͻỰͨ룬߳̿ͬʱ */
+/* prepared ΪʱֻһɾĲ䲢ѽУִ */
+/* ʶ͸﷨Ƭεı arena УÿִһջأıȲ */
+%define api.pure full
+%lex-param { yyscan_t scanner }
+%parse-param { yyscan_t scanner } { DBMS* dbms } { Session* session } { ParsedStatement* prepared } { Arena* arena }
+
 %union {
     int intval;
-    char strval[256];
+    const char* strval;
+    Condition* cond;
+    std::vector<std::string>* rows;
+    struct { int count; int offset; } limit;  // count Ϊ -1 ʾ
 }
 
 %token <strval> IDENTIFIER STRING
@@ -20,14 +72,22 @@ extern DBMS* g_dbms;
 %token CREATE DROP USE SHOW
 %token DATABASE DATABASES
 %token TABLE TABLES
+%token <strval> INDEX ON
 %token INSERT INTO VALUES
+%token <strval> LOAD DATA INFILE
 %token SELECT FROM WHERE
+%token <strval> GROUP BY COUNT SUM MIN MAX AVG
+%token <strval> ORDER ASC DESC LIMIT OFFSET
 %token UPDATE SET
 %token DELETE
+%token <strval> BEGIN_TXN COMMIT ROLLBACK
+%token VACUUM ALTER COMPRESS DECOMPRESS
+%token PREPARE EXECUTE USING DEALLOCATE PARAM
+%token <strval> EXPLAIN ANALYZE STATUS
 %token INT_TYPE CHAR_TYPE
 %token AND OR
 %token EQ LT GT NE
-%token LPAREN RPAREN COMMA SEMICOLON
+%token LPAREN RPAREN COMMA SEMICOLON DOT
 %token ASTERISK
 %token ERROR
 
@@ -35,20 +95,44 @@ extern DBMS* g_dbms;
 %type <strval> value_list
 %type <strval> value
 %type <strval> select_expr
+%type <strval> select_list
+%type <strval> select_item
+%type <strval> aggregate_func
+%type <strval> column_ref
+%type <strval> name
+%type <strval> column_ref_list
+%type <strval> opt_group_by
+%type <strval> opt_order_by
+%type <strval> order_list
+%type <strval> order_item
+%type <limit> opt_limit
+%type <intval> opt_analyze
 %type <strval> table_references
-%type <strval> condition
-%type <strval> opt_where
+%type <cond> condition
+%type <cond> opt_where
+%type <rows> row_list
+%type <rows> param_list
 %type <strval> assignment_list
 %type <strval> opt_semicolon
 %type <strval> column_defs
 %type <strval> column_def
 %type <strval> type
 
+%destructor { delete $$; } <cond>
+%destructor { delete $$; } <rows>
+
+%left OR
+%left AND
+
 %%
 
 commands:
     /* empty */
     | commands command
+    {
+        /* ִ꣬ջıѶһǺǱʶַıҲ arena Уݲջ */
+        if (yychar != IDENTIFIER && yychar != STRING) arena->reset();
+    }
     ;
 
 command:
@@ -59,203 +143,510 @@ command:
     | create_table_stmt
     | drop_table_stmt
     | show_tables_stmt
+    | show_status_stmt
+    | show_table_status_stmt
+    | create_index_stmt
+    | drop_index_stmt
     | insert_stmt
+    | load_data_stmt
     | select_stmt
+    | explain_stmt
     | update_stmt
     | delete_stmt
+    | begin_stmt
+    | commit_stmt
+    | rollback_stmt
+    | vacuum_stmt
+    | alter_table_stmt
+    | analyze_stmt
+    | prepare_stmt
+    | execute_stmt
+    | deallocate_stmt
     | error_recovery
     ;
 
 error_recovery:
-    error SEMICOLON    { yyerrok; printf("Error parsing SQL statement\n"); }
-    | error '\n'       { yyerrok; printf("Error parsing SQL statement\n"); }
+    error SEMICOLON    { yyerrok; session->out << "Error parsing SQL statement" << std::endl; }
     | ERROR           { yyerrok; }
     ;
 
 create_database_stmt:
-    CREATE DATABASE IDENTIFIER opt_semicolon
+    CREATE DATABASE name opt_semicolon
     { 
-        g_dbms->createDatabase($3); 
+        dbms->createDatabase(*session, $3); 
     }
     ;
 
 drop_database_stmt:
-    DROP DATABASE IDENTIFIER opt_semicolon
+    DROP DATABASE name opt_semicolon
     { 
-        g_dbms->dropDatabase($3); 
+        dbms->dropDatabase(*session, $3); 
     }
     ;
 
 use_database_stmt:
-    USE IDENTIFIER opt_semicolon
+    USE name opt_semicolon
     { 
-        g_dbms->useDatabase($2); 
+        dbms->useDatabase(*session, $2); 
     }
     ;
 
 show_databases_stmt:
     SHOW DATABASES opt_semicolon
     { 
-        g_dbms->showDatabases(); 
+        dbms->showDatabases(*session); 
     }
     ;
 
 show_tables_stmt:
     SHOW TABLES opt_semicolon
     { 
-        g_dbms->showTables(); 
+        dbms->showTables(*session); 
+    }
+    ;
+
+show_status_stmt:
+    SHOW STATUS opt_semicolon
+    {
+        dbms->showStatus(*session);
+    }
+    ;
+
+show_table_status_stmt:
+    SHOW TABLE STATUS opt_semicolon
+    {
+        dbms->showTableStatus(*session);
     }
     ;
 
 create_table_stmt:
-    CREATE TABLE IDENTIFIER LPAREN column_defs RPAREN opt_semicolon
+    CREATE TABLE name LPAREN column_defs RPAREN opt_semicolon
     { 
-        g_dbms->createTable($3, $5); 
+        dbms->createTable(*session, $3, $5); 
     }
     ;
 
 column_defs:
     column_def                      
     { 
-        strcpy($$, $1); 
+        $$ = $1; 
     }
     | column_defs COMMA column_def  
     { 
-        snprintf($$, sizeof($$), "%s,%s", $1, $3); 
+        $$ = arena->concat({$1, ",", $3}); 
     }
     ;
 
 column_def:
-    IDENTIFIER type                        
+    name type                        
     { 
-        snprintf($$, sizeof($$), "%s %s", $1, $2); 
+        $$ = arena->concat({$1, " ", $2}); 
     }
-    | IDENTIFIER type LPAREN NUMBER RPAREN 
+    | name type LPAREN NUMBER RPAREN 
     { 
-        snprintf($$, sizeof($$), "%s %s(%d)", $1, $2, $4); 
+        $$ = arena->concat({$1, " ", $2, "(", numberText(arena, $4), ")"}); 
     }
     ;
 
 type:
-    INT_TYPE    { strcpy($$, "INT"); }
-    | CHAR_TYPE { strcpy($$, "CHAR"); }
+    INT_TYPE    { $$ = "INT"; }
+    | CHAR_TYPE { $$ = "CHAR"; }
     ;
 
 drop_table_stmt:
-    DROP TABLE IDENTIFIER opt_semicolon
+    DROP TABLE name opt_semicolon
     { 
-        g_dbms->dropTable($3); 
+        dbms->dropTable(*session, $3); 
+    }
+    ;
+
+create_index_stmt:
+    CREATE INDEX name ON name LPAREN name RPAREN opt_semicolon
+    { 
+        dbms->createIndex(*session, $3, $5, $7); 
+    }
+    ;
+
+drop_index_stmt:
+    DROP INDEX name opt_semicolon
+    { 
+        dbms->dropIndex(*session, $3); 
+    }
+    | DROP INDEX name ON name opt_semicolon
+    { 
+        dbms->dropIndex(*session, $3, $5); 
     }
     ;
 
 insert_stmt:
-    INSERT INTO IDENTIFIER LPAREN column_name_list RPAREN VALUES LPAREN value_list RPAREN opt_semicolon
+    INSERT INTO name LPAREN column_name_list RPAREN VALUES row_list opt_semicolon
     { 
-        g_dbms->insertInto($3, $5, $9); 
+        std::unique_ptr<std::vector<std::string>> rows($8);
+        if (prepared) {
+            prepared->kind = ParsedStatement::INSERT;
+            prepared->tables = $3;
+            prepared->columns = $5;
+            prepared->rows = std::move(*rows);
+        } else {
+            dbms->insertRows(*session, $3, $5, *rows); 
+        }
     }
-    | INSERT INTO IDENTIFIER VALUES LPAREN value_list RPAREN opt_semicolon
+    | INSERT INTO name VALUES row_list opt_semicolon
     { 
-        g_dbms->insertInto($3, "", $6); 
+        std::unique_ptr<std::vector<std::string>> rows($5);
+        if (prepared) {
+            prepared->kind = ParsedStatement::INSERT;
+            prepared->tables = $3;
+            prepared->rows = std::move(*rows);
+        } else {
+            dbms->insertRows(*session, $3, "", *rows); 
+        }
+    }
+    ;
+
+row_list:
+    LPAREN value_list RPAREN
+    {
+        $$ = new std::vector<std::string>(1, $2);
+    }
+    | row_list COMMA LPAREN value_list RPAREN
+    {
+        $1->push_back($4);
+        $$ = $1;
+    }
+    ;
+
+load_data_stmt:
+    LOAD DATA INFILE STRING INTO TABLE name opt_semicolon
+    {
+        dbms->loadData(*session, $4, $7);
     }
     ;
 
 select_stmt:
-    SELECT select_expr FROM table_references opt_where opt_semicolon
+    SELECT select_expr FROM table_references opt_where opt_group_by opt_order_by opt_limit opt_semicolon
     { 
-        g_dbms->selectFrom($4, $2, $5); 
+        std::unique_ptr<Condition> where($5);
+        if (prepared) {
+            prepared->kind = ParsedStatement::SELECT;
+            prepared->tables = $4;
+            prepared->columns = $2;
+            prepared->where = std::move(where);
+            prepared->groupBy = $6;
+            prepared->orderBy = $7;
+            prepared->limit = $8.count;
+            prepared->offset = $8.offset;
+        } else {
+            std::unique_ptr<Cursor> cursor = dbms->openCursor(*session, $4, $2, where.get(), $6, $7,
+                                                              $8.count, $8.offset);
+            if (cursor) printResult(*cursor, session->out);
+        }
+    }
+    ;
+
+explain_stmt:
+    EXPLAIN opt_analyze SELECT select_expr FROM table_references opt_where opt_group_by opt_order_by opt_limit opt_semicolon
+    {
+        std::unique_ptr<Condition> where($7);
+        dbms->explain(*session, $2 != 0, $6, $4, where.get(), $8, $9, $10.count, $10.offset);
     }
     ;
 
+opt_analyze:
+    /* empty */     { $$ = 0; }
+    | ANALYZE       { $$ = 1; }
+    ;
+
 select_expr:
-    ASTERISK                { strcpy($$, "*"); }
-    | column_name_list     { strcpy($$, $1); }
+    ASTERISK                { $$ = "*"; }
+    | select_list          { $$ = $1; }
+    ;
+
+select_list:
+    select_item                         { $$ = $1; }
+    | select_list COMMA select_item     { $$ = arena->concat({$1, ",", $3}); }
+    ;
+
+select_item:
+    column_ref                                  { $$ = $1; }
+    | COUNT LPAREN ASTERISK RPAREN              { $$ = "COUNT(*)"; }
+    | COUNT LPAREN column_ref RPAREN            { $$ = arena->concat({"COUNT(", $3, ")"}); }
+    | aggregate_func LPAREN column_ref RPAREN   { $$ = arena->concat({$1, "(", $3, ")"}); }
+    ;
+
+aggregate_func:
+    SUM     { $$ = "SUM"; }
+    | MIN   { $$ = "MIN"; }
+    | MAX   { $$ = "MAX"; }
+    | AVG   { $$ = "AVG"; }
+    ;
+
+column_ref_list:
+    column_ref                          { $$ = $1; }
+    | column_ref_list COMMA column_ref  { $$ = arena->concat({$1, ",", $3}); }
+    ;
+
+column_ref:
+    name                          { $$ = $1; }
+    | name DOT name         { $$ = arena->concat({$1, ".", $3}); }
+    ;
+
+/* ƣĹؼЩλԿƣȡԭ */
+name:
+    IDENTIFIER  { $$ = $1; }
+    | COUNT     { $$ = $1; }
+    | SUM       { $$ = $1; }
+    | MIN       { $$ = $1; }
+    | MAX       { $$ = $1; }
+    | AVG       { $$ = $1; }
+    | GROUP     { $$ = $1; }
+    | BY        { $$ = $1; }
+    | INDEX     { $$ = $1; }
+    | ON        { $$ = $1; }
+    | LOAD      { $$ = $1; }
+    | DATA      { $$ = $1; }
+    | INFILE    { $$ = $1; }
+    | ORDER     { $$ = $1; }
+    | ASC       { $$ = $1; }
+    | DESC      { $$ = $1; }
+    | LIMIT     { $$ = $1; }
+    | OFFSET    { $$ = $1; }
+    | BEGIN_TXN { $$ = $1; }
+    | COMMIT    { $$ = $1; }
+    | ROLLBACK  { $$ = $1; }
+    | EXPLAIN   { $$ = $1; }
+    | ANALYZE   { $$ = $1; }
+    | STATUS    { $$ = $1; }
     ;
 
 table_references:
-    IDENTIFIER                          
+    name                          
     { 
-        strcpy($$, $1); 
+        $$ = $1; 
     }
-    | table_references COMMA IDENTIFIER 
+    | table_references COMMA name 
     { 
-        snprintf($$, sizeof($$), "%s,%s", $1, $3); 
+        $$ = arena->concat({$1, ",", $3}); 
     }
     ;
 
+opt_group_by:
+    /* empty */                 { $$ = ""; }
+    | GROUP BY column_ref_list  { $$ = $3; }
+    ;
+
+opt_order_by:
+    /* empty */                 { $$ = ""; }
+    | ORDER BY order_list       { $$ = $3; }
+    ;
+
+order_list:
+    order_item                          { $$ = $1; }
+    | order_list COMMA order_item       { $$ = arena->concat({$1, ",", $3}); }
+    ;
+
+order_item:
+    select_item                 { $$ = $1; }
+    | select_item ASC           { $$ = $1; }
+    | select_item DESC          { $$ = arena->concat({$1, " DESC"}); }
+    ;
+
+opt_limit:
+    /* empty */                         { $$.count = -1; $$.offset = 0; }
+    | LIMIT NUMBER                      { $$.count = $2; $$.offset = 0; }
+    | LIMIT NUMBER OFFSET NUMBER        { $$.count = $2; $$.offset = $4; }
+    ;
+
 opt_where:
-    /* empty */        { strcpy($$, ""); }
-    | WHERE condition  { strcpy($$, $2); }
+    /* empty */        { $$ = nullptr; }
+    | WHERE condition  { $$ = $2; }
     ;
 
 condition:
-    IDENTIFIER EQ value     { snprintf($$, sizeof($$), "%s=%s", $1, $3); }
-    | IDENTIFIER GT value   { snprintf($$, sizeof($$), "%s>%s", $1, $3); }
-    | IDENTIFIER LT value   { snprintf($$, sizeof($$), "%s<%s", $1, $3); }
-    | IDENTIFIER NE value   { snprintf($$, sizeof($$), "%s!=%s", $1, $3); }
-    | LPAREN condition RPAREN { snprintf($$, sizeof($$), "(%s)", $2); }
-    | condition AND condition { snprintf($$, sizeof($$), "%s AND %s", $1, $3); }
-    | condition OR condition  { snprintf($$, sizeof($$), "%s OR %s", $1, $3); }
+    column_ref EQ value     { $$ = compareValue(prepared, $1, CompareOp::EQ, $3); }
+    | column_ref GT value   { $$ = compareValue(prepared, $1, CompareOp::GT, $3); }
+    | column_ref LT value   { $$ = compareValue(prepared, $1, CompareOp::LT, $3); }
+    | column_ref NE value   { $$ = compareValue(prepared, $1, CompareOp::NE, $3); }
+    | column_ref EQ column_ref { $$ = Condition::makeColumnCompare($1, CompareOp::EQ, $3); }
+    | column_ref GT column_ref { $$ = Condition::makeColumnCompare($1, CompareOp::GT, $3); }
+    | column_ref LT column_ref { $$ = Condition::makeColumnCompare($1, CompareOp::LT, $3); }
+    | column_ref NE column_ref { $$ = Condition::makeColumnCompare($1, CompareOp::NE, $3); }
+    | LPAREN condition RPAREN { $$ = $2; }
+    | condition AND condition { $$ = Condition::makeLogical(Condition::AND, $1, $3); }
+    | condition OR condition  { $$ = Condition::makeLogical(Condition::OR, $1, $3); }
     ;
 
 update_stmt:
-    UPDATE IDENTIFIER SET assignment_list opt_where opt_semicolon
+    UPDATE name SET assignment_list opt_where opt_semicolon
     { 
-        g_dbms->update($2, $4, $5); 
+        std::unique_ptr<Condition> where($5);
+        if (prepared) {
+            prepared->kind = ParsedStatement::UPDATE;
+            prepared->tables = $2;
+            prepared->assignments = $4;
+            prepared->where = std::move(where);
+        } else {
+            dbms->update(*session, $2, $4, where.get()); 
+        }
     }
     ;
 
 assignment_list:
-    IDENTIFIER EQ value                          
+    name EQ value                          
     { 
-        snprintf($$, sizeof($$), "%s=%s", $1, $3); 
+        $$ = arena->concat({$1, "=", $3}); 
     }
-    | assignment_list COMMA IDENTIFIER EQ value  
+    | assignment_list COMMA name EQ value  
     { 
-        snprintf($$, sizeof($$), "%s,%s=%s", $1, $3, $5); 
+        $$ = arena->concat({$1, ",", $3, "=", $5}); 
     }
     ;
 
 delete_stmt:
-    DELETE FROM IDENTIFIER opt_where opt_semicolon
+    DELETE FROM name opt_where opt_semicolon
     { 
-        g_dbms->deleteFrom($3, $4); 
+        std::unique_ptr<Condition> where($4);
+        if (prepared) {
+            prepared->kind = ParsedStatement::DELETE;
+            prepared->tables = $3;
+            prepared->where = std::move(where);
+        } else {
+            dbms->deleteFrom(*session, $3, where.get()); 
+        }
+    }
+    ;
+
+begin_stmt:
+    BEGIN_TXN opt_semicolon
+    {
+        dbms->beginTransaction(*session);
+    }
+    ;
+
+commit_stmt:
+    COMMIT opt_semicolon
+    {
+        dbms->commitTransaction(*session);
+    }
+    ;
+
+rollback_stmt:
+    ROLLBACK opt_semicolon
+    {
+        dbms->rollbackTransaction(*session);
+    }
+    ;
+
+vacuum_stmt:
+    VACUUM name opt_semicolon
+    {
+        dbms->vacuumTable(*session, $2);
+    }
+    ;
+
+alter_table_stmt:
+    ALTER TABLE name COMPRESS opt_semicolon
+    {
+        dbms->compressTable(*session, $3, true);
+    }
+    | ALTER TABLE name DECOMPRESS opt_semicolon
+    {
+        dbms->compressTable(*session, $3, false);
+    }
+    ;
+
+analyze_stmt:
+    ANALYZE TABLE name opt_semicolon
+    {
+        dbms->analyzeTable(*session, $3);
+    }
+    | ANALYZE name opt_semicolon
+    {
+        dbms->analyzeTable(*session, $2);
+    }
+    ;
+
+prepare_stmt:
+    PREPARE name FROM STRING opt_semicolon
+    {
+        dbms->prepareStatement(*session, $2, $4);
+    }
+    ;
+
+execute_stmt:
+    EXECUTE name opt_semicolon
+    {
+        dbms->executeStatement(*session, $2, std::vector<std::string>());
+    }
+    | EXECUTE name USING param_list opt_semicolon
+    {
+        std::unique_ptr<std::vector<std::string>> params($4);
+        dbms->executeStatement(*session, $2, *params);
+    }
+    ;
+
+param_list:
+    value
+    {
+        $$ = new std::vector<std::string>(1, $1);
+    }
+    | param_list COMMA value
+    {
+        $1->push_back($3);
+        $$ = $1;
+    }
+    ;
+
+deallocate_stmt:
+    DEALLOCATE PREPARE name opt_semicolon
+    {
+        dbms->deallocateStatement(*session, $3);
     }
     ;
 
 column_name_list:
-    IDENTIFIER                          
+    name                          
     { 
-        strcpy($$, $1); 
+        $$ = $1; 
     }
-    | column_name_list COMMA IDENTIFIER 
+    | column_name_list COMMA name 
     { 
-        snprintf($$, sizeof($$), "%s,%s", $1, $3); 
+        $$ = arena->concat({$1, ",", $3}); 
     }
     ;
 
 value_list:
     value                   
     { 
-        strcpy($$, $1); 
+        $$ = $1; 
     }
     | value_list COMMA value 
     { 
-        snprintf($$, sizeof($$), "%s,%s", $1, $3); 
+        $$ = arena->concat({$1, ",", $3}); 
     }
     ;
 
 value:
-    NUMBER  { snprintf($$, sizeof($$), "%d", $1); }
-    | STRING { snprintf($$, sizeof($$), "'%s'", $1); }
+    NUMBER  { $$ = numberText(arena, $1); }
+    | STRING { $$ = quoteText(arena, $1); }
+    | PARAM
+    {
+        if (!prepared) {
+            session->out << "Error: Parameter markers are only allowed in prepared statements" << std::endl;
+            YYERROR;
+        }
+        prepared->paramCount++;
+        $$ = "?";
+    }
     ;
 
 opt_semicolon:
-    /* empty */    { strcpy($$, ""); }
-    | SEMICOLON    { strcpy($$, ";"); }
+    /* empty */    { $$ = ""; }
+    | SEMICOLON    { $$ = ";"; }
     ;
 
 %%
 
-void yyerror(const char *s) {
-    fprintf(stderr, "Error: %s\n", s);
+void yyerror(yyscan_t scanner, DBMS* dbms, Session* session, ParsedStatement* prepared, Arena* arena, const char* s) {
+    session->out << "Error: " << s << std::endl;
 }
\ No newline at end of file